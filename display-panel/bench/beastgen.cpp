@@ -0,0 +1,120 @@
+#include "beastgen.h"
+#include <math.h>
+#include <string.h>
+
+// ============================================
+// Mode S framing
+// ============================================
+static uint32_t crc24(const uint8_t* data, int len) {
+    uint32_t crc = 0;
+    for (int i = 0; i < len; i++) {
+        crc ^= (uint32_t)data[i] << 16;
+        for (int b = 0; b < 8; b++) {
+            crc <<= 1;
+            if (crc & 0x1000000) crc ^= 0x1FFF409;
+        }
+    }
+    return crc & 0xFFFFFF;
+}
+
+// DF17, CA 5, address, then the 56-bit ME field and parity
+static void squitter(uint8_t msg[14], uint32_t icao, uint64_t me) {
+    msg[0] = (17 << 3) | 5;
+    msg[1] = icao >> 16;
+    msg[2] = icao >> 8;
+    msg[3] = icao;
+    for (int i = 0; i < 7; i++) msg[4 + i] = me >> (48 - 8 * i);
+    uint32_t crc = crc24(msg, 11);
+    msg[11] = crc >> 16;
+    msg[12] = crc >> 8;
+    msg[13] = crc;
+}
+
+// Append count bits of v to an ME field being built MSB first
+static void put(uint64_t& me, int& used, uint64_t v, int count) {
+    me |= (v & ((1ull << count) - 1)) << (56 - used - count);
+    used += count;
+}
+
+// ============================================
+// Messages
+// ============================================
+void modesIdent(uint8_t msg[14], uint32_t icao, const char* callsign) {
+    uint64_t me = 0;
+    int used = 0;
+    put(me, used, 4, 5);        // TC 4, category set A
+    put(me, used, 3, 3);        // A3: large aircraft
+    for (int i = 0; i < 8; i++) {
+        char c = (i < (int)strlen(callsign)) ? callsign[i] : ' ';
+        int code = (c >= 'A' && c <= 'Z') ? c - 'A' + 1 : (c >= '0' && c <= '9') ? c : 32;
+        put(me, used, code, 6);
+    }
+    squitter(msg, icao, me);
+}
+
+static int nl(double lat) {
+    if (fabs(lat) >= 87) return 1;
+    double a = 1 - cos(M_PI / 30);
+    double b = cos(M_PI / 180 * fabs(lat));
+    return (int)floor(2 * M_PI / acos(1 - a / (b * b)));
+}
+
+void modesPosition(uint8_t msg[14], uint32_t icao, double lat, double lon, int altFt, int odd) {
+    double dLat = 360.0 / (60 - odd);
+    double yz = floor(131072 * fmod(fmod(lat, dLat) + dLat, dLat) / dLat + 0.5);
+    double rlat = dLat * (yz / 131072 + floor(lat / dLat));
+    int ni = nl(rlat) - odd;
+    double dLon = 360.0 / (ni > 1 ? ni : 1);
+    double xz = floor(131072 * fmod(fmod(lon, dLon) + dLon, dLon) / dLon + 0.5);
+
+    int n = (altFt + 1000) / 25;
+    uint32_t alt = ((n & 0x7F0) << 1) | 0x10 | (n & 0xF);
+
+    uint64_t me = 0;
+    int used = 0;
+    put(me, used, 11, 5);       // TC 11: airborne position, baro altitude
+    put(me, used, 0, 3);        // surveillance status, single antenna
+    put(me, used, alt, 12);
+    put(me, used, 0, 1);        // time
+    put(me, used, odd, 1);
+    put(me, used, (uint32_t)yz & 0x1FFFF, 17);
+    put(me, used, (uint32_t)xz & 0x1FFFF, 17);
+    squitter(msg, icao, me);
+}
+
+void modesVelocity(uint8_t msg[14], uint32_t icao, double gsKt, double trackDeg, int vrateFpm) {
+    long ve = lround(gsKt * sin(trackDeg * M_PI / 180));
+    long vn = lround(gsKt * cos(trackDeg * M_PI / 180));
+
+    uint64_t me = 0;
+    int used = 0;
+    put(me, used, 19, 5);
+    put(me, used, 1, 3);        // subtype 1: ground speed, subsonic
+    put(me, used, 0, 5);        // intent change, IFR, NUCv
+    put(me, used, ve < 0, 1);
+    put(me, used, labs(ve) + 1, 10);
+    put(me, used, vn < 0, 1);
+    put(me, used, labs(vn) + 1, 10);
+    put(me, used, 0, 1);        // vertical rate source: GNSS
+    put(me, used, vrateFpm < 0, 1);
+    put(me, used, abs(vrateFpm) / 64 + 1, 9);
+    squitter(msg, icao, me);
+}
+
+// ============================================
+// Beast
+// ============================================
+std::string beastFrame(const uint8_t* msg, int len, uint64_t timestamp, uint8_t signal) {
+    std::string out = "\x1A";
+    out += (len == 2) ? '1' : (len == 7) ? '2' : '3';
+
+    uint8_t body[6 + 1 + 14];
+    for (int i = 0; i < 6; i++) body[i] = timestamp >> (40 - 8 * i);
+    body[6] = signal;
+    memcpy(body + 7, msg, len);
+    for (int i = 0; i < 7 + len; i++) {
+        out += (char)body[i];
+        if (body[i] == 0x1A) out += (char)0x1A;
+    }
+    return out;
+}
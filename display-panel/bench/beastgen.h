@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+// ============================================
+// Beast / Mode S encoder for the ADS-B bench
+// Builds DF17 extended squitters the way a transponder would
+// (bitwise CRC, CPR encoding from the formulas in DO-260B), kept
+// separate from the decoder in src/adsb.cpp so each checks the
+// other, and wraps them in Beast frames with 0x1A escaping.
+// ============================================
+
+void modesIdent(uint8_t msg[14], uint32_t icao, const char* callsign);
+void modesPosition(uint8_t msg[14], uint32_t icao, double lat, double lon, int altFt, int odd);
+void modesVelocity(uint8_t msg[14], uint32_t icao, double gsKt, double trackDeg, int vrateFpm);
+
+// Beast frame: type '1' (2 bytes), '2' (7) or '3' (14)
+std::string beastFrame(const uint8_t* msg, int len, uint64_t timestamp, uint8_t signal = 0x80);
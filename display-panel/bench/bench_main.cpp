@@ -0,0 +1,1529 @@
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <WiFiUdp.h>
+#include <esp_partition.h>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include "adsb.h"
+#include "beastgen.h"
+#include "config.h"
+#include "displays.h"
+#include "expr.h"
+#include "gauges.h"
+#include "gaugetables.h"
+#include "history.h"
+#include "inflate.h"
+#include "jsondecode.h"
+#include "pipeline.h"
+#include "prom.h"
+#include "reference.h"
+#include "snmp.h"
+#include "snmpagent.h"
+#include "trace.h"
+#include <ArduinoJson.h>
+#include "screens.h"
+
+// ============================================
+// Host benchmark suite
+// Runs the firmware's real draw, flush and decode code against the
+// mock panel/bus (bench/mock) and prints one JSON object per case
+// on stdout (JSON Lines):
+//
+//   ns_per_iter    wall time per iteration
+//   fb_pixels      pixels written into the framebuffer
+//   spi_bytes      bytes clocked out on the shared bus
+//   spi_pixels     pixels written to panel GRAM
+//   addr_windows   CASET/RASET/RAMWR sequences
+//   transactions   CS assert/deassert pairs
+//
+// Counters are per iteration. Compare two runs with
+// bench/compare.py to catch bus-traffic as well as CPU regressions.
+//
+// inflate/* cases stream recorded gzip bodies through the decoder
+// and report bytes_in, bytes_out, mb_per_s (decompressed) and
+// peak_bytes: the decoder's whole footprint, since it never
+// allocates. A corrupt or short decode fails the run.
+//
+// json/* cases decode each fixture with the schema decoder and with
+// the old ArduinoJson DOM path (bench/reference.cpp), reporting
+// both times (ns_per_iter, dom_ns_per_iter). The run fails if the
+// two disagree on any field, or if the decoder accepts any
+// truncated copy of the fixture or a body cut off just inside an
+// array or object.
+//
+// prom/kuma parses the Uptime Kuma scrape (kuma-metrics.txt.gz,
+// inflated) with the streaming parser and with a line-splitting
+// strtod reader, reporting both (ns_per_iter, ref_ns_per_iter). The
+// run fails if they disagree, or on any of the format edge cases.
+//
+// expr/* cases time one evaluation of a compiled Custom screen
+// expression against a fixed metric store and fail the run if the
+// result is wrong, or if an unchanged store re-evaluates it.
+//
+// snmp/getbulk parses a GETBULK reply from the stand-in agent
+// (bench/snmpagent.cpp) and fails the run if any counter differs
+// from the agent's or a truncated reply is accepted.
+// decode/switches runs the whole poll over the mock UDP socket.
+//
+// adsb/beast encodes every aircraft in aircraft.json.gz as DF17
+// squitters (bench/beastgen.cpp), feeds the Beast stream in random
+// splits and fails the run if any decoded position, altitude,
+// velocity or callsign is off, or if expiry or the load cap
+// misbehave. ns_per_iter is per Mode S frame.
+//
+// Before any case, every framebuffer must be palette-indexed at
+// FRAME_DEPTH: each PAL_* colour has to read back as its index and
+// reach the GRAM as its PALETTE entry. The native8 env runs the
+// whole bench at 8bpp.
+//
+// bus/broadcast sends the boot splash ring to all six panels at
+// once plus each panel's label, bus/separate the same frames one
+// panel at a time. Both fail the run if any panel's GRAM differs
+// from its framebuffer, as does a partial broadcast over a window
+// one panel's driver thinks it already has.
+//
+// decode/pihole polls the Pi-hole fixtures and fails the run if a
+// counter, a top client or /stats is wrong, if the top-client list
+// is requested while the totals stand still, or if the rates are
+// off, including across FTL dropping old queries, or if a switch
+// poll refreshes Pi-hole's updated_ms.
+//
+// history/append compresses four days of every metric (synthetic,
+// each at its source's cadence) into a RAM-backed flash partition
+// and reports bytes_per_sample (headers included) and days_held.
+// history/query-* time a downsampled read and report the sectors,
+// headers, decoded and rolled-up records it took. The run fails if
+// any bucket of any metric differs from binning the samples by
+// hand, on a remount or torn write, if the log wears unevenly once
+// it laps, or if a query reads sectors outside its window.
+//
+// services/scroll moves the Services list one row with the panel's
+// hardware scroll, services/row redraws one changed status dot;
+// spi_bytes is one row either way, however long the list. The run
+// fails if a step or a new response time sends more than its row,
+// a dot change more than that and the up count, or if the glass
+// (mock GRAM seen through the scroll) differs from a full redraw or,
+// a lap later, from where it started. A frame saved mid-scroll must
+// come back from a warm start showing the same list.
+//
+// gauge/*-static draw what gauge/* do with the renderers built at
+// compile time (gaugetables.h); gauge/tables reports their flash
+// tables. The run fails if any config, at any value in or out of
+// its range, muted or not, leaves a different framebuffer than the
+// runtime path.
+//
+// Built with -DTRACE_ENABLED=1, trace/scope times one begin/end
+// pair and checks the ring dumps as valid Chrome trace JSON.
+//
+//   pio run -e native -t exec
+//   .pio/build/native/program [fixtures dir] > bench_output.txt
+// ============================================
+
+static std::string fixtureDir = "bench/fixtures";
+
+static std::string loadFixture(const char* name) {
+    std::ifstream f(fixtureDir + "/" + name, std::ios::binary);
+    if (!f) {
+        fprintf(stderr, "missing fixture %s/%s\n", fixtureDir.c_str(), name);
+        exit(1);
+    }
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+// ============================================
+// Case runner
+// ============================================
+template <typename F>
+static void runCase(const char* name, int iters, LGFX_Sprite* fb, F&& body) {
+    body();     // warm-up, also settles cached state
+
+    lgfx::BusCounters before = lgfx::busCounters;
+    uint64_t pxBefore = fb ? fb->pixelsWritten : 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) body();
+    auto t1 = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / iters;
+    const lgfx::BusCounters& after = lgfx::busCounters;
+    double fbPixels = fb ? (double)(fb->pixelsWritten - pxBefore) / iters : 0;
+
+    printf("{\"case\":\"%s\",\"iters\":%d,\"ns_per_iter\":%.0f,\"fb_pixels\":%.0f,"
+           "\"spi_bytes\":%.0f,\"spi_pixels\":%.0f,\"addr_windows\":%.0f,"
+           "\"transactions\":%.0f}\n",
+           name, iters, ns, fbPixels,
+           (double)(after.bytes - before.bytes) / iters,
+           (double)(after.pixels - before.pixels) / iters,
+           (double)(after.addrWindows - before.addrWindows) / iters,
+           (double)(after.transactions - before.transactions) / iters);
+    fflush(stdout);
+}
+
+// ============================================
+// Streaming inflate
+// ============================================
+static InflateStream inflater;
+
+static void runInflate(const char* name, const char* fixture, int iters) {
+    std::string body = loadFixture(fixture);
+    MockBodyStream src;
+    char sink[256];
+    uint32_t bytesIn = 0, bytesOut = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) {
+        src.reset(&body);
+        inflater.begin(src, InflateStream::GZIP);
+        while (inflater.readBytes(sink, sizeof(sink)) > 0) {}
+        if (!inflater.finish() || inflater.totalIn() != body.size()) {
+            fprintf(stderr, "%s: decode failed\n", name);
+            exit(1);
+        }
+        bytesIn = inflater.totalIn();
+        bytesOut = inflater.totalOut();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / iters;
+    printf("{\"case\":\"%s\",\"iters\":%d,\"ns_per_iter\":%.0f,\"bytes_in\":%u,"
+           "\"bytes_out\":%u,\"mb_per_s\":%.1f,\"peak_bytes\":%u}\n",
+           name, iters, ns, bytesIn, bytesOut, bytesOut / ns * 1000.0,
+           (unsigned)(sizeof(InflateStream) + sizeof(sink)));
+    fflush(stdout);
+}
+
+// ============================================
+// Schema decoder vs ArduinoJson
+// ============================================
+template <typename T>
+static void runDecoder(const char* name, const char* fixture, const JsonSchema& schema,
+                       const T& defaults, bool (*reference)(Stream&, T&), int iters) {
+    std::string body = loadFixture(fixture);
+    MockBodyStream src;
+
+    // Same starting bytes (padding included) so the results memcmp
+    T sax, dom;
+    memcpy(&sax, &defaults, sizeof(T));
+    memcpy(&dom, &defaults, sizeof(T));
+    src.reset(&body);
+    bool saxOk = jsonDecode(src, schema, &sax);
+    src.reset(&body);
+    bool domOk = reference(src, dom);
+    if (!saxOk || !domOk || memcmp(&sax, &dom, sizeof(T)) != 0) {
+        fprintf(stderr, "%s: schema decoder disagrees with ArduinoJson (ok %d/%d)\n",
+                name, saxOk, domOk);
+        exit(1);
+    }
+
+    // Every cut short of the closing brace must be rejected
+    size_t end = body.find_last_of('}') + 1;
+    for (size_t len = 0; len < end; len++) {
+        std::string cut = body.substr(0, len);
+        src.reset(&cut);
+        T scratch;
+        memcpy(&scratch, &defaults, sizeof(T));
+        if (jsonDecode(src, schema, &scratch)) {
+            fprintf(stderr, "%s: accepted a body truncated to %zu bytes\n", name, len);
+            exit(1);
+        }
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) {
+        src.reset(&body);
+        jsonDecode(src, schema, &sax);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) {
+        src.reset(&body);
+        reference(src, dom);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    printf("{\"case\":\"%s\",\"iters\":%d,\"ns_per_iter\":%.0f,\"dom_ns_per_iter\":%.0f,"
+           "\"bytes\":%zu}\n",
+           name, iters,
+           std::chrono::duration<double, std::nano>(t1 - t0).count() / iters,
+           std::chrono::duration<double, std::nano>(t2 - t1).count() / iters,
+           body.size());
+    fflush(stdout);
+}
+
+// Bodies cut off inside an array or object, tracked or skipped,
+// right after the bracket or a comma: rejected, nothing read
+// from before the start of the input buffer
+static void checkJsonCuts() {
+    static const char* cuts[] = {
+        "{\"drives\":[",
+        "{\"drives\":[ ",
+        "{\"drives\":[{\"device\":\"sda\"},",
+        "{\"drives\":[{\"device\":\"sda\"}, ",
+        "{\"drives\":[{",
+        "{\"drives\":[{\"temp_c\":",
+        "{\"other\":[",
+        "{\"other\":[1,",
+        "{\"other\":{",
+        "{\"storage\":{",
+        "{\"storage\":{\"used_gb\":1,",
+        "{\"storage\":{\"used_gb\":",
+        "[",
+        "{",
+    };
+    MockBodyStream src;
+    for (const char* c : cuts) {
+        std::string body = c;
+        src.reset(&body);
+        UnraidStats scratch = UNRAID_DEFAULTS;
+        if (jsonDecode(src, UNRAID_SCHEMA, &scratch)) {
+            fprintf(stderr, "json/cuts: accepted %s\n", c);
+            exit(1);
+        }
+    }
+}
+
+// ============================================
+// Prometheus text format
+// ============================================
+static const uint32_t promNames[] = {promHash("monitor_status"), promHash("monitor_response_time")};
+static const PromQuery promQuery = {promNames, 2, promHash("monitor_name")};
+
+static void collectSample(void* ctx, const PromSample& s) {
+    ((std::vector<PromSample>*)ctx)->push_back(s);
+}
+
+// The obvious way: whole body in memory, split into lines, strings
+// for the name and label, strtod for the value
+static std::vector<PromSample> referenceProm(const std::string& body) {
+    std::vector<PromSample> out;
+    std::istringstream lines(body);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        size_t nameEnd = line.find_first_of("{ ");
+        std::string name = line.substr(0, nameEnd);
+        int metric = name == "monitor_status" ? 0 : name == "monitor_response_time" ? 1 : -1;
+        if (metric < 0) continue;
+
+        uint32_t key = 0;
+        size_t at = line.find("monitor_name=\"");
+        size_t valueAt = nameEnd;
+        if (line[nameEnd] == '{') {
+            valueAt = line.find("} ");
+            if (at != std::string::npos && at < valueAt) {
+                size_t start = at + 14;
+                key = promHash(line.substr(start, line.find('"', start) - start).c_str());
+            }
+            valueAt++;
+        }
+        out.push_back({(uint8_t)metric, key, strtod(line.c_str() + valueAt, nullptr)});
+    }
+    return out;
+}
+
+static int parseProm(const std::string& text, std::vector<PromSample>& out) {
+    MockBodyStream src;
+    src.reset(&text);
+    out.clear();
+    return promParse(src, promQuery, collectSample, &out);
+}
+
+static bool sameValue(double a, double b) {
+    return a == b || (isnan(a) && isnan(b));
+}
+
+static void runProm() {
+    std::string gz = loadFixture("kuma-metrics.txt.gz");
+    MockBodyStream gzSrc;
+    gzSrc.reset(&gz);
+    inflater.begin(gzSrc, InflateStream::GZIP);
+    std::string body;
+    char buf[256];
+    for (int n; (n = inflater.readBytes(buf, sizeof(buf))) > 0;) body.append(buf, n);
+
+    std::vector<PromSample> got;
+    std::vector<PromSample> want = referenceProm(body);
+    int n = parseProm(body, got);
+    bool ok = n == (int)want.size() && n > 0;
+    for (int i = 0; ok && i < n; i++) {
+        ok = got[i].metric == want[i].metric && got[i].key == want[i].key &&
+             sameValue(got[i].value, want[i].value);
+    }
+    if (!ok) {
+        fprintf(stderr, "prom/kuma: parser disagrees with the reference (%d/%zu samples)\n",
+                n, want.size());
+        exit(1);
+    }
+
+    // Format corners: escapes in a label value, the key label not
+    // first, NaN/Inf, exponents, a timestamp, CRLF, no final newline
+    static const struct { const char* text; int count; double value; uint32_t key; } edges[] = {
+        {"monitor_status{monitor_name=\"a\\\"b\\\\c\\nd\"} 1\n", 1, 1, promHash("a\"b\\c\nd")},
+        {"monitor_status{monitor_type=\"http\",monitor_name=\"Plex\"} 2 1700000000000\n", 1, 2, promHash("Plex")},
+        {"monitor_response_time{monitor_name=\"x\"} NaN\n", 1, NAN, promHash("x")},
+        {"monitor_response_time{monitor_name=\"x\"} -Inf\n", 1, -INFINITY, promHash("x")},
+        {"monitor_response_time{monitor_name=\"x\"} 1.5e3\r\n", 1, 1500, promHash("x")},
+        {"monitor_response_time{monitor_name=\"x\",} -0.25", 1, -0.25, promHash("x")},
+        {"monitor_status 3\n", 1, 3, 0},
+        {"monitor_statusx{monitor_name=\"x\"} 1\nmonitor_status_total 4\n", 0, 0, 0},
+        {"# monitor_status{monitor_name=\"x\"} 1\n", 0, 0, 0},
+    };
+    for (auto& e : edges) {
+        n = parseProm(e.text, got);
+        if (n != e.count || (n && (!sameValue(got[0].value, e.value) || got[0].key != e.key))) {
+            fprintf(stderr, "prom/kuma: mis-parsed %s\n", e.text);
+            exit(1);
+        }
+    }
+    static const char* malformed[] = {
+        "monitor_status{monitor_name=\"x\"}\n",
+        "monitor_status{monitor_name=x} 1\n",
+        "monitor_status{monitor_name=\"x\" 1\n",
+        "monitor_status{monitor_name=\"x\"} 1.2.3\n",
+    };
+    for (const char* m : malformed) {
+        if (parseProm(m, got) != -1) {
+            fprintf(stderr, "prom/kuma: accepted %s\n", m);
+            exit(1);
+        }
+    }
+
+    const int iters = 2000;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) parseProm(body, got);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) want = referenceProm(body);
+    auto t2 = std::chrono::steady_clock::now();
+
+    printf("{\"case\":\"prom/kuma\",\"iters\":%d,\"ns_per_iter\":%.0f,\"ref_ns_per_iter\":%.0f,"
+           "\"bytes\":%zu,\"samples\":%zu}\n",
+           iters,
+           std::chrono::duration<double, std::nano>(t1 - t0).count() / iters,
+           std::chrono::duration<double, std::nano>(t2 - t1).count() / iters,
+           body.size(), got.size());
+    fflush(stdout);
+}
+
+// ============================================
+// Trace ring
+// ============================================
+#if TRACE_ENABLED
+static void appendDump(void* ctx, const char* data, size_t len) {
+    ((std::string*)ctx)->append(data, len);
+}
+
+static void runTrace() {
+    runCase("trace/scope", 100000, nullptr, [] { TRACE_SCOPE_ARG("bench", 1); });
+
+    std::string dump;
+    traceDump(appendDump, &dump);
+    JsonDocument doc;
+    if (deserializeJson(doc, dump) || doc["traceEvents"].size() < TRACE_EVENTS / 2) {
+        fprintf(stderr, "trace/scope: dump is not a valid trace\n");
+        exit(1);
+    }
+}
+#endif
+
+// ============================================
+// Expressions
+// ============================================
+static MetricStore exprStore() {
+    MetricStore m = {};
+    for (int i = 0; i < METRIC_PIS; i++) {
+        m.value[M_PI_TEMP + i] = 50 + i * 2.5;      // 50, 52.5, 55, 57.5
+        m.state[M_PI_TEMP + i] = MS_LIVE;
+        m.source[M_PI_TEMP + i] = SRC_PI + i;
+        m.sampledMs[M_PI_TEMP + i] = 1000;
+    }
+    m.value[M_UNRAID_STORAGE_USED_TB] = 24.876;
+    m.value[M_UNRAID_STORAGE_TOTAL_TB] = 38.142;
+    m.value[M_M900_NET_RECV] = 1e9;
+    for (int id : {M_UNRAID_STORAGE_USED_TB, M_UNRAID_STORAGE_TOTAL_TB, M_M900_NET_RECV}) {
+        m.state[id] = MS_LIVE;
+        m.source[id] = (id == M_M900_NET_RECV) ? SRC_M900 : SRC_UNRAID;
+        m.sampledMs[id] = 1000;
+    }
+    return m;
+}
+
+static void runExpr(const char* name, const char* src, double expect) {
+    Expr e;
+    const char* error;
+    int column;
+    if (!exprCompile(e, src, &error, &column)) {
+        fprintf(stderr, "%s: %s at column %d\n", name, error, column);
+        exit(1);
+    }
+
+    // Second sample 5 s later: rate(m900.net.rx) sees 125 MB in 5 s
+    MetricStore m = exprStore();
+    ExprInputs seen = {};
+    uint32_t changed[EXPR_DEP_WORDS];
+    exprChangedInputs(m, seen, changed);
+    exprUpdate(e, m, changed, 1000);
+    m.value[M_M900_NET_RECV] += 125e6;
+    m.sampledMs[M_M900_NET_RECV] = 6000;
+    exprChangedInputs(m, seen, changed);
+    exprUpdate(e, m, changed, 6000);
+
+    if (fabs(e.value - expect) > 1e-3 || e.stale) {
+        fprintf(stderr, "%s: got %f%s, want %f\n", name, e.value, e.stale ? " (stale)" : "",
+                expect);
+        exit(1);
+    }
+    exprChangedInputs(m, seen, changed);
+    if (exprUpdate(e, m, changed, 6000)) {
+        fprintf(stderr, "%s: re-evaluated with no input changed\n", name);
+        exit(1);
+    }
+
+    // Time the evaluation itself: force it dirty every iteration
+    uint32_t all[EXPR_DEP_WORDS];
+    memset(all, 0xFF, sizeof(all));
+    runCase(name, 100000, nullptr, [&] { exprUpdate(e, m, all, 6000); });
+}
+
+// ============================================
+// SNMP
+// ============================================
+#define SWITCH_INTERFACES   7       // five ports, then internal ones the walk must skip
+
+static SnmpStandIn switchAgent(SWITCH_INTERFACES, SWITCH_COMMUNITY);
+
+struct BulkCounters {
+    uint64_t in[SWITCH_INTERFACES + 1];
+    uint64_t out[SWITCH_INTERFACES + 1];
+    int      ends;      // endOfMibView varbinds
+};
+
+static void collectCounter(void* ctx, const SnmpVarbind& vb) {
+    static const uint32_t in[] = {1, 3, 6, 1, 2, 1, 31, 1, 1, 1, 6};
+    static const uint32_t out[] = {1, 3, 6, 1, 2, 1, 31, 1, 1, 1, 10};
+    BulkCounters* c = (BulkCounters*)ctx;
+    uint32_t ifIndex;
+    uint64_t v;
+    if (vb.type == SNMP_END_OF_MIB_VIEW) c->ends++;
+    if (!snmpUnsigned(vb, &v)) return;
+    if (snmpColumnIndex(vb, {in, 11}, &ifIndex) && ifIndex <= SWITCH_INTERFACES) c->in[ifIndex] = v;
+    if (snmpColumnIndex(vb, {out, 11}, &ifIndex) && ifIndex <= SWITCH_INTERFACES) c->out[ifIndex] = v;
+}
+
+static void runSnmp() {
+    static const uint32_t in[] = {1, 3, 6, 1, 2, 1, 31, 1, 1, 1, 6};
+    static const uint32_t out[] = {1, 3, 6, 1, 2, 1, 31, 1, 1, 1, 10};
+    const SnmpOid columns[] = {{in, 11}, {out, 11}};
+
+    // Ten rows walks past the end: the in column runs on into the
+    // out column, and the out column ends in three endOfMibView
+    uint8_t req[128];
+    size_t len = snmpGetBulk(req, sizeof(req), SWITCH_COMMUNITY, 0x12345, 10, columns, 2);
+    std::string reply = switchAgent.handle(std::string((const char*)req, len));
+    if (reply.empty()) {
+        fprintf(stderr, "snmp/getbulk: agent rejected the request\n");
+        exit(1);
+    }
+
+    const uint8_t* pkt = (const uint8_t*)reply.data();
+    BulkCounters c = {};
+    int n = snmpParseResponse(pkt, reply.size(), 0x12345, collectCounter, &c);
+    bool ok = (n == 20 && c.ends == 3);
+    for (int i = 1; i <= SWITCH_INTERFACES; i++) {
+        if (c.in[i] != switchAgent.inOctets(i) || c.out[i] != switchAgent.outOctets(i)) ok = false;
+    }
+    if (!ok || snmpParseResponse(pkt, reply.size(), 0x12346, collectCounter, &c) != -1) {
+        fprintf(stderr, "snmp/getbulk: reply decoded wrong (%d varbinds)\n", n);
+        exit(1);
+    }
+    for (size_t cut = 0; cut < reply.size(); cut++) {
+        if (snmpParseResponse(pkt, cut, 0x12345, collectCounter, &c) >= 0) {
+            fprintf(stderr, "snmp/getbulk: accepted a reply truncated to %zu bytes\n", cut);
+            exit(1);
+        }
+    }
+
+    const int iters = 100000;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) {
+        snmpParseResponse(pkt, reply.size(), 0x12345, collectCounter, &c);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    printf("{\"case\":\"snmp/getbulk\",\"iters\":%d,\"ns_per_iter\":%.0f,"
+           "\"request_bytes\":%zu,\"reply_bytes\":%zu,\"varbinds\":%d}\n",
+           iters, std::chrono::duration<double, std::nano>(t1 - t0).count() / iters,
+           len, reply.size(), n);
+    fflush(stdout);
+}
+
+// Both switches poll the stand-in; the busiest port must come out
+// on top with every port live
+static void runSwitches() {
+    for (int p = 1; p <= SWITCH_INTERFACES; p++) switchAgent.setStep(p, p * 100000, 50000);
+    runCase("decode/switches", 2000, nullptr, [] { fetchSwitches(); });
+    delay(20);
+    fetchSwitches();
+
+    MetricStore m;
+    metricsRead(m);
+    for (int i = 0; i < METRIC_SWITCHES * METRIC_SWITCH_PORTS; i++) {
+        int top = M_SWITCH_IN_MBPS + (i / METRIC_SWITCH_PORTS) * METRIC_SWITCH_PORTS +
+                  METRIC_SWITCH_PORTS - 1;
+        if (m.state[M_SWITCH_IN_MBPS + i] != MS_LIVE || m.state[M_SWITCH_OUT_MBPS + i] != MS_LIVE ||
+            m.value[M_SWITCH_IN_MBPS + i] > m.value[top]) {
+            fprintf(stderr, "decode/switches: port %d rate wrong\n", i);
+            exit(1);
+        }
+    }
+}
+
+// ============================================
+// ADS-B
+// ============================================
+struct BenchAircraft {
+    uint32_t    icao;
+    std::string flight;
+    double      lat, lon;       // NAN = no position
+    int         alt, vrate;
+    double      gs, track;
+};
+
+static std::vector<BenchAircraft> loadAircraft() {
+    std::string gz = loadFixture("aircraft.json.gz");
+    MockBodyStream src;
+    src.reset(&gz);
+    inflater.begin(src, InflateStream::GZIP);
+    std::string text;
+    char buf[256];
+    for (int n; (n = inflater.readBytes(buf, sizeof(buf))) > 0;) text.append(buf, n);
+
+    JsonDocument doc;
+    if (deserializeJson(doc, text)) {
+        fprintf(stderr, "adsb/beast: aircraft.json.gz did not parse\n");
+        exit(1);
+    }
+    std::vector<BenchAircraft> out;
+    JsonArray list = doc["aircraft"];
+    for (size_t i = 0; i < list.size(); i++) {
+        JsonObject a = list[i];
+        BenchAircraft b;
+        b.icao = strtoul(a["hex"] | "0", nullptr, 16);
+        b.flight = a["flight"] | "";
+        while (!b.flight.empty() && b.flight.back() == ' ') b.flight.pop_back();
+        b.lat = a["lat"] | (double)NAN;
+        b.lon = a["lon"] | (double)NAN;
+        b.alt = a["alt_baro"] | 0;
+        b.vrate = a["baro_rate"] | 0;
+        b.gs = a["gs"] | 0.0;
+        b.track = a["track"] | 0.0;
+        out.push_back(b);
+    }
+    return out;
+}
+
+static bool near(double a, double b, double tol) {
+    return fabs(a - b) <= tol;
+}
+
+static void runAdsb() {
+    static AdsbDecoder dec;
+    std::vector<BenchAircraft> fleet = loadAircraft();
+
+    // One pass per message type across the whole fleet, as a real
+    // feed interleaves them; the second even frame decodes locally.
+    // Timestamps step by 0x1A1A so escapes turn up in every field.
+    std::string stream;
+    uint64_t ts = 0;
+    uint8_t msg[14];
+    int frames = 0, corrupt = 0, truncated = 0;
+    for (int pass = 0; pass < 5; pass++) {
+        for (const BenchAircraft& a : fleet) {
+            bool pos = !isnan(a.lat);
+            if (pass == 0 && !a.flight.empty()) modesIdent(msg, a.icao, a.flight.c_str());
+            else if ((pass == 1 || pass == 4) && pos) modesPosition(msg, a.icao, a.lat, a.lon, a.alt, 0);
+            else if (pass == 2 && pos) modesPosition(msg, a.icao, a.lat, a.lon, a.alt, 1);
+            else if (pass == 3) modesVelocity(msg, a.icao, a.gs, a.track, a.vrate);
+            else continue;
+            stream += beastFrame(msg, 14, ts += 0x1A1A);
+            frames++;
+
+            // Noise between frames: Mode A/C, a flipped bit, a frame
+            // cut short by the next one's sync
+            if (frames % 7 == 0) {
+                const uint8_t modeAC[2] = {0x1A, 0x21};
+                stream += beastFrame(modeAC, 2, ts += 0x1A1A);
+            }
+            if (frames % 11 == 0) {
+                uint8_t bad[14];
+                memcpy(bad, msg, 14);
+                bad[5 + frames % 6] ^= 0x04;
+                stream += beastFrame(bad, 14, ts += 0x1A1A);
+                frames++;
+                corrupt++;
+            }
+            if (frames % 13 == 0) {
+                stream += beastFrame(msg, 14, ts += 0x1A1A).substr(0, 12);
+                truncated++;
+            }
+        }
+    }
+
+    // Random splits, as TCP delivers them
+    auto feedAll = [&](uint32_t nowMs) {
+        uint32_t seed = 12345;
+        for (size_t at = 0; at < stream.size();) {
+            seed = seed * 1103515245 + 12345;
+            size_t n = std::min<size_t>(1 + (seed >> 16) % 1460, stream.size() - at);
+            dec.feed((const uint8_t*)stream.data() + at, n, nowMs);
+            at += n;
+        }
+    };
+
+    dec.begin(RADAR_LAT, RADAR_LON);
+    feedAll(1000);
+
+    const AdsbStats& st = dec.stats();
+    bool ok = dec.count() == (int)fleet.size() && st.frames == (uint32_t)frames &&
+              st.badCrc == (uint32_t)corrupt && st.resyncs == (uint32_t)truncated &&
+              st.tableFull == 0;
+    if (!ok) {
+        fprintf(stderr, "adsb/beast: %d aircraft, %u frames (%d), %u bad CRC (%d), %u resyncs (%d)\n",
+                dec.count(), st.frames, frames, st.badCrc, corrupt, st.resyncs, truncated);
+        exit(1);
+    }
+    for (const BenchAircraft& b : fleet) {
+        const AdsbAircraft* a = dec.find(b.icao);
+        double dTrack = fmod(fabs(a ? a->track - b.track : 0) + 180, 360) - 180;
+        bool good = a && near(a->gsKt, b.gs, 1.5) && fabs(dTrack) <= 2 &&
+                    a->vrateFpm == b.vrate / 64 * 64 && b.flight == a->callsign;
+        if (good && !isnan(b.lat)) {
+            good = a->posMs && near(a->lat, b.lat, 2e-4) && near(a->lon, b.lon, 2e-4) &&
+                   near(a->altFt, b.alt, 25);
+        }
+        if (!good) {
+            fprintf(stderr, "adsb/beast: %06X decoded wrong\n", b.icao);
+            exit(1);
+        }
+    }
+
+    // Half the fleet heard again at 30 s; at 61.5 s only they remain,
+    // and backward-shift deletion must leave every one findable
+    for (size_t i = 0; i < fleet.size(); i += 2) {
+        modesVelocity(msg, fleet[i].icao, fleet[i].gs, fleet[i].track, fleet[i].vrate);
+        dec.apply(msg, 14, 30000);
+    }
+    dec.expire(1000 + ADSB_AGE_MS + 500);
+    bool expired = dec.count() == (int)(fleet.size() + 1) / 2;
+    for (size_t i = 0; i < fleet.size(); i++) {
+        if ((dec.find(fleet[i].icao) != nullptr) != (i % 2 == 0)) expired = false;
+    }
+    dec.expire(30000 + ADSB_AGE_MS + 500);
+    if (!expired || dec.count() != 0) {
+        fprintf(stderr, "adsb/beast: expiry left %d aircraft\n", dec.count());
+        exit(1);
+    }
+
+    // More aircraft than the load cap: the extra ones are turned away
+    for (uint32_t i = 0; i < ADSB_MAX_AIRCRAFT; i++) {
+        modesIdent(msg, 0x400000 + i * 0x1234, "TEST");
+        dec.apply(msg, 14, 2000);
+    }
+    if (dec.count() != ADSB_MAX_LOAD || st.tableFull != ADSB_MAX_AIRCRAFT - ADSB_MAX_LOAD) {
+        fprintf(stderr, "adsb/beast: load cap let in %d aircraft\n", dec.count());
+        exit(1);
+    }
+    dec.expire(2000 + ADSB_AGE_MS + 500);
+
+    const int iters = 200;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) feedAll(1000);
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / iters / frames;
+    printf("{\"case\":\"adsb/beast\",\"iters\":%d,\"ns_per_iter\":%.0f,\"frames\":%d,"
+           "\"stream_bytes\":%zu,\"msgs_per_s\":%.0f,\"table_bytes\":%u}\n",
+           iters, ns, frames, stream.size(), 1e9 / ns, (unsigned)sizeof(AdsbDecoder));
+    fflush(stdout);
+
+    // What the radar screen draws
+    adsbPublish(dec, RADAR_RANGE_NM, 850, true, 1000);
+    fetchRadar();
+}
+
+// Services panel from the Kuma scrape: one up, one down (Kuma
+// reports -1 ms for it), the rest with their response times
+static void checkServices() {
+    MetricStore m;
+    metricsRead(m);
+    bool ok = m.value[M_SERVICE_UP + 3] == 1 && m.value[M_SERVICE_MS + 3] == 185 &&
+              m.value[M_SERVICE_UP + 1] == 0 && m.state[M_SERVICE_MS + 1] == MS_EMPTY;
+    for (int i = 0; i < METRIC_SERVICES; i++) {
+        if (m.state[M_SERVICE_UP + i] != MS_LIVE) ok = false;
+    }
+    if (!ok) {
+        fprintf(stderr, "decode/services: Kuma scrape decoded wrong\n");
+        exit(1);
+    }
+}
+
+// ============================================
+// Compile-time gauges (gaugetables.h) against the runtime path
+// Both have to leave the same framebuffer for every config, value
+// and muted state: from below the range to above it, thresholds
+// and ends exactly
+// ============================================
+static constexpr GaugeConfig BENCH_MID_GAUGE = {     // M900 CPU / Custom shape
+    .minVal     = 0,
+    .maxVal     = 100,
+    .warnVal    = 50,
+    .critVal    = 80,
+    .arcRadius  = 55,
+    .arcWidth   = 10,
+    .startAngle = 135,
+    .sweepAngle = 270
+};
+
+template <const GaugeConfig& C>
+static void checkGaugeTables(const char* name) {
+    LGFX_Sprite* a = frames[0];
+    LGFX_Sprite* b = frames[1];
+    std::vector<float> values = {C.minVal, C.maxVal, C.warnVal, C.critVal, NAN};
+    float range = C.maxVal - C.minVal;
+    for (float v = C.minVal - range / 10; v <= C.maxVal + range / 10; v += range / 173) values.push_back(v);
+
+    for (float v : values) {
+        for (int muted = 0; muted < 2; muted++) {
+            a->fillScreen(PAL_BLACK);
+            b->fillScreen(PAL_BLACK);
+            drawGauge(a, 120, 120, v, C, "G", "%", "%.0f", muted);
+            drawGauge<C>(b, 120, 120, v, "G", "%", "%.0f", muted);
+            if (v == v && memcmp(a->getBuffer(), b->getBuffer(), a->bufferLength()) != 0) {
+                fprintf(stderr, "gauge/tables: %s at %g%s differs from the runtime path\n",
+                        name, v, muted ? " (muted)" : "");
+                exit(1);
+            }
+        }
+    }
+}
+
+template <const GaugeConfig& C>
+static size_t gaugeTableBytes() {
+    return sizeof(GaugeArcOf<C>::table) + sizeof(GaugeTicks<C, 9>::table);
+}
+
+static void runGaugeTables() {
+    checkGaugeTables<DEFAULT_GAUGE>("DEFAULT_GAUGE");
+    checkGaugeTables<TEMP_GAUGE>("TEMP_GAUGE");
+    checkGaugeTables<CPU_GAUGE>("CPU_GAUGE");
+    checkGaugeTables<RAM_GAUGE>("RAM_GAUGE");
+    checkGaugeTables<SMALL_GAUGE>("SMALL_GAUGE");
+    checkGaugeTables<BENCH_MID_GAUGE>("mid-size");
+
+    // CPU/RAM/TEMP/DEFAULT share one arc table
+    printf("{\"case\":\"gauge/tables\",\"flash_bytes_large\":%zu,\"flash_bytes_mid\":%zu,"
+           "\"flash_bytes_small\":%zu}\n",
+           gaugeTableBytes<CPU_GAUGE>(), gaugeTableBytes<BENCH_MID_GAUGE>(),
+           gaugeTableBytes<SMALL_GAUGE>());
+    fflush(stdout);
+}
+
+// ============================================
+// Multi-CS broadcast
+// Every panel's GRAM must end up as its own framebuffer expanded
+// through the palette, wherever the glass is visible
+// ============================================
+static void checkGram(const char* name) {
+    for (int i = 0; i < NUM_DISPLAYS; i++) {
+        for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+            const RowSpan& s = visibleSpans[y];
+            for (int x = s.x0; x < s.x0 + s.w; x++) {
+                if (displays[i]->gramPixel(x, y) != PALETTE[frames[i]->readPixelValue(x, y)]) {
+                    fprintf(stderr, "%s: panel %d wrong at %d,%d\n", name, i, x, y);
+                    exit(1);
+                }
+            }
+        }
+    }
+}
+
+// Boot splash as main.cpp sends it: the shared ring once to all
+// six, then each label's box to its own panel
+static void splash() {
+    static const char* const labels[NUM_DISPLAYS] = {
+        "UNRAID", "M900", "RADAR", "SERVICES", "CUSTOM", "CLOCK",
+    };
+    drawBootSplash(0);
+    for (int i = 1; i < NUM_DISPLAYS; i++) {
+        memcpy(frames[i]->getBuffer(), frames[0]->getBuffer(), frames[0]->bufferLength());
+    }
+    flushFrameTo(PANEL_MASK_ALL, 0);
+    for (int i = 0; i < NUM_DISPLAYS; i++) {
+        int x, y, w, h;
+        drawBootLabel(i, labels[i], x, y, w, h);
+        flushRect(i, x, y, w, h);
+    }
+}
+
+static void runBroadcast() {
+    // Give each panel's driver a different window history first
+    for (int i = 0; i < NUM_DISPLAYS; i++) {
+        frames[i]->fillScreen(PAL_BLACK);
+        frames[i]->fillRect(20 * i, 30, 40, 40 + 10 * i, PAL_RED);
+        flushRect(i, 20 * i, 30, 40, 40 + 10 * i);
+    }
+
+    runCase("bus/broadcast", 200, frames[0], splash);
+    checkGram("bus/broadcast");
+
+    // The same frames sent the old way, one panel at a time
+    runCase("bus/separate", 200, frames[0], [] {
+        for (int i = 0; i < NUM_DISPLAYS; i++) flushFrame(i);
+    });
+    checkGram("bus/separate");
+
+    // Window caching. Panel 1 (the lead below) last sent box A on
+    // its own and panel 3 box B, so the broadcast of A finds the
+    // lead's driver sure it's already there; then panel 3's driver
+    // is sure it's still on B. Both writes must land regardless.
+    frames[1]->fillRect(100, 100, 40, 40, PAL_GREEN);
+    flushRect(1, 100, 100, 40, 40);
+    frames[3]->fillRect(60, 150, 40, 20, PAL_GREEN);
+    flushRect(3, 60, 150, 40, 20);
+    for (int i = 0; i < NUM_DISPLAYS; i++) {
+        frames[i]->fillRect(100, 100, 40, 40, PAL_CYAN);
+    }
+    flushRectTo(PANEL_MASK_ALL & ~1, 1, 100, 100, 40, 40);
+    flushRect(0, 100, 100, 40, 40);
+    checkGram("bus/stale-window");
+    frames[3]->fillRect(60, 150, 40, 20, PAL_MAGENTA);
+    flushRect(3, 60, 150, 40, 20);
+    checkGram("bus/stale-window");
+}
+
+// ============================================
+// Services list in hardware scroll
+// The glass (GRAM seen through the panel's scroll) has to show the
+// same thing however the list got there: row-at-a-time steps and
+// updates against a full redraw, and a whole lap against the start
+// ============================================
+
+// One round of updates the way main.cpp sends them; returns the
+// area of the rects it sent
+static int servicesJob(bool scroll) {
+    int x, y, w, h, area = 0;
+    while (updateServices(SCREEN_SERVICES, scroll, x, y, w, h)) {
+        scrollPanel(SCREEN_SERVICES, servicesScroll());
+        flushRect(SCREEN_SERVICES, x, y, w, h);
+        area += w * h;
+        scroll = false;
+    }
+    return area;
+}
+
+static void servicesFull() {
+    drawServices(SCREEN_SERVICES);
+    scrollPanel(SCREEN_SERVICES, servicesScroll());
+    flushFrame(SCREEN_SERVICES);
+}
+
+static std::vector<uint16_t> glassImage(int idx) {
+    std::vector<uint16_t> img;
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        const RowSpan& s = visibleSpans[y];
+        for (int x = s.x0; x < s.x0 + s.w; x++) img.push_back(displays[idx]->glassPixel(x, y));
+    }
+    return img;
+}
+
+static void checkServicesGlass(const char* name) {
+    std::vector<uint16_t> stepped = glassImage(SCREEN_SERVICES);
+    servicesFull();
+    if (glassImage(SCREEN_SERVICES) != stepped) {
+        fprintf(stderr, "%s: glass differs from a full redraw\n", name);
+        exit(1);
+    }
+}
+
+static void runServicesScroll() {
+    // Dots that tell neighbouring rows apart
+    for (int i = 0; i < METRIC_SERVICES; i++) {
+        metricSet(M_SERVICE_UP + i, i % 3 ? 1 : 0, SRC_KUMA);
+    }
+    metricsPublish();
+    servicesFull();
+    if (servicesScroll().rows == 0) return;     // list fits, nothing scrolls
+
+    // Every step is one row (less what the bezel hides), and a lap
+    // brings back the first image
+    std::vector<uint16_t> start = glassImage(SCREEN_SERVICES);
+    int rowArea = 0;
+    for (int i = 0; i < METRIC_SERVICES; i++) {
+        uint64_t before = lgfx::busCounters.pixels;
+        int area = servicesJob(true);
+        uint64_t pixels = lgfx::busCounters.pixels - before;
+        if (i == 0) rowArea = area;
+        if (area != rowArea || pixels > (uint64_t)area || pixels == 0) {
+            fprintf(stderr, "services/scroll: step %d sent %llu pixels over %d\n",
+                    i, (unsigned long long)pixels, area);
+            exit(1);
+        }
+        if (i == 3) checkServicesGlass("services/scroll");
+    }
+    if (glassImage(SCREEN_SERVICES) != start) {
+        fprintf(stderr, "services/scroll: a full lap doesn't show the list it started with\n");
+        exit(1);
+    }
+    runCase("services/scroll", METRIC_SERVICES * 20, frames[SCREEN_SERVICES], [] { servicesJob(true); });
+    checkServicesGlass("services/scroll");
+
+    // One dot changes: its row goes out, wherever the window is,
+    // and the up count above
+    for (int i = 0; i < 4; i++) servicesJob(true);
+    metricSet(M_SERVICE_UP + 5, 0, SRC_KUMA);
+    metricsPublish();
+    int area = servicesJob(false);
+    if (area <= rowArea || area > 2 * rowArea) {
+        fprintf(stderr, "services/row: a dot change sent %d pixels' worth, a row is %d\n", area, rowArea);
+        exit(1);
+    }
+    checkServicesGlass("services/row");
+
+    // A response time alone: just the row
+    metricSet(M_SERVICE_MS + 5, 321, SRC_KUMA);
+    metricsPublish();
+    area = servicesJob(false);
+    if (area != rowArea) {
+        fprintf(stderr, "services/row: a response time sent %d pixels' worth, a row is %d\n", area, rowArea);
+        exit(1);
+    }
+    checkServicesGlass("services/row");
+    runCase("services/row", 200, frames[SCREEN_SERVICES], [] {
+        static int n = 0;
+        metricSet(M_SERVICE_UP + 5, n++ & 1, SRC_KUMA);
+        metricsPublish();
+        servicesJob(false);
+    });
+
+    // Warm start with the window part way round: the restored frame
+    // shows the same list, give or take the stale ring
+    for (int i = 0; i < 3; i++) servicesJob(true);
+    std::vector<uint16_t> shown = glassImage(SCREEN_SERVICES);
+    static uint8_t state[1024];                 // snapshot.cpp STATE_MAX
+    size_t stateLen = saveScreenState(state, sizeof(state));
+    LGFX_Sprite* fb = frames[SCREEN_SERVICES];
+    std::vector<uint8_t> saved((uint8_t*)fb->getBuffer(), (uint8_t*)fb->getBuffer() + fb->bufferLength());
+    drawServices(SCREEN_SERVICES);             // window back at 0, as after a boot
+    if (stateLen == 0 || !loadScreenState(state, stateLen)) {
+        fprintf(stderr, "services/restore: state didn't round-trip\n");
+        exit(1);
+    }
+    memcpy(fb->getBuffer(), saved.data(), saved.size());
+    markStaleFrame(SCREEN_SERVICES);
+    scrollPanel(SCREEN_SERVICES, servicesScroll());
+    flushFrame(SCREEN_SERVICES);
+    std::vector<uint16_t> restored = glassImage(SCREEN_SERVICES);
+    for (size_t i = 0; i < shown.size(); i++) {
+        if (restored[i] != shown[i] && restored[i] != PALETTE[PAL_DARKGREY]) {
+            fprintf(stderr, "services/restore: a frame saved mid-scroll comes back rotated\n");
+            exit(1);
+        }
+    }
+    servicesFull();
+}
+
+// ============================================
+// Fixtures behind the mock HTTP client
+// ============================================
+static void registerRoutes(bool gzip = false) {
+    char url[64];
+    snprintf(url, sizeof(url), "http://%s:%d/stats", UNRAID_IP, UNRAID_STATS_PORT);
+    if (gzip) {
+        mockHttpRoute(url, loadFixture("unraid.json.gz"), 200, "gzip");
+    } else {
+        mockHttpRoute(url, loadFixture("unraid.json"));
+    }
+    snprintf(url, sizeof(url), "http://%s:%d/stats", M900_IP, M900_STATS_PORT);
+    mockHttpRoute(url, loadFixture("m900.json"));
+
+    std::string pi = loadFixture("pi.json");
+    mockHttpRoute("http://" PI_FLIGHT_IP ":9200/", pi);
+    mockHttpRoute("http://" PI_UPTIME_IP ":9200/", pi);
+    mockHttpRoute("http://" PI_SPARE1_IP ":9200/", pi);
+
+    // Uptime Kuma, compressed as Kuma's express server sends it
+    mockHttpRoute(UPTIME_KUMA_URL "/metrics", loadFixture("kuma-metrics.txt.gz"), 200, "gzip");
+
+    // Both switch addresses are the same placeholder until configured
+    mockUdpClearRoutes();
+    mockUdpRoute(SWITCH_1_IP, SNMP_PORT, [](const std::string& req) { return switchAgent.handle(req); });
+    if (strcmp(SWITCH_2_IP, SWITCH_1_IP) != 0) {
+        mockUdpRoute(SWITCH_2_IP, SNMP_PORT, [](const std::string& req) { return switchAgent.handle(req); });
+    }
+}
+
+// ============================================
+// Pi-hole
+// The summary is polled every time, the top-client list only when
+// the totals have moved and it's due; rates come from the deltas
+// ============================================
+static std::string piholeSummary(double total, double blocked) {
+    std::string s = loadFixture("pihole-summary.json");
+    auto put = [&s](const char* key, double v) {
+        size_t at = s.find(key) + strlen(key);
+        size_t end = s.find(',', at);
+        s.replace(at, end - at, std::to_string((long)v));
+    };
+    put("\"total\":", total);
+    put("\"blocked\":", blocked);
+    return s;
+}
+
+static void piholeRoutes(const std::string& summary) {
+    mockHttpClearRoutes();
+    registerRoutes();
+    mockHttpRoute(PIHOLE_URL "/api/stats/summary", summary);
+    mockHttpRoute(PIHOLE_URL "/api/stats/top_clients", loadFixture("pihole-top-clients.json"));
+}
+
+static void failPihole(const char* what) {
+    fprintf(stderr, "decode/pihole: %s\n", what);
+    exit(1);
+}
+
+static void runPihole() {
+    piholeRoutes(piholeSummary(48213, 9127));
+    runCase("decode/pihole", 500, nullptr, [] { fetchPihole(); });
+
+    // Totals never moved: one listing, at the first poll
+    if (mockHttpHits(PIHOLE_URL "/api/stats/summary") != 501 ||
+        mockHttpHits(PIHOLE_URL "/api/stats/top_clients") != 1) {
+        failPihole("top clients requested with unchanged totals");
+    }
+    MetricStore m;
+    metricsRead(m);
+    if (m.value[M_DNS_QUERIES] != 48213 || m.value[M_DNS_BLOCKED] != 9127 ||
+        m.value[M_DNS_FORWARDED] != 27604 || m.value[M_DNS_CACHED] != 11318 ||
+        m.value[M_DNS_CLIENTS] != 23 || m.value[M_DNS_QPS] != 0 || m.value[M_DNS_BLOCK_PCT] != 0) {
+        failPihole("summary decoded wrong");
+    }
+    if (m.value[M_DNS_CLIENT_QUERIES] != 9214 || m.value[M_DNS_CLIENT_QUERIES + 2] != 5102 ||
+        m.state[M_DNS_CLIENT_QUERIES + 2] != MS_LIVE || m.state[M_DNS_CLIENT_QUERIES + 3] != MS_EMPTY) {
+        failPihole("top clients decoded wrong");
+    }
+    char doc[STATS_DOC_MAX];
+    if (!formatStatsJson(doc, sizeof(doc)) || !strstr(doc, "{\"name\":\"living-room\",\"count\":9214}") ||
+        !strstr(doc, "{\"name\":\"10.1.10.57\",\"count\":5102}")) {
+        failPihole("/stats document wrong or over STATS_DOC_MAX");
+    }
+
+    // 600 queries, 150 blocked since: rate over the time elapsed,
+    // ratio across the window, list not due again yet
+    uint32_t t0 = m.sampledMs[M_DNS_QUERIES];
+    delay(200);
+    piholeRoutes(piholeSummary(48813, 9277));
+    fetchPihole();
+    metricsRead(m);
+    double expect = 600 * 1000.0 / (m.sampledMs[M_DNS_QUERIES] - t0);
+    if (fabs(m.value[M_DNS_QPS] - expect) > expect * 0.02 || m.value[M_DNS_BLOCK_PCT] != 25 ||
+        mockHttpHits(PIHOLE_URL "/api/stats/top_clients") != 0) {
+        failPihole("rates wrong");
+    }
+
+    // FTL aged queries out: no rate from that poll, the next counts
+    // from the lower totals
+    double before = m.value[M_DNS_QPS];
+    piholeRoutes(piholeSummary(47000, 9000));
+    fetchPihole();
+    metricsRead(m);
+    bool held = m.value[M_DNS_QPS] == before;
+    delay(5);
+    piholeRoutes(piholeSummary(47100, 9010));
+    fetchPihole();
+    metricsRead(m);
+    if (!held || m.value[M_DNS_BLOCK_PCT] != 10) failPihole("counter drop not handled");
+
+    // Pi-hole gone: everything greys, nothing is cleared
+    mockHttpClearRoutes();
+    registerRoutes();
+    fetchPihole();
+    metricsRead(m);
+    if (m.state[M_DNS_QPS] != MS_STALE || m.state[M_DNS_CLIENT_QUERIES] != MS_STALE ||
+        m.value[M_DNS_QUERIES] != 47100) {
+        failPihole("failed poll not marked stale");
+    }
+
+    // A switch poll must not make Pi-hole look fresh in /stats
+    char was[STATS_DOC_MAX], now[STATS_DOC_MAX];
+    formatStatsJson(was, sizeof(was));
+    delay(5);
+    fetchSwitches();
+    if (!formatStatsJson(now, sizeof(now)) || !strstr(now, "\"switches\":{") ||
+        !strstr(now, "\"in_mbps\":") ||
+        strncmp(strstr(was, "\"pihole\":"), strstr(now, "\"pihole\":"), 48) != 0) {
+        failPihole("/stats pihole refreshed by a switch poll, or switches missing");
+    }
+}
+
+// ============================================
+// Metric history
+// Days of every metric at its source's cadence, shaped like the
+// real thing: constants, slow drifts, noisy percentages, counters
+// ============================================
+struct HistSample {
+    uint8_t  id;
+    uint32_t t;
+    float    value;
+};
+
+struct HistSeries {
+    uint32_t rng;
+    double   x;
+    uint32_t next;          // next due, epoch s
+    int      cadence;
+    char     kind;          // c)onstant t)emp p)ercent s)low n)oisy i)nt k) counter
+    double   q;             // quantum the source reports in
+};
+
+static uint32_t histRand(HistSeries& s) {
+    s.rng ^= s.rng << 13;
+    s.rng ^= s.rng >> 17;
+    s.rng ^= s.rng << 5;
+    return s.rng;
+}
+
+static HistSeries histSeries(int id, uint32_t start) {
+    HistSeries s = {0x9E3779B9u * (id + 1), 0, start, 10, 'n', 0.01};
+    auto in = [id](int first, int n) { return id >= first && id < first + n; };
+    if (id < M_M900_CPU || in(M_PI_TEMP, M_SERVICE_UP - M_PI_TEMP)) s.cadence = 15;
+    if (in(M_SERVICE_UP, 2 * METRIC_SERVICES)) s.cadence = 30;
+
+    if (in(M_UNRAID_DRIVE_TEMP, METRIC_DRIVES) || id == M_M900_CPU_TEMP) {
+        s = {s.rng, 38.0 + id % 5, start, s.cadence, 't', 1};
+    } else if (in(M_PI_TEMP, METRIC_PIS)) {
+        s = {s.rng, 48.3, start, s.cadence, 't', 0.1};
+    } else if (id == M_UNRAID_CPU || id == M_UNRAID_MEM || id == M_M900_CPU || id == M_M900_MEM ||
+               in(M_PI_CPU, 2 * METRIC_PIS) || id == M_DNS_BLOCK_PCT) {
+        s = {s.rng, 20.0 + id % 30, start, s.cadence, 'p', 0.1};
+    } else if (id == M_UNRAID_STORAGE_USED_TB || id == M_M900_MEM_USED_GB || id == M_M900_DISK ||
+               id == M_M900_DISK_USED_GB) {
+        s = {s.rng, 24.876, start, s.cadence, 's', 0.001};
+    } else if (id == M_M900_NET_SENT || id == M_M900_NET_RECV || in(M_DNS_QUERIES, 4) ||
+               in(M_DNS_CLIENT_QUERIES, METRIC_DNS_CLIENTS)) {
+        s = {s.rng, 4.8e4 * (id % 7 + 1), start, s.cadence, 'k', 1};
+    } else if (in(M_SERVICE_MS, METRIC_SERVICES) || id == M_ADSB_AIRCRAFT || id == M_DNS_CLIENTS) {
+        s = {s.rng, 40.0, start, s.cadence, 'i', 1};
+    } else if (in(M_SWITCH_IN_MBPS, 2 * METRIC_SWITCHES * METRIC_SWITCH_PORTS) && id % 2) {
+        s = {s.rng, 0, start, s.cadence, 'c', 1};        // idle port
+    } else if (id == M_M900_NET_UP_MBPS || id == M_M900_NET_DOWN_MBPS || id == M_DNS_QPS ||
+               id == M_ADSB_MSG_RATE || in(M_SWITCH_IN_MBPS, 2 * METRIC_SWITCHES * METRIC_SWITCH_PORTS)) {
+        s = {s.rng, 5.0 + id % 11, start, s.cadence, 'n', 0.01};
+    } else {
+        s = {s.rng, 8.0 + id % 3, start, s.cadence, 'c', 1};        // counts, totals, up/down
+    }
+    return s;
+}
+
+static HistSample histNext(HistSeries& s, int id) {
+    uint32_t r = histRand(s);
+    double u = (r & 0xFFFF) / 65536.0 - 0.5;
+    switch (s.kind) {
+    case 'c': if (r % 20000 == 0) s.x += 1; break;
+    case 't': if (r % 40 == 0) s.x += (r & 0x10000) ? s.q : -s.q; break;
+    case 'p': s.x = constrain(s.x + u * 4, 0.0, 100.0); break;
+    case 's': if (r % 20 == 0) s.x += s.q; break;
+    case 'k': s.x += (r >> 16) % 1500; break;
+    case 'i': s.x = 30 + (r >> 16) % 40; break;
+    case 'n': s.x = fabs(s.x + u * 2); break;
+    }
+    // A poll on a millis() timer lands a second early or late now and then
+    uint32_t t = s.next + ((r >> 24) % 16 == 0 ? ((r >> 28) & 1 ? 1 : -1) : 0);
+    s.next += s.cadence;
+    return {(uint8_t)id, t, (float)(round(s.x / s.q) * s.q)};
+}
+
+static void failHistory(const char* what) {
+    fprintf(stderr, "history: %s\n", what);
+    exit(1);
+}
+
+// historyQuery against binning the samples by hand
+static void checkHistory(const std::vector<HistSample>& samples, int id, uint32_t from, uint32_t to,
+                         int buckets, const char* what) {
+    std::vector<HistoryBucket> got(buckets), want(buckets, HistoryBucket{INFINITY, -INFINITY, 0, 0});
+    std::vector<double> sums(buckets, 0);
+    historyQuery(id, from, to, got.data(), buckets);
+    for (const HistSample& s : samples) {
+        if (s.id != id || s.t < from || s.t >= to) continue;
+        int b = (int)((uint64_t)(s.t - from) * buckets / (to - from));
+        want[b].min = std::min(want[b].min, s.value);
+        want[b].max = std::max(want[b].max, s.value);
+        want[b].count++;
+        sums[b] += s.value;
+    }
+    for (int b = 0; b < buckets; b++) {
+        const HistoryBucket& g = got[b];
+        const HistoryBucket& w = want[b];
+        double mean = w.count ? sums[b] / w.count : 0;
+        if (g.count != w.count ||
+            (w.count && (g.min != w.min || g.max != w.max ||
+                         fabs(g.mean - mean) > 1e-4 * std::max(fabs(mean), 1.0)))) {
+            fprintf(stderr, "history: %s: metric %d bucket %d: got %u [%g %g %g] want %u [%g %g %g]\n",
+                    what, id, b, g.count, g.min, g.max, g.mean, w.count, w.min, w.max, mean);
+            exit(1);
+        }
+    }
+}
+
+static void timeQuery(const char* name, int id, uint32_t from, uint32_t to, int buckets, int iters) {
+    std::vector<HistoryBucket> out(buckets);
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++) historyQuery(id, from, to, out.data(), buckets);
+    auto t1 = std::chrono::steady_clock::now();
+    const HistoryStats& st = historyStats();
+    printf("{\"case\":\"%s\",\"iters\":%d,\"ns_per_iter\":%.0f,\"sectors_read\":%u,"
+           "\"headers_read\":%u,\"decoded\":%u,\"rolled_up\":%u}\n",
+           name, iters, std::chrono::duration<double, std::nano>(t1 - t0).count() / iters,
+           st.sectorsRead, st.headersRead, st.decoded, st.rolledUp);
+    fflush(stdout);
+}
+
+static void runHistory() {
+    const uint32_t start = 1760000000, day = 86400, span = 4 * day;
+    mockPartition("history", 0x41, 0x3E0000);
+    if (!historyBegin() || historyStats().used != 0) failHistory("blank partition not mounted");
+
+    // --- Four days, in the order the fetches would append them ---
+    std::vector<HistSeries> series;
+    for (int id = 0; id < M_COUNT; id++) series.push_back(histSeries(id, start));
+    std::vector<HistSample> samples;
+    for (uint32_t t = start; t < start + span; t += 5) {
+        for (int id = 0; id < M_COUNT; id++) {
+            if (series[id].next <= t) samples.push_back(histNext(series[id], id));
+        }
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (const HistSample& s : samples) historyAppend(s.id, s.t, s.value);
+    auto t1 = std::chrono::steady_clock::now();
+    historySeal();
+
+    const HistoryStats& st = historyStats();
+    double perSample = (double)st.flashBytes / st.samples;
+    double days = st.sectors * 4096.0 / (st.flashBytes / 4.0);
+    printf("{\"case\":\"history/append\",\"iters\":%u,\"ns_per_iter\":%.0f,\"flash_bytes\":%u,"
+           "\"bytes_per_sample\":%.2f,\"days_held\":%.1f}\n",
+           st.samples, std::chrono::duration<double, std::nano>(t1 - t0).count() / st.samples,
+           st.flashBytes, perSample, days);
+    fflush(stdout);
+    uint32_t first = std::min_element(samples.begin(), samples.end(), [](const HistSample& a, const HistSample& b) {
+        return a.t < b.t;
+    })->t;
+    if (st.samples != samples.size() || st.erases >= st.sectors || st.oldest != first) {
+        failHistory("four days didn't fit");
+    }
+
+    // --- Every metric, every sample over a day; hourly over all four ---
+    for (int id = 0; id < M_COUNT; id++) {
+        checkHistory(samples, id, start + 3 * day, start + 4 * day, day / 10, "day at 10 s");
+        checkHistory(samples, id, start, start + span, 96, "hourly");
+    }
+    checkHistory(samples, M_M900_CPU, start + 1234, start + span - 777, 97, "odd window");
+
+    timeQuery("history/query-days", M_M900_CPU, start, start + span, 96, 50);
+    if (historyStats().rolledUp == 0) failHistory("four-day query used no rollups");
+    timeQuery("history/query-hour", M_M900_CPU, start + 3 * day, start + 3 * day + 3600, 60, 500);
+    if (historyStats().sectorsRead * 20 > historyStats().used) failHistory("hour query read the whole log");
+
+    // --- Power cut: open blocks are lost, sealed ones stay ---
+    historyAppend(M_M900_CPU, start + span + 10, 42.5f);
+    historyBegin();
+    checkHistory(samples, M_M900_CPU, start, start + span + 3600, 200, "after remount");
+
+    // A torn record is dropped and the log carries on in a new sector
+    mockPartitionTearNextWrite("history", 20);
+    historyAppend(M_M900_CPU, start + span + 10, 42.5f);
+    historySeal();
+    historyBegin();
+    checkHistory(samples, M_M900_CPU, start, start + span + 3600, 200, "after torn write");
+    historyAppend(M_M900_CPU, start + span + 20, 43.5f);
+    historySeal();
+    samples.push_back({M_M900_CPU, start + span + 20, 43.5f});
+    checkHistory(samples, M_M900_CPU, start, start + span + 3600, 200, "appended after torn write");
+    if (historyStats().erases != 1) failHistory("torn sector written on");
+
+    // --- Ten more days: the ring laps, every sector wears alike ---
+    std::vector<HistSample> last;
+    uint32_t end = start + span + 10 * day;
+    for (HistSeries& s : series) s.next = std::max(s.next, start + span + 30);
+    for (uint32_t t = start + span + 30; t < end; t += 5) {
+        for (int id = 0; id < M_COUNT; id++) {
+            if (series[id].next > t) continue;
+            HistSample s = histNext(series[id], id);
+            historyAppend(s.id, s.t, s.value);
+            if (s.id == M_PI_TEMP && s.t >= end - day) last.push_back(s);
+        }
+    }
+    historySeal();
+    const std::vector<uint32_t>& erases = mockPartitionErases("history");
+    uint32_t lo = *std::min_element(erases.begin(), erases.end());
+    uint32_t hi = *std::max_element(erases.begin(), erases.end());
+    if (lo < 2 || hi - lo > 1) failHistory("uneven wear");
+    HistoryBucket gone[4];
+    if (historyQuery(M_M900_CPU, start, start + span, gone, 4) != 0 || historyStats().oldest <= start + span) {
+        failHistory("oldest days not dropped");
+    }
+    checkHistory(last, M_PI_TEMP, end - day, end, 24 * 6, "last day after laps");
+
+    // --- From the store: each new live sample once, then rate-limited ---
+    fetchM900();
+    uint32_t before = historyStats().samples;
+    historyRecord();
+    MetricStore m;
+    metricsRead(m);
+    uint32_t live = 0;
+    for (int id = 0; id < M_COUNT; id++) live += (m.state[id] == MS_LIVE);
+    uint32_t recorded = historyStats().samples - before;
+    fetchM900();
+    historyRecord();
+    if (recorded != live || historyStats().samples != before + recorded) {
+        failHistory("store samples recorded wrong");
+    }
+}
+
+// Every framebuffer holds palette indices at FRAME_DEPTH: each PAL_*
+// colour reads back as itself and reaches the panel as its PALETTE
+// entry. An 8bpp sprite created without a palette is rgb332 and
+// turns the indices into near-black.
+static void checkFrameDepth() {
+    for (int i = 0; i < NUM_DISPLAYS; i++) {
+        LGFX_Sprite* fb = frames[i];
+        if (fb->getColorDepth() != FRAME_DEPTH || !fb->hasPalette()) {
+            fprintf(stderr, "frame/depth: panel %d is not %d-bit palette-indexed\n", i, FRAME_DEPTH);
+            exit(1);
+        }
+        for (int c = 0; c < PAL_COUNT; c++) fb->fillRect(c * 8, 116, 8, 8, c);
+        flushFrame(i);
+        for (int c = 0; c < PAL_COUNT; c++) {
+            if (fb->readPixelValue(c * 8 + 4, 120) != (uint32_t)c ||
+                displays[i]->gramPixel(c * 8 + 4, 120) != PALETTE[c]) {
+                fprintf(stderr, "frame/depth: panel %d draws index %d wrong\n", i, c);
+                exit(1);
+            }
+        }
+        clearDisplay(i, PAL_BLACK);
+        flushFrame(i);
+    }
+}
+
+// ============================================
+// Main
+// ============================================
+int main(int argc, char** argv) {
+    if (argc > 1) fixtureDir = argv[1];
+
+    initDisplays();
+    checkFrameDepth();
+    setupCustom();
+    registerRoutes();
+
+    // --- JSON decode (HTTP mock -> schema decoder -> metric store) ---
+    runCase("decode/unraid", 2000, nullptr, [] { fetchUnraid(); });
+    runCase("decode/m900",   2000, nullptr, [] { fetchM900(); });
+    runCase("decode/pi",     500,  nullptr, [] { fetchPiHealth(); });
+    runCase("decode/services", 500, nullptr, [] { fetchServices(); });
+    checkServices();
+
+    // --- SNMP (stand-in agent over the mock UDP socket) ---
+    runSnmp();
+    runSwitches();
+
+    // --- Pi-hole (FTL API fixtures) ---
+    runPihole();
+
+    // --- Metric history (mock flash partition) ---
+    runHistory();
+
+    // --- ADS-B (synthetic Beast stream from aircraft.json.gz) ---
+    runAdsb();
+
+    // --- Compressed responses ---
+    mockHttpClearRoutes();
+    registerRoutes(true);
+    runCase("decode/unraid-gzip", 2000, nullptr, [] { fetchUnraid(); });
+    runInflate("inflate/aircraft", "aircraft.json.gz", 200);
+    runInflate("inflate/kuma-metrics", "kuma-metrics.txt.gz", 200);
+
+    // --- Schema decoder against the ArduinoJson reference ---
+    M900Stats m900Defaults = {};
+    PiStats piDefaults = {};
+    runDecoder("json/unraid", "unraid.json", UNRAID_SCHEMA, UNRAID_DEFAULTS, referenceUnraid, 2000);
+    runDecoder("json/unraid-edge", "unraid-edge.json", UNRAID_SCHEMA, UNRAID_DEFAULTS, referenceUnraid, 2000);
+    runDecoder("json/m900", "m900.json", M900_SCHEMA, m900Defaults, referenceM900, 2000);
+    runDecoder("json/pi", "pi.json", PI_SCHEMA, piDefaults, referencePi, 2000);
+    checkJsonCuts();
+
+    // --- Prometheus text format (Uptime Kuma) ---
+    runProm();
+
+    // --- Derived metrics (Custom screen) ---
+    runExpr("expr/max", "max(piTemps)", 57.5);
+    runExpr("expr/ratio", "unraid.used / unraid.total * 100", 24.876 / 38.142 * 100);
+    runExpr("expr/rate", "rate(m900.net.rx) * 8 / 1e6", 200);
+
+#if TRACE_ENABLED
+    runTrace();
+#endif
+
+    // --- Gauge kernels ---
+    LGFX_Sprite* fb = frames[0];
+    runCase("gauge/drawArc", 500, fb, [fb] {
+        drawArc(fb, 120, 120, 73, CPU_GAUGE);
+    });
+    runCase("gauge/drawMiniGauge", 500, fb, [fb] {
+        drawMiniGauge(fb, 72, 85, 58, SMALL_GAUGE, "FlightRdr", "58");
+    });
+    runCase("gauge/drawGauge", 500, fb, [fb] {
+        drawGauge(fb, 120, 120, 73, CPU_GAUGE, "CPU", "%");
+    });
+
+    // The same, specialised at compile time
+    runGaugeTables();
+    runCase("gauge/drawArc-static", 500, fb, [fb] {
+        drawArc<CPU_GAUGE>(fb, 120, 120, 73);
+    });
+    runCase("gauge/drawMiniGauge-static", 500, fb, [fb] {
+        drawMiniGauge<SMALL_GAUGE>(fb, 72, 85, 58, "FlightRdr", "58");
+    });
+    runCase("gauge/drawGauge-static", 500, fb, [fb] {
+        drawGauge<CPU_GAUGE>(fb, 120, 120, 73, "CPU", "%");
+    });
+
+    // --- Several panels in one transfer ---
+    runBroadcast();
+
+    // --- Full screens: draw into the framebuffer + flush to the panel ---
+    struct { const char* name; DrawFn draw; int panel; } screens[] = {
+        {"screen/unraid",   drawUnraid,   SCREEN_UNRAID},
+        {"screen/m900",     drawM900,     SCREEN_M900},
+        {"screen/pihealth", drawPiHealth, SCREEN_PIHEALTH},
+        {"screen/services", drawServices, SCREEN_SERVICES},
+        {"screen/custom",   drawCustom,   SCREEN_CUSTOM},
+        {"screen/switches", drawSwitches, SCREEN_SWITCH},
+        {"screen/radar",    drawRadar,    SCREEN_RADAR},
+        {"screen/pihole",   drawPihole,   SCREEN_DNS},
+        {"screen/clock",    drawClock,    SCREEN_CLOCK},
+    };
+    for (auto& s : screens) {
+        LGFX_Sprite* f = frames[s.panel];
+        runCase(s.name, 200, f, [&s] {
+            s.draw(s.panel);
+            flushFrame(s.panel);
+        });
+    }
+
+    // --- Services list: scroll steps and single-row updates ---
+    runServicesScroll();
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+"""
+Compare two native bench runs (JSON Lines from the bench program).
+
+Usage: python3 bench/compare.py baseline.txt current.txt [--time-tolerance 10]
+
+Any increase in a bus/pixel or table-size counter is a regression (the
+mock is deterministic). Wall time only counts past the tolerance
+(percent); rows without it (gauge/tables) are compared on size only.
+Exits 1 if anything regressed.
+"""
+
+import json
+import sys
+
+COUNTERS = ["fb_pixels", "spi_bytes", "spi_pixels", "addr_windows", "transactions",
+            "peak_bytes", "flash_bytes_small", "flash_bytes_mid", "flash_bytes_large"]
+
+
+def load(path):
+    cases = {}
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if line.startswith("{"):
+                row = json.loads(line)
+                cases[row["case"]] = row
+    return cases
+
+
+def main():
+    args = sys.argv[1:]
+    tolerance = 10.0
+    if "--time-tolerance" in args:
+        i = args.index("--time-tolerance")
+        tolerance = float(args[i + 1])
+        del args[i:i + 2]
+    if len(args) != 2:
+        print(__doc__)
+        sys.exit(2)
+
+    base, cur = load(args[0]), load(args[1])
+    regressed = False
+
+    for name, row in cur.items():
+        old = base.get(name)
+        if old is None:
+            print(f"  new   {name}")
+            continue
+        notes = []
+        for key in COUNTERS:
+            a, b = old.get(key, 0), row.get(key, 0)
+            if b > a:
+                notes.append(f"{key} {a:.0f} -> {b:.0f}")
+                regressed = True
+            elif b < a:
+                notes.append(f"{key} {a:.0f} -> {b:.0f} (better)")
+        a, b = old.get("ns_per_iter", 0), row.get("ns_per_iter", 0)
+        if a > 0:
+            pct = (b - a) * 100.0 / a
+            if pct > tolerance:
+                notes.append(f"time +{pct:.1f}%")
+                regressed = True
+            elif pct < -tolerance:
+                notes.append(f"time {pct:.1f}% (better)")
+        status = "WORSE" if any("better" not in n for n in notes) else "ok"
+        print(f"  {status:5} {name}" + (": " + ", ".join(notes) if notes else ""))
+
+    sys.exit(1 if regressed else 0)
+
+
+if __name__ == "__main__":
+    main()
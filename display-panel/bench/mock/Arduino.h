@@ -0,0 +1,114 @@
+#pragma once
+
+// ============================================
+// Host stand-in for the Arduino core (native bench only)
+// ============================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <string>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+// The bench is single-threaded; call it the loop core
+inline int xPortGetCoreID() { return 1; }
+
+// GPIO: levels are remembered so the mock panels can tell whose
+// CS is asserted (every pin starts high)
+#define LOW     0
+#define HIGH    1
+#define OUTPUT  0x03
+inline void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t pin, uint8_t level);
+int  digitalRead(uint8_t pin);
+
+// Fixed wall clock so the clock screen always has something to draw
+bool getLocalTime(struct tm* info, uint32_t ms = 5000);
+
+size_t strlcpy(char* dst, const char* src, size_t size);
+
+// ============================================
+// String
+// ============================================
+class String {
+public:
+    String() {}
+    String(const char* s) { if (s) _s = s; }
+    String(const std::string& s) : _s(s) {}
+
+    String& operator=(const char* s) { _s = s ? s : ""; return *this; }
+    String& operator+=(const char* s) { if (s) _s += s; return *this; }
+    String& operator+=(char c) { _s += c; return *this; }
+    bool concat(const char* s) { *this += s; return true; }
+    bool concat(char c) { *this += c; return true; }
+
+    bool operator==(const char* s) const { return _s == (s ? s : ""); }
+    bool operator!=(const char* s) const { return !(*this == s); }
+
+    const char* c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.size(); }
+
+private:
+    std::string _s;
+};
+
+// ============================================
+// Print / Stream
+// ============================================
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buf, size_t len) {
+        size_t n = 0;
+        while (len--) n += write(*buf++);
+        return n;
+    }
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t println(const char* s = "") { return print(s) + print("\n"); }
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+
+    virtual size_t readBytes(char* buf, size_t len) {
+        size_t n = 0;
+        while (n < len) {
+            int c = read();
+            if (c < 0) break;
+            buf[n++] = (char)c;
+        }
+        return n;
+    }
+    size_t readBytes(uint8_t* buf, size_t len) { return readBytes((char*)buf, len); }
+    void setTimeout(unsigned long) {}
+};
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long) {}
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    size_t write(uint8_t c) override { return fputc(c, stderr) == EOF ? 0 : 1; }
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,70 @@
+#pragma once
+
+// ============================================
+// Host stand-in for HTTPClient (native bench only)
+// Requests are answered from fixtures registered with
+// mockHttpRoute(); anything else fails to connect. POST is
+// answered like GET; the payload is ignored.
+// ============================================
+
+#include "Arduino.h"
+#include <string>
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+
+// Serve body (with status code) for any URL starting with prefix.
+// A pre-compressed body is sent with its Content-Encoding.
+void mockHttpRoute(const char* prefix, const std::string& body, int code = 200,
+                   const char* encoding = nullptr);
+void mockHttpClearRoutes();
+
+// Requests answered so far by the route registered with prefix
+int mockHttpHits(const char* prefix);
+
+// Response body read the way a WiFiClient would be: available()
+// reports at most one TCP segment at a time
+class MockBodyStream : public Stream {
+public:
+    void reset(const std::string* body) { _body = body; _pos = 0; }
+
+    int available() override {
+        return (int)std::min<size_t>(_body->size() - _pos, 1460);
+    }
+    int read() override { return _pos < _body->size() ? (uint8_t)(*_body)[_pos++] : -1; }
+    int peek() override { return _pos < _body->size() ? (uint8_t)(*_body)[_pos] : -1; }
+    size_t readBytes(char* buf, size_t len) override {
+        size_t n = std::min(len, _body->size() - _pos);
+        memcpy(buf, _body->data() + _pos, n);
+        _pos += n;
+        return n;
+    }
+    size_t write(uint8_t) override { return 0; }
+
+private:
+    const std::string* _body = nullptr;
+    size_t _pos = 0;
+};
+
+class HTTPClient {
+public:
+    bool begin(const char* url) { _url = url; return true; }
+    bool begin(const String& url) { return begin(url.c_str()); }
+    void setTimeout(uint16_t) {}
+    void useHTTP10(bool) {}
+    void addHeader(const String&, const String&) {}
+    void setAuthorization(const char*, const char*) {}
+    void collectHeaders(const char* keys[], size_t count) { (void)keys; (void)count; }
+    String header(const char* name);
+    int  GET();
+    int  POST(const String&) { return GET(); }
+    String getString() { return String(_body); }
+    Stream& getStream() { return _stream; }
+    int  getSize() { return (int)_body.size(); }
+    void end() {}
+
+private:
+    std::string _url;
+    std::string _body;
+    std::string _encoding;
+    MockBodyStream _stream;
+};
@@ -0,0 +1,288 @@
+#include "LovyanGFX.hpp"
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+namespace lgfx {
+
+BusCounters busCounters = {};
+
+// ============================================
+// Primitives
+// ============================================
+void LovyanGFX::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t c) {
+    if (w < 0) { x += w + 1; w = -w; }
+    if (h < 0) { y += h + 1; h = -h; }
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > _width)  w = _width - x;
+    if (y + h > _height) h = _height - y;
+    if (w <= 0 || h <= 0) return;
+    pixelsWritten += (uint64_t)w * h;
+    writeRect(x, y, w, h, c);
+}
+
+void LovyanGFX::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t c) {
+    drawFastHLine(x, y, w, c);
+    drawFastHLine(x, y + h - 1, w, c);
+    drawFastVLine(x, y + 1, h - 2, c);
+    drawFastVLine(x + w - 1, y + 1, h - 2, c);
+}
+
+void LovyanGFX::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t c) {
+    int32_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int32_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int32_t err = dx + dy;
+    for (;;) {
+        drawPixel(x0, y0, c);
+        if (x0 == x1 && y0 == y1) break;
+        int32_t e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+}
+
+void LovyanGFX::drawCircle(int32_t cx, int32_t cy, int32_t r, uint32_t c) {
+    int32_t x = r, y = 0, err = 1 - r;
+    while (x >= y) {
+        drawPixel(cx + x, cy + y, c); drawPixel(cx - x, cy + y, c);
+        drawPixel(cx + x, cy - y, c); drawPixel(cx - x, cy - y, c);
+        drawPixel(cx + y, cy + x, c); drawPixel(cx - y, cy + x, c);
+        drawPixel(cx + y, cy - x, c); drawPixel(cx - y, cy - x, c);
+        y++;
+        if (err < 0) {
+            err += 2 * y + 1;
+        } else {
+            x--;
+            err += 2 * (y - x) + 1;
+        }
+    }
+}
+
+void LovyanGFX::fillCircle(int32_t cx, int32_t cy, int32_t r, uint32_t c) {
+    for (int32_t dy = -r; dy <= r; dy++) {
+        int32_t dx = 0;
+        while ((dx + 1) * (dx + 1) + dy * dy <= r * r) dx++;
+        drawFastHLine(cx - dx, cy + dy, 2 * dx + 1, c);
+    }
+}
+
+int32_t LovyanGFX::textWidth(const char* s) const {
+    return (int32_t)(strlen(s) * 6 * _textSize);
+}
+
+int32_t LovyanGFX::fontHeight() const {
+    return (int32_t)(8 * _textSize);
+}
+
+int32_t LovyanGFX::drawString(const char* s, int32_t x, int32_t y) {
+    int32_t w = textWidth(s);
+    int32_t h = fontHeight();
+    int col = _datum % 3, row = _datum / 3;
+    x -= (w * col) / 2;
+    y -= (h * row) / 2;
+    fillRect(x, y, w, h, _textBgSet ? _textBg : _textFg);
+    return w;
+}
+
+// ============================================
+// Sprite
+// ============================================
+void* LGFX_Sprite::createSprite(int32_t w, int32_t h) {
+    deleteSprite();
+    _buf = (uint8_t*)calloc(w * h * _depth / 8, 1);
+    if (_buf) {
+        _width = w;
+        _height = h;
+    }
+    return _buf;
+}
+
+void LGFX_Sprite::deleteSprite() {
+    free(_buf);
+    _buf = nullptr;
+    _width = _height = 0;
+}
+
+uint32_t LGFX_Sprite::readPixelValue(int32_t x, int32_t y) const {
+    int32_t i = y * _width + x;
+    switch (_depth) {
+    case 16: return ((const uint16_t*)_buf)[i];
+    case 8:  return _buf[i];
+    default: return (i & 1) ? (_buf[i >> 1] & 0x0F) : (_buf[i >> 1] >> 4);
+    }
+}
+
+void LGFX_Sprite::writeRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t c) {
+    for (int32_t j = 0; j < h; j++) {
+        int32_t row = (y + j) * _width;
+        for (int32_t i = x; i < x + w; i++) {
+            int32_t p = row + i;
+            if (_depth == 16) {
+                ((uint16_t*)_buf)[p] = (uint16_t)c;
+            } else if (_depth == 8 && !_palette) {
+                _buf[p] = ((c >> 8) & 0xE0) | ((c >> 6) & 0x1C) | ((c >> 3) & 0x03);
+            } else if (_depth == 8) {
+                _buf[p] = (uint8_t)c;
+            } else if (p & 1) {
+                _buf[p >> 1] = (_buf[p >> 1] & 0xF0) | (c & 0x0F);
+            } else {
+                _buf[p >> 1] = (_buf[p >> 1] & 0x0F) | ((c & 0x0F) << 4);
+            }
+        }
+    }
+}
+
+// ============================================
+// Device
+// GC9A01 protocol: CASET/RASET take 4 data bytes each, RAMWR
+// then streams 2 bytes per pixel inside the window. VSCRDEF (6
+// bytes: top, area, bottom) and VSCRSADD (2 bytes: first GRAM row
+// of the area) set the vertical scroll.
+// ============================================
+static std::vector<LGFX_Device*> panels;    // everything on the bus
+
+// Panels listening right now (CS low)
+template <typename F>
+static void forSelected(F&& fn) {
+    for (LGFX_Device* p : panels) fn(p);
+}
+
+LGFX_Device::~LGFX_Device() {
+    panels.erase(std::remove(panels.begin(), panels.end(), this), panels.end());
+    delete[] _gram;
+}
+
+bool LGFX_Device::init() {
+    auto cfg = _panel->config();
+    _width = cfg.panel_width;
+    _height = cfg.panel_height;
+    _cs = cfg.pin_cs;
+    digitalWrite(_cs, HIGH);
+    delete[] _gram;
+    _gram = new uint16_t[_width * _height]();
+    _x0 = _y0 = 0;
+    _x1 = _width - 1;
+    _y1 = _height - 1;
+    _xs = _xe = _ys = _ye = -1;
+    _tfa = _vsa = _vsp = 0;
+    if (std::find(panels.begin(), panels.end(), this) == panels.end()) panels.push_back(this);
+    return true;
+}
+
+void LGFX_Device::startWrite() {
+    if (_writeDepth++ == 0) {
+        busCounters.transactions++;
+        digitalWrite(_cs, LOW);
+    }
+}
+
+void LGFX_Device::endWrite() {
+    if (_writeDepth > 0 && --_writeDepth == 0) digitalWrite(_cs, HIGH);
+}
+
+void LGFX_Device::writeCommand(uint8_t cmd) {
+    busCounters.commands++;
+    busCounters.bytes++;
+    forSelected([&](LGFX_Device* p) {
+        if (digitalRead(p->_cs) == LOW) { p->_cmd = cmd; p->_argc = 0; }
+    });
+}
+
+void LGFX_Device::writeData(uint8_t data) {
+    busCounters.bytes++;
+    forSelected([&](LGFX_Device* p) {
+        if (digitalRead(p->_cs) != LOW || p->_argc >= 6) return;
+        uint8_t* a = p->_args;
+        a[p->_argc++] = data;
+        if (p->_cmd == 0x33 && p->_argc == 6) {
+            p->_tfa = a[0] << 8 | a[1];
+            p->_vsa = a[2] << 8 | a[3];
+        } else if (p->_cmd == 0x37 && p->_argc == 2) {
+            p->_vsp = a[0] << 8 | a[1];
+        }
+    });
+}
+
+// Physical row y of the scroll area shows GRAM row _vsp for its
+// first row and the ones after it, wrapping within the area
+uint16_t LGFX_Device::glassPixel(int32_t x, int32_t y) const {
+    if (_vsa > 0 && y >= _tfa && y < _tfa + _vsa) {
+        int32_t off = (_vsp - _tfa) + (y - _tfa);
+        y = _tfa + ((off % _vsa) + _vsa) % _vsa;
+    }
+    return _gram[y * _width + x];
+}
+
+void LGFX_Device::setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h) {
+    startWrite();
+    int32_t xe = x + w - 1, ye = y + h - 1;
+    if (x != _xs || xe != _xe) {
+        writeCommand(0x2A); for (int i = 0; i < 4; i++) writeData(0);
+        forSelected([&](LGFX_Device* p) {
+            if (digitalRead(p->_cs) == LOW) { p->_x0 = x; p->_x1 = xe; }
+        });
+        _xs = x; _xe = xe;
+    }
+    if (y != _ys || ye != _ye) {
+        writeCommand(0x2B); for (int i = 0; i < 4; i++) writeData(0);
+        forSelected([&](LGFX_Device* p) {
+            if (digitalRead(p->_cs) == LOW) { p->_y0 = y; p->_y1 = ye; }
+        });
+        _ys = y; _ye = ye;
+    }
+    writeCommand(0x2C);
+    forSelected([](LGFX_Device* p) {
+        if (digitalRead(p->_cs) == LOW) { p->_cx = p->_x0; p->_cy = p->_y0; }
+    });
+    busCounters.addrWindows++;
+    endWrite();
+}
+
+void LGFX_Device::gramWrite(uint16_t c) {
+    if (_cx >= 0 && _cx < _width && _cy >= 0 && _cy < _height) {
+        _gram[_cy * _width + _cx] = c;
+    }
+    if (++_cx > _x1) {
+        _cx = _x0;
+        if (++_cy > _y1) _cy = _y0;
+    }
+}
+
+void LGFX_Device::gramFill(uint16_t c, uint64_t count) {
+    while (count--) gramWrite(c);
+}
+
+void LGFX_Device::pushPixels(const uint16_t* data, uint32_t len, bool swap) {
+    startWrite();
+    forSelected([&](LGFX_Device* p) {
+        if (digitalRead(p->_cs) != LOW) return;
+        for (uint32_t i = 0; i < len; i++) {
+            uint16_t c = data[i];
+            p->gramWrite(swap ? c : (uint16_t)((c >> 8) | (c << 8)));
+        }
+    });
+    busCounters.bytes += len * 2;
+    busCounters.pixels += len;
+    endWrite();
+}
+
+void LGFX_Device::pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const swap565_t* data) {
+    startWrite();
+    setAddrWindow(x, y, w, h);
+    pushPixels((const uint16_t*)data, w * h);
+    endWrite();
+}
+
+void LGFX_Device::writeRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t c) {
+    startWrite();
+    setAddrWindow(x, y, w, h);
+    forSelected([&](LGFX_Device* p) {
+        if (digitalRead(p->_cs) == LOW) p->gramFill((uint16_t)c, (uint64_t)w * h);
+    });
+    busCounters.bytes += (uint64_t)w * h * 2;
+    busCounters.pixels += (uint64_t)w * h;
+    endWrite();
+}
+
+} // namespace lgfx
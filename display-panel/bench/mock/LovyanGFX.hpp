@@ -0,0 +1,242 @@
+#pragma once
+
+// ============================================
+// Host stand-in for LovyanGFX (native bench only)
+// Sprites rasterise into a real pixel buffer and count pixels
+// written; devices model a GC9A01 on the shared SPI bus and count
+// every command, address window, byte and transaction they'd send.
+// Only the API surface the firmware uses is provided.
+// ============================================
+
+// The real library pulls in the Arduino core on ESP32; so do we
+#include "Arduino.h"
+
+#define SPI2_HOST 1
+
+static constexpr int TFT_BLACK     = 0x0000;
+static constexpr int TFT_NAVY      = 0x000F;
+static constexpr int TFT_DARKGREEN = 0x03E0;
+static constexpr int TFT_MAROON    = 0x7800;
+static constexpr int TFT_LIGHTGREY = 0xD69A;
+static constexpr int TFT_DARKGREY  = 0x7BEF;
+static constexpr int TFT_BLUE      = 0x001F;
+static constexpr int TFT_GREEN     = 0x07E0;
+static constexpr int TFT_CYAN      = 0x07FF;
+static constexpr int TFT_RED       = 0xF800;
+static constexpr int TFT_MAGENTA   = 0xF81F;
+static constexpr int TFT_YELLOW    = 0xFFE0;
+static constexpr int TFT_WHITE     = 0xFFFF;
+static constexpr int TFT_ORANGE    = 0xFDA0;
+
+enum textdatum_t {
+    top_left, top_center, top_right,
+    middle_left, middle_center, middle_right,
+    bottom_left, bottom_center, bottom_right,
+};
+
+namespace lgfx {
+
+// ============================================
+// Shared-bus accounting (all panels)
+// ============================================
+struct BusCounters {
+    uint64_t transactions;  // CS assert/deassert pairs
+    uint64_t commands;      // bytes sent with DC low
+    uint64_t addrWindows;   // CASET+RASET+RAMWR sequences
+    uint64_t bytes;         // every byte clocked out
+    uint64_t pixels;        // pixels written to panel GRAM
+};
+
+extern BusCounters busCounters;
+
+struct swap565_t {
+    uint16_t raw;
+};
+
+// As LovyanGFX: a bare bit count below 8 gets a palette, 8 alone is
+// rgb332, and palette_8bit asks for 256 palette indices
+enum color_depth_t : int {
+    bit_mask     = 0x00FF,
+    has_palette  = 0x0800,
+    palette_4bit = 4 | has_palette,
+    palette_8bit = 8 | has_palette,
+    rgb332_1Byte = 8,
+    rgb565_2Byte = 16,
+};
+
+// ============================================
+// Drawing surface
+// Everything funnels into writeRect() on an already clipped rect
+// ============================================
+class LovyanGFX {
+public:
+    virtual ~LovyanGFX() {}
+
+    int32_t width() const  { return _width; }
+    int32_t height() const { return _height; }
+
+    void setRotation(int) {}
+    void setTextDatum(textdatum_t d) { _datum = d; }
+    void setTextSize(float s) { _textSize = s; }
+    void setTextColor(uint32_t fg) { _textFg = fg; _textBgSet = false; }
+    void setTextColor(uint32_t fg, uint32_t bg) { _textFg = fg; _textBg = bg; _textBgSet = true; }
+
+    void fillScreen(uint32_t c) { fillRect(0, 0, _width, _height, c); }
+    void drawPixel(int32_t x, int32_t y, uint32_t c) { fillRect(x, y, 1, 1, c); }
+    void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t c) { fillRect(x, y, w, 1, c); }
+    void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t c) { fillRect(x, y, 1, h, c); }
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t c);
+    void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t c);
+    void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t c);
+    void drawCircle(int32_t cx, int32_t cy, int32_t r, uint32_t c);
+    void fillCircle(int32_t cx, int32_t cy, int32_t r, uint32_t c);
+
+    // Glyphs are modelled as their 6x8 cell (scaled), filled with
+    // the background colour when one is set
+    int32_t drawString(const char* s, int32_t x, int32_t y);
+    int32_t textWidth(const char* s) const;
+    int32_t fontHeight() const;
+
+    uint64_t pixelsWritten = 0;
+
+protected:
+    virtual void writeRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t c) = 0;
+
+    int32_t     _width = 0;
+    int32_t     _height = 0;
+    textdatum_t _datum = top_left;
+    float       _textSize = 1;
+    uint32_t    _textFg = TFT_WHITE;
+    uint32_t    _textBg = TFT_BLACK;
+    bool        _textBgSet = false;
+};
+
+// ============================================
+// Off-screen framebuffer
+// 16bpp stores RGB565; palette sprites store indices, packed like
+// LovyanGFX (4bpp: first pixel in the high nibble). An 8bpp sprite
+// without a palette stores rgb332, converted from the colour as
+// RGB565 the way the library treats an int colour.
+// ============================================
+class LGFX_Sprite : public LovyanGFX {
+public:
+    LGFX_Sprite(LovyanGFX* parent = nullptr) { (void)parent; }
+    ~LGFX_Sprite() override { deleteSprite(); }
+
+    void setPsram(bool) {}
+    void setColorDepth(int depth) {
+        _depth = depth & bit_mask;
+        _palette = (depth & has_palette) || _depth < 8;
+    }
+    int  getColorDepth() const { return _depth; }
+    bool hasPalette() const { return _palette; }
+
+    void* createSprite(int32_t w, int32_t h);
+    void  deleteSprite();
+
+    void*    getBuffer() const { return _buf; }
+    uint32_t bufferLength() const { return _width * _height * _depth / 8; }
+    uint32_t readPixelValue(int32_t x, int32_t y) const;
+
+protected:
+    void writeRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t c) override;
+
+private:
+    uint8_t* _buf = nullptr;
+    int      _depth = 16;
+    bool     _palette = false;
+};
+
+// ============================================
+// Panel / bus configuration (accepted and ignored)
+// ============================================
+class Bus_SPI {
+public:
+    struct config_t {
+        int spi_host, spi_mode;
+        uint32_t freq_write, freq_read;
+        int pin_mosi, pin_miso, pin_sclk, pin_dc;
+    };
+    config_t config() const { return _cfg; }
+    void config(const config_t& cfg) { _cfg = cfg; }
+
+private:
+    config_t _cfg = {};
+};
+
+class Panel_GC9A01 {
+public:
+    struct config_t {
+        int pin_cs, pin_rst;
+        int panel_width, panel_height;
+        int offset_x, offset_y;
+        bool invert;
+    };
+    config_t config() const { return _cfg; }
+    void config(const config_t& cfg) { _cfg = cfg; }
+    void setBus(Bus_SPI* bus) { _bus = bus; }
+
+private:
+    config_t _cfg = {};
+    Bus_SPI* _bus = nullptr;
+};
+
+// ============================================
+// Physical panel on the shared bus
+// Each device is the driver for one GC9A01 plus a model of the
+// panel itself (GRAM, address window, write cursor), so tests can
+// check what actually reached the glass. Commands and pixels land
+// on every panel whose CS is low at the time, so holding several
+// CS lines reaches them all with one transfer. Like LovyanGFX, the
+// driver skips CASET/RASET when the columns or rows match the last
+// ones it sent itself. VSCRDEF/VSCRSADD are followed, so
+// glassPixel() shows GRAM through the panel's vertical scroll.
+// ============================================
+class LGFX_Device : public LovyanGFX {
+public:
+    ~LGFX_Device() override;
+
+    void setPanel(Panel_GC9A01* panel) { _panel = panel; }
+    bool init();
+    void setBrightness(uint8_t) {}
+
+    void startWrite();
+    void endWrite();
+    void writeCommand(uint8_t cmd);
+    void writeData(uint8_t data);
+    void setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h);
+    void pushPixels(const uint16_t* data, uint32_t len, bool swap = true);
+    void pushPixelsDMA(const uint16_t* data, uint32_t len, bool swap = true) { pushPixels(data, len, swap); }
+    void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const swap565_t* data);
+    void waitDMA() {}
+
+    uint16_t gramPixel(int32_t x, int32_t y) const { return _gram[y * _width + x]; }
+    uint16_t glassPixel(int32_t x, int32_t y) const;
+
+protected:
+    void writeRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t c) override;
+
+private:
+    void gramWrite(uint16_t c);
+    void gramFill(uint16_t c, uint64_t count);
+
+    Panel_GC9A01* _panel = nullptr;
+    int  _cs = -1;
+    int  _writeDepth = 0;
+
+    // Driver side: the window it last sent (-1 = none)
+    int32_t _xs = -1, _xe = -1, _ys = -1, _ye = -1;
+
+    // Panel side
+    uint16_t* _gram = nullptr;
+    int32_t _x0 = 0, _x1 = 0, _y0 = 0, _y1 = 0;    // address window, inclusive
+    int32_t _cx = 0, _cy = 0;                      // GRAM write cursor
+    uint8_t _cmd = 0;                              // last command and its data so far
+    uint8_t _args[6] = {};
+    int     _argc = 0;
+    int32_t _tfa = 0, _vsa = 0, _vsp = 0;          // vertical scroll, _vsa 0 = none
+};
+
+} // namespace lgfx
+
+using lgfx::LGFX_Sprite;
@@ -0,0 +1,14 @@
+#pragma once
+
+// ============================================
+// Host stand-in for the ESP32 WiFi library (native bench only)
+// ============================================
+
+#include "Arduino.h"
+
+class WiFiClass {
+public:
+    int8_t RSSI() { return -58; }
+};
+
+extern WiFiClass WiFi;
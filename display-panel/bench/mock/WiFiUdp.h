@@ -0,0 +1,38 @@
+#pragma once
+
+// ============================================
+// Host stand-in for WiFiUDP (native bench only)
+// Datagrams sent to a host:port registered with mockUdpRoute() are
+// handed to its handler, and whatever it returns is queued as the
+// reply; anything else is silently dropped, like a dead host.
+// ============================================
+
+#include "Arduino.h"
+#include <deque>
+#include <functional>
+#include <string>
+
+typedef std::function<std::string(const std::string& request)> MockUdpHandler;
+
+void mockUdpRoute(const char* host, uint16_t port, MockUdpHandler handler);
+void mockUdpClearRoutes();
+
+class WiFiUDP {
+public:
+    uint8_t begin(uint16_t) { return 1; }
+    void stop() {}
+
+    int beginPacket(const char* host, uint16_t port);
+    size_t write(const uint8_t* buf, size_t len) { _out.append((const char*)buf, len); return len; }
+    int endPacket();
+
+    int parsePacket();
+    int read(uint8_t* buf, size_t len);
+
+private:
+    std::string _host;
+    uint16_t _port = 0;
+    std::string _out;
+    std::deque<std::string> _replies;
+    std::string _in;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+// ============================================
+// Host stand-in for ESP-IDF flash partitions (native bench only)
+// A partition made with mockPartition() is RAM behaving like NOR
+// flash: erase sets whole 4 KB sectors to 0xFF, a write can only
+// clear bits. Erases are counted per sector to check wear, and a
+// write can be cut short to play a power cut.
+// ============================================
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+typedef int esp_err_t;
+#define ESP_OK                  0
+#define ESP_FAIL                -1
+#define ESP_ERR_INVALID_ARG     0x102
+
+typedef enum { ESP_PARTITION_TYPE_APP = 0, ESP_PARTITION_TYPE_DATA = 1 } esp_partition_type_t;
+typedef int esp_partition_subtype_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+} esp_partition_t;
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype, const char* label);
+esp_err_t esp_partition_read(const esp_partition_t* p, size_t offset, void* dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t* p, size_t offset, const void* src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t* p, size_t offset, size_t size);
+
+// Create (or wipe back to erased) a data partition
+void mockPartition(const char* label, esp_partition_subtype_t subtype, uint32_t size);
+
+// Erases so far of each sector of label's partition
+const std::vector<uint32_t>& mockPartitionErases(const char* label);
+
+// Power cut: the next write to label's partition stops after keep bytes
+void mockPartitionTearNextWrite(const char* label, size_t keep);
@@ -0,0 +1,11 @@
+#pragma once
+
+// ============================================
+// Host stand-in for the ROM CRC routines (native bench only)
+// ============================================
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-32 (IEEE), continuing from crc; 0 to start
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len);
@@ -0,0 +1,276 @@
+#include "Arduino.h"
+#include "HTTPClient.h"
+#include "WiFi.h"
+#include "WiFiUdp.h"
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+#include <stdarg.h>
+#include <strings.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+HardwareSerial Serial;
+WiFiClass WiFi;
+
+// ============================================
+// Time
+// ============================================
+static const auto bootTime = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - bootTime).count();
+}
+
+unsigned long micros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - bootTime).count();
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// ============================================
+// GPIO
+// ============================================
+static uint8_t pinLevels[64];
+static bool    pinsReady = false;
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+    if (!pinsReady) {
+        memset(pinLevels, HIGH, sizeof(pinLevels));
+        pinsReady = true;
+    }
+    if (pin < sizeof(pinLevels)) pinLevels[pin] = level;
+}
+
+int digitalRead(uint8_t pin) {
+    if (!pinsReady || pin >= sizeof(pinLevels)) return HIGH;
+    return pinLevels[pin];
+}
+
+bool getLocalTime(struct tm* info, uint32_t) {
+    memset(info, 0, sizeof(*info));
+    info->tm_year = 126;    // Mon Oct 19 2026, 10:42:00
+    info->tm_mon  = 9;
+    info->tm_mday = 19;
+    info->tm_wday = 1;
+    info->tm_hour = 10;
+    info->tm_min  = 42;
+    return true;
+}
+
+size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+
+size_t Print::printf(const char* fmt, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (n <= 0) return 0;
+    return write((const uint8_t*)buf, strlen(buf));
+}
+
+// ============================================
+// HTTP fixtures
+// ============================================
+struct Route {
+    std::string prefix;
+    std::string body;
+    int code;
+    std::string encoding;
+    int hits;
+};
+
+static std::vector<Route> routes;
+
+void mockHttpRoute(const char* prefix, const std::string& body, int code, const char* encoding) {
+    routes.push_back({prefix, body, code, encoding ? encoding : "", 0});
+}
+
+int mockHttpHits(const char* prefix) {
+    int n = 0;
+    for (const Route& r : routes) {
+        if (r.prefix == prefix) n += r.hits;
+    }
+    return n;
+}
+
+void mockHttpClearRoutes() {
+    routes.clear();
+}
+
+int HTTPClient::GET() {
+    for (Route& r : routes) {
+        if (_url.compare(0, r.prefix.size(), r.prefix) == 0) {
+            r.hits++;
+            _body = r.body;
+            _encoding = r.encoding;
+            _stream.reset(&_body);
+            return r.code;
+        }
+    }
+    _body.clear();
+    _encoding.clear();
+    _stream.reset(&_body);
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+}
+
+String HTTPClient::header(const char* name) {
+    if (strcasecmp(name, "Content-Encoding") == 0) return String(_encoding);
+    return String();
+}
+
+// ============================================
+// UDP routes
+// ============================================
+struct UdpRoute {
+    std::string host;
+    uint16_t port;
+    MockUdpHandler handler;
+};
+
+static std::vector<UdpRoute> udpRoutes;
+
+void mockUdpRoute(const char* host, uint16_t port, MockUdpHandler handler) {
+    udpRoutes.push_back({host, port, handler});
+}
+
+void mockUdpClearRoutes() {
+    udpRoutes.clear();
+}
+
+int WiFiUDP::beginPacket(const char* host, uint16_t port) {
+    _host = host;
+    _port = port;
+    _out.clear();
+    return 1;
+}
+
+int WiFiUDP::endPacket() {
+    for (const UdpRoute& r : udpRoutes) {
+        if (r.host == _host && r.port == _port) {
+            std::string reply = r.handler(_out);
+            if (!reply.empty()) _replies.push_back(reply);
+        }
+    }
+    _out.clear();
+    return 1;
+}
+
+int WiFiUDP::parsePacket() {
+    if (_replies.empty()) return 0;
+    _in = _replies.front();
+    _replies.pop_front();
+    return (int)_in.size();
+}
+
+int WiFiUDP::read(uint8_t* buf, size_t len) {
+    size_t n = std::min(len, _in.size());
+    memcpy(buf, _in.data(), n);
+    _in.clear();
+    return (int)n;
+}
+
+// ============================================
+// Flash partitions
+// ============================================
+struct MockPartition {
+    esp_partition_t info;
+    std::vector<uint8_t> data;
+    std::vector<uint32_t> erases;
+    size_t tearAt = SIZE_MAX;       // next write stops after this many bytes
+};
+
+static std::vector<MockPartition*> partitions;
+
+static MockPartition* findPartition(const char* label) {
+    for (MockPartition* p : partitions) {
+        if (strcmp(p->info.label, label) == 0) return p;
+    }
+    return nullptr;
+}
+
+static MockPartition* findPartition(const esp_partition_t* info) {
+    for (MockPartition* p : partitions) {
+        if (&p->info == info) return p;
+    }
+    return nullptr;
+}
+
+void mockPartition(const char* label, esp_partition_subtype_t subtype, uint32_t size) {
+    MockPartition* p = findPartition(label);
+    if (!p) {
+        p = new MockPartition();
+        partitions.push_back(p);
+    }
+    p->info.type = ESP_PARTITION_TYPE_DATA;
+    p->info.subtype = subtype;
+    p->info.size = size;
+    strlcpy(p->info.label, label, sizeof(p->info.label));
+    p->data.assign(size, 0xFF);
+    p->tearAt = SIZE_MAX;
+    p->erases.assign(size / 0x1000, 0);
+}
+
+const std::vector<uint32_t>& mockPartitionErases(const char* label) {
+    return findPartition(label)->erases;
+}
+
+void mockPartitionTearNextWrite(const char* label, size_t keep) {
+    findPartition(label)->tearAt = keep;
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype, const char* label) {
+    MockPartition* p = findPartition(label);
+    if (!p || p->info.type != type || p->info.subtype != subtype) return nullptr;
+    return &p->info;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* info, size_t offset, void* dst, size_t size) {
+    MockPartition* p = findPartition(info);
+    if (!p || offset + size > p->data.size()) return ESP_ERR_INVALID_ARG;
+    memcpy(dst, &p->data[offset], size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* info, size_t offset, const void* src, size_t size) {
+    MockPartition* p = findPartition(info);
+    if (!p || offset + size > p->data.size()) return ESP_ERR_INVALID_ARG;
+    const uint8_t* s = (const uint8_t*)src;
+    size_t n = std::min(size, p->tearAt);
+    p->tearAt = SIZE_MAX;
+    for (size_t i = 0; i < n; i++) p->data[offset + i] &= s[i];
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* info, size_t offset, size_t size) {
+    MockPartition* p = findPartition(info);
+    if (!p || offset % 0x1000 || size % 0x1000 || offset + size > p->data.size()) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(&p->data[offset], 0xFF, size);
+    for (size_t s = offset / 0x1000; s < (offset + size) / 0x1000; s++) p->erases[s]++;
+    return ESP_OK;
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *buf++;
+        for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+    }
+    return ~crc;
+}
@@ -0,0 +1,49 @@
+#include "reference.h"
+#include <ArduinoJson.h>
+
+bool referenceUnraid(Stream& in, UnraidStats& st) {
+    JsonDocument doc;
+    if (deserializeJson(doc, in)) return false;
+
+    JsonArray drives = doc["drives"];
+    st.driveCount = min((int)drives.size(), STATS_MAX_DRIVES);
+    for (int i = 0; i < st.driveCount; i++) {
+        st.drives[i].tempC = drives[i]["temp_c"] | 0.0;
+        strlcpy(st.drives[i].device, drives[i]["device"] | "??", sizeof(st.drives[i].device));
+    }
+    st.storageUsedGB = doc["storage"]["used_gb"] | 0.0;
+    st.storageTotalGB = doc["storage"]["total_gb"] | 0.0;
+    st.cpuPercent = doc["system"]["cpu_percent"] | 0.0;
+    st.memPercent = doc["system"]["mem_percent"] | 0.0;
+    st.dockerRunning = doc["docker"]["running"] | 0;
+    st.dockerTotal = doc["docker"]["total"] | 0;
+    strlcpy(st.arrayStatus, doc["array_status"] | "unknown", sizeof(st.arrayStatus));
+    return true;
+}
+
+bool referenceM900(Stream& in, M900Stats& st) {
+    JsonDocument doc;
+    if (deserializeJson(doc, in)) return false;
+
+    st.cpuPercent = doc["cpu"]["percent"] | 0.0;
+    st.cpuTempC = doc["cpu"]["temp_c"] | 0.0;
+    st.memPercent = doc["memory"]["percent"] | 0.0;
+    st.memUsedGB = doc["memory"]["used_gb"] | 0.0;
+    st.memTotalGB = doc["memory"]["total_gb"] | 0.0;
+    st.diskPercent = doc["disk"]["percent"] | 0.0;
+    st.diskUsedGB = doc["disk"]["used_gb"] | 0.0;
+    st.diskTotalGB = doc["disk"]["total_gb"] | 0.0;
+    st.bytesSent = doc["network"]["bytes_sent"] | 0.0;
+    st.bytesRecv = doc["network"]["bytes_recv"] | 0.0;
+    return true;
+}
+
+bool referencePi(Stream& in, PiStats& st) {
+    JsonDocument doc;
+    if (deserializeJson(doc, in)) return false;
+
+    st.tempC = doc["cpu"]["temp_c"] | 0.0;
+    st.cpuPercent = doc["cpu"]["percent"] | 0.0;
+    st.memPercent = doc["memory"]["percent"] | 0.0;
+    return true;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "statsschema.h"
+
+// ============================================
+// ArduinoJson decoders for the /stats replies, as the fetches did
+// it before the schema decoder: full DOM, then keyed lookups. The
+// bench runs both on every fixture and fails if they disagree.
+// ============================================
+
+bool referenceUnraid(Stream& in, UnraidStats& st);
+bool referenceM900(Stream& in, M900Stats& st);
+bool referencePi(Stream& in, PiStats& st);
@@ -0,0 +1,179 @@
+#include "snmpagent.h"
+#include <algorithm>
+
+typedef std::vector<uint32_t> Oid;
+
+static const Oid IF_X_ENTRY = {1, 3, 6, 1, 2, 1, 31, 1, 1, 1};
+static const uint32_t COL_IN = 6, COL_OUT = 10;
+
+// ============================================
+// BER, the plain way: whole strings, forward
+// ============================================
+static std::string tlv(uint8_t tag, const std::string& content) {
+    std::string out(1, (char)tag);
+    size_t n = content.size();
+    if (n < 0x80) {
+        out += (char)n;
+    } else if (n < 0x100) {
+        out += (char)0x81;
+        out += (char)n;
+    } else {
+        out += (char)0x82;
+        out += (char)(n >> 8);
+        out += (char)n;
+    }
+    return out + content;
+}
+
+static std::string integer(int64_t v) {
+    std::string s;
+    do {
+        s.insert(s.begin(), (char)(v & 0xFF));
+        v >>= 8;
+    } while (!((v == 0 && !(s[0] & 0x80)) || (v == -1 && (s[0] & 0x80))));
+    return tlv(0x02, s);
+}
+
+static std::string counter64(uint64_t v) {
+    std::string s;
+    do {
+        s.insert(s.begin(), (char)(v & 0xFF));
+        v >>= 8;
+    } while (v);
+    if (s[0] & 0x80) s.insert(s.begin(), '\0');
+    return tlv(0x46, s);
+}
+
+static std::string oid(const Oid& arcs) {
+    std::string s(1, (char)(arcs[0] * 40 + arcs[1]));
+    for (size_t i = 2; i < arcs.size(); i++) {
+        std::string sub(1, (char)(arcs[i] & 0x7F));
+        for (uint32_t a = arcs[i] >> 7; a; a >>= 7) sub.insert(sub.begin(), (char)(0x80 | (a & 0x7F)));
+        s += sub;
+    }
+    return tlv(0x06, s);
+}
+
+// Reader over a string; false on anything malformed
+struct Reader {
+    const std::string* str;
+    size_t pos, end;
+
+    uint8_t at(size_t i) const { return (uint8_t)(*str)[i]; }
+
+    bool read(uint8_t tag, Reader* inner) {
+        if (end - pos < 2 || at(pos) != tag) return false;
+        size_t n = at(pos + 1);
+        pos += 2;
+        if (n & 0x80) {
+            int k = n & 0x7F;
+            if (k == 0 || k > 2 || end - pos < (size_t)k) return false;
+            n = 0;
+            while (k--) n = (n << 8) | at(pos++);
+        }
+        if (end - pos < n) return false;
+        *inner = {str, pos, pos + n};
+        pos += n;
+        return true;
+    }
+
+    bool integer(int64_t* v) {
+        Reader c = *this;
+        if (!read(0x02, &c) || c.pos == c.end) return false;
+        *v = (int8_t)at(c.pos++);
+        while (c.pos < c.end) *v = (*v << 8) | at(c.pos++);
+        return true;
+    }
+
+    bool oid(Oid* out) {
+        Reader c = *this;
+        if (!read(0x06, &c) || c.pos == c.end) return false;
+        uint8_t first = at(c.pos++);
+        *out = {first / 40u, first % 40u};
+        uint32_t arc = 0;
+        while (c.pos < c.end) {
+            uint8_t b = at(c.pos++);
+            arc = (arc << 7) | (b & 0x7F);
+            if (!(b & 0x80)) {
+                out->push_back(arc);
+                arc = 0;
+            }
+        }
+        return true;
+    }
+};
+
+// ============================================
+// Agent
+// ============================================
+SnmpStandIn::SnmpStandIn(int interfaces, const char* community)
+    : _rows(interfaces, Row{0, 0, 0, 0}), _community(community) {
+    // Start the counters high enough to need all eight bytes
+    for (size_t i = 0; i < _rows.size(); i++) {
+        _rows[i].in = 0x00F0000000000000ull + i * 1000003;
+        _rows[i].out = 0x8000000000000000ull + i * 7919;     // nine-byte Counter64
+    }
+}
+
+void SnmpStandIn::setStep(uint32_t ifIndex, uint64_t inBytes, uint64_t outBytes) {
+    _rows[ifIndex - 1].inStep = inBytes;
+    _rows[ifIndex - 1].outStep = outBytes;
+}
+
+std::string SnmpStandIn::handle(const std::string& request) {
+    Reader in = {&request, 0, request.size()}, msg = in, comm = in, pdu = in, list = in;
+    int64_t version, id, nonRepeaters, maxRepetitions;
+    if (!in.read(0x30, &msg) || !msg.integer(&version) || version != 1) return "";
+    if (!msg.read(0x04, &comm)) return "";
+    if (request.compare(comm.pos, comm.end - comm.pos, _community) != 0) return "";
+    if (!msg.read(0xA5, &pdu) || !pdu.integer(&id) || !pdu.integer(&nonRepeaters) ||
+        !pdu.integer(&maxRepetitions) || !pdu.read(0x30, &list)) {
+        return "";
+    }
+
+    std::vector<Oid> walk;
+    while (list.pos < list.end) {
+        Reader vb = list;
+        Oid o;
+        if (!list.read(0x30, &vb) || !vb.oid(&o)) return "";
+        walk.push_back(o);
+    }
+
+    requests++;
+    for (Row& r : _rows) {
+        r.in += r.inStep;
+        r.out += r.outStep;
+    }
+
+    // Every object the agent has, in lexicographic order
+    std::vector<std::pair<Oid, uint64_t>> mib;
+    for (uint32_t col : {COL_IN, COL_OUT}) {
+        for (size_t i = 0; i < _rows.size(); i++) {
+            Oid o = IF_X_ENTRY;
+            o.push_back(col);
+            o.push_back((uint32_t)i + 1);
+            mib.push_back({o, col == COL_IN ? _rows[i].in : _rows[i].out});
+        }
+    }
+
+    // No non-repeaters from the poller: every varbind repeats
+    std::string varbinds;
+    for (int64_t r = 0; r < maxRepetitions; r++) {
+        for (Oid& at : walk) {
+            auto next = std::upper_bound(mib.begin(), mib.end(), std::make_pair(at, UINT64_MAX),
+                                         [](const std::pair<Oid, uint64_t>& a,
+                                            const std::pair<Oid, uint64_t>& b) {
+                                             return a.first < b.first;
+                                         });
+            if (next == mib.end()) {
+                varbinds += tlv(0x30, oid(at) + tlv(0x82, ""));
+            } else {
+                varbinds += tlv(0x30, oid(next->first) + counter64(next->second));
+                at = next->first;
+            }
+        }
+    }
+
+    std::string response = integer(id) + integer(0) + integer(0) + tlv(0x30, varbinds);
+    return tlv(0x30, integer(1) + tlv(0x04, _community) + tlv(0xA2, response));
+}
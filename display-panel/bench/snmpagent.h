@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// ============================================
+// Stand-in SNMPv2c agent for the switch poller
+// Serves the IF-MIB ifXTable octet counters of a simulated switch
+// and answers GetBulkRequests the way snmpd does (lexicographic
+// walk, endOfMibView past the end). Its BER code is written from
+// RFC 3416 independently of src/snmp.cpp, so each side checks the
+// other. Hook it up with mockUdpRoute(); wrong-community requests
+// get no reply.
+// ============================================
+
+class SnmpStandIn {
+public:
+    // ifIndex 1..interfaces; every request advances each counter
+    // by its per-request step
+    SnmpStandIn(int interfaces, const char* community);
+
+    void setStep(uint32_t ifIndex, uint64_t inBytes, uint64_t outBytes);
+    uint64_t inOctets(uint32_t ifIndex) const { return _rows[ifIndex - 1].in; }
+    uint64_t outOctets(uint32_t ifIndex) const { return _rows[ifIndex - 1].out; }
+
+    // Reply datagram for request ("" = none)
+    std::string handle(const std::string& request);
+
+    int requests = 0;
+
+private:
+    struct Row {
+        uint64_t in, out;
+        uint64_t inStep, outStep;
+    };
+
+    std::vector<Row> _rows;
+    std::string _community;
+};
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================
+// ADS-B decoder
+// Reads readsb's Beast binary output (port 30005): raw Mode S
+// frames, CRC-checked here. Extended squitters (DF17/18) update a
+// fixed open-addressing table keyed by ICAO address with callsign,
+// altitude, velocity and CPR-decoded position. The frame is
+// decoded where it sits in the reader's buffer and applied at
+// once, so there is no queue and nothing is allocated per
+// message. Aircraft not heard from for ADSB_AGE_MS are dropped.
+// ============================================
+
+#define ADSB_TABLE_BITS     8
+#define ADSB_MAX_AIRCRAFT   (1 << ADSB_TABLE_BITS)     // table slots
+#define ADSB_MAX_LOAD       192     // tracked at once; keeps probe chains short
+#define ADSB_AGE_MS         60000   // drop an aircraft after this long silent
+#define ADSB_CPR_PAIR_MS    10000   // even/odd frames further apart don't pair
+#define ADSB_MAX_RANGE_NM   300     // positions further from the receiver are bad decodes
+
+struct AdsbAircraft {
+    uint32_t icao;          // 24-bit address, 0 = empty slot
+    uint32_t seenMs;        // last message
+    uint32_t posMs;         // last position fix, 0 = none yet
+    float    lat, lon;
+    int32_t  altFt;         // barometric, else GNSS
+    uint16_t gsKt;
+    uint16_t track;         // degrees
+    int16_t  vrateFpm;
+    uint16_t messages;
+    char     callsign[9];   // trailing spaces trimmed
+    uint8_t  flags;         // ADSB_HAS_*
+
+    // Last raw CPR frame of each parity, for global decoding
+    uint32_t cprLat[2], cprLon[2];
+    uint32_t cprMs[2];      // 0 = none
+};
+
+enum : uint8_t {
+    ADSB_HAS_ALT      = 1 << 0,
+    ADSB_HAS_VELOCITY = 1 << 1,
+    ADSB_HAS_CALLSIGN = 1 << 2,
+};
+
+struct AdsbStats {
+    uint32_t frames;        // Beast Mode S frames read
+    uint32_t badCrc;        // failed parity
+    uint32_t applied;       // DF17/18 messages used
+    uint32_t positions;     // CPR fixes
+    uint32_t resyncs;       // framing lost and regained
+    uint32_t tableFull;     // new aircraft turned away
+};
+
+class AdsbDecoder {
+public:
+    // Receiver position: reference for the range check
+    void begin(float rxLat, float rxLon);
+
+    // Feed raw Beast bytes as they arrive, in any split
+    void feed(const uint8_t* data, size_t len, uint32_t nowMs);
+
+    // Decode one raw Mode S frame (7 or 14 bytes); false if it
+    // failed CRC or isn't an extended squitter
+    bool apply(const uint8_t* msg, int len, uint32_t nowMs);
+
+    // Drop aircraft silent for ADSB_AGE_MS
+    void expire(uint32_t nowMs);
+
+    const AdsbAircraft* find(uint32_t icao) const;
+    int count() const { return _count; }
+    const AdsbStats& stats() const { return _stats; }
+    float rxLat() const { return _rxLat; }
+    float rxLon() const { return _rxLon; }
+
+    // Every occupied slot, in table order
+    template <typename F> void forEach(F&& fn) const {
+        for (const AdsbAircraft& a : _table) {
+            if (a.icao) fn(a);
+        }
+    }
+
+private:
+    AdsbAircraft* slot(uint32_t icao, bool insert, uint32_t nowMs);
+    void remove(AdsbAircraft* a);
+    void position(AdsbAircraft& a, int odd, uint32_t latCpr, uint32_t lonCpr, uint32_t nowMs);
+    bool inRange(float lat, float lon) const;
+
+    AdsbAircraft _table[ADSB_MAX_AIRCRAFT];
+    int          _count = 0;
+    AdsbStats    _stats = {};
+    float        _rxLat = 0, _rxLon = 0;
+
+    // Beast framing
+    uint8_t _frame[7 + 14];     // timestamp, signal, message
+    uint8_t _need = 0;          // bytes in the current frame, 0 = hunting for sync
+    uint8_t _got = 0;
+    bool    _escape = false;    // last byte was 0x1A
+};
+
+// Mode S CRC-24 remainder of len bytes (0 for a good DF17 frame)
+uint32_t adsbCrc(const uint8_t* msg, int len);
+
+// ============================================
+// Radar view
+// What the screen needs, rebuilt from the table by the feed task
+// and published through a seqlock: the nearest aircraft with a
+// position, as offsets from the receiver, plus totals
+// ============================================
+#define RADAR_MAX_BLIPS     48
+
+struct RadarBlip {
+    float    eastNm, northNm;
+    int32_t  altFt;
+    uint16_t track;
+    uint16_t posAgeS;       // since the last position fix
+    uint8_t  flags;         // ADSB_HAS_*
+    char     callsign[9];
+};
+
+struct RadarView {
+    uint32_t  msgsPerSec;
+    uint16_t  aircraft;     // tracked, with or without a position
+    uint8_t   connected;
+    uint8_t   blipCount;
+    RadarBlip blips[RADAR_MAX_BLIPS];   // nearest first, within rangeNm
+};
+
+// Feed task: rebuild the view from dec and publish it
+void adsbPublish(const AdsbDecoder& dec, float rangeNm, uint32_t msgsPerSec, bool connected,
+                 uint32_t nowMs);
+
+// Any task: latest published view
+void adsbRead(RadarView& out);
@@ -0,0 +1,14 @@
+#pragma once
+
+// ============================================
+// ADS-B feed
+// Keeps a TCP connection to readsb's Beast output on the
+// flight-radar Pi and pushes every byte through the decoder
+// (adsb.h) as it arrives. It runs in its own task on core 0,
+// below the flush task, so slow fetches and redraws on the loop
+// task can never back the socket up and make readsb drop us.
+// The radar view is republished every ADSB_PUBLISH_MS.
+// ============================================
+
+// Start the feed task (call from setup(); it waits for WiFi)
+void startAdsbFeed();
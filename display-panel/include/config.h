@@ -5,6 +5,9 @@
 // on first boot, connect to "RackDisplay" AP
 // ============================================
 
+#define WIFI_CONNECT_MS     30000     // saved credentials before opening portal
+#define WIFI_PORTAL_MS      180000    // portal open before restarting
+
 // ============================================
 // Display Hardware - 6x GC9A01 1.28" Round TFT
 // All share SPI bus, individual CS pins
@@ -29,6 +32,15 @@
 #define DISPLAY_HEIGHT  240
 #define NUM_DISPLAYS    6
 
+// Framebuffers are palette-indexed (palette.h) and expanded to
+// RGB565 during the flush. 4bpp = 28 KB per panel, so all six
+// fit in internal SRAM; 8bpp (56 KB each) allows 256 colours but
+// needs ~340 KB free internal heap.
+#ifndef FRAME_DEPTH
+#define FRAME_DEPTH     4
+#endif
+#define FLUSH_LINES     16      // rows expanded per DMA chunk (x2 buffers)
+
 // ============================================
 // Data Sources - your homelab services
 // Each machine runs a small stats API script
@@ -49,18 +61,50 @@
 #define PI_SPARE1_IP        "pi-spare.local"
 #define PI_SPARE2_IP        "pi-spare.local"
 
-// Service endpoints for health checks
-#define JAZZ_STATS_URL      "http://10.1.10.XXX:8888"
-#define NHL_TRACKER_URL     "http://10.1.10.XXX:3050"
-#define CLAUDECAD_URL       "http://10.1.10.XXX:4000"
-#define PLEX_URL            "http://10.1.10.193:32400"
-#define SONARR_URL          "http://10.1.10.193:8989"
-#define RADARR_URL          "http://10.1.10.193:7878"
-#define OVERSEERR_URL       "http://10.1.10.193:5055"
-#define AUDIOBOOKSHELF_URL  "http://10.1.10.193:13378"
-#define MAMMOTH_URL         "http://10.1.10.193:9999"
-#define FLIGHT_TAR1090_URL  "http://flight-radar.local/tar1090"
+// Services panel - status and response time from Uptime Kuma's
+// /metrics, matched by monitor name (exactly as named in Kuma)
 #define UPTIME_KUMA_URL     "http://uptime-kuma.local:3001"
+#define KUMA_API_KEY        ""        // Settings > API Keys; "" if /metrics is open
+#define KUMA_JAZZ_STATS     "Jazz Stats"
+#define KUMA_NHL_TRACKER    "NHL Tracker"
+#define KUMA_CLAUDECAD      "ClaudeCAD"
+#define KUMA_PLEX           "Plex"
+#define KUMA_SONARR         "Sonarr"
+#define KUMA_RADARR         "Radarr"
+#define KUMA_OVERSEERR      "Overseerr"
+#define KUMA_AUDIOBOOKSHELF "Audiobookshelf"
+#define KUMA_MAMMOTH        "Mammoth Stats"
+#define KUMA_FLIGHT_RADAR   "FlightRadar"
+#define KUMA_UPTIME_KUMA    "Uptime Kuma"
+
+// USW Flex switches - SNMPv2c (enable SNMP in the UniFi controller)
+#define SWITCH_1_IP         "10.1.10.XXX"
+#define SWITCH_2_IP         "10.1.10.XXX"
+#define SWITCH_COMMUNITY    "public"
+#define SWITCH_FIRST_IFINDEX 1        // ifIndex of port 1; ports are consecutive
+#define SWITCH_TIMEOUT_MS   500       // wait for both replies
+#define SWITCH_PORT_MBPS    1000      // bar full scale (gigabit ports)
+#define SWITCH_TOP_TALKERS  5         // busiest ports listed
+
+// Pi-hole v6 - FTL's REST API. PIHOLE_PASSWORD is an app password
+// (Settings > Web interface / API, expert mode); "" if none is set
+#define PIHOLE_URL          "http://pihole.local"
+#define PIHOLE_PASSWORD     ""
+#define PIHOLE_CLIENTS_MS   60000     // top-client list re-requested at most this often
+#define PIHOLE_RATIO_POLLS  12        // block ratio over this many polls (1 minute)
+#define PIHOLE_QPS_MAX      20        // query-rate gauge full scale
+
+// ADS-B - readsb's Beast output on the flight-radar Pi
+#define ADSB_HOST           PI_FLIGHT_IP
+#define ADSB_BEAST_PORT     30005
+#define ADSB_RETRY_MS       5000      // reconnect interval
+#define ADSB_POLL_MS        5         // socket drain interval (feed task)
+#define ADSB_READ_CHUNK     1024      // bytes per socket read
+#define ADSB_PUBLISH_MS     250       // radar view rebuilt this often
+#define RADAR_LAT           40.7608f  // receiver = panel centre (READSB_LAT/LON)
+#define RADAR_LON           -111.8910f
+#define RADAR_RANGE_NM      60        // distance at the panel edge
+#define RADAR_STALE_S       15        // position older than this is drawn grey
 
 // ============================================
 // Update intervals (milliseconds)
@@ -69,8 +113,54 @@
 #define UNRAID_UPDATE_MS    15000     // 15 seconds
 #define M900_UPDATE_MS      10000     // 10 seconds
 #define PI_UPDATE_MS        15000     // 15 seconds
-#define SERVICES_UPDATE_MS  30000     // 30 seconds
-#define CUSTOM_UPDATE_MS    10000     // 10 seconds
+#define SERVICES_UPDATE_MS  30000     // 30 seconds (one Uptime Kuma scrape)
+#define SERVICES_SCROLL_MS  3000      // 3 seconds a row, when the list outgrows the panel
+#define CUSTOM_UPDATE_MS    10000     // 10 seconds (re-evaluates changed expressions)
+#define SWITCH_UPDATE_MS    5000      // 5 seconds (one GETBULK per switch)
+#define RADAR_UPDATE_MS     1000      // 1 second (redraw; the table updates per message)
+#define PIHOLE_UPDATE_MS    5000      // 5 seconds (summary counters; top clients when they move)
+#define PIPELINE_STATS_MS   60000     // 1 minute (serial utilisation log)
+#define SNAPSHOT_SAVE_MS    600000    // 10 minutes (warm-start snapshot to flash)
+
+// Also save RLE-compressed panel frames in the snapshot so boot
+// repaints the exact last image, not just a redraw from metrics
+#define SNAPSHOT_FRAMES     1
+
+// ============================================
+// Metric history (flash, see history.h)
+// ============================================
+#define HISTORY_INTERVAL_S  10        // at most one sample per metric this often
+#define HISTORY_SEAL_S      3600      // open blocks reach flash at least this often (lost on power cut)
+
+// ============================================
+// Cached-metrics endpoint (GET /stats, see statsserver.h)
+// ============================================
+#define STATS_HTTP_PORT     80
+#define STATS_HTTP_MAX_CONN 3         // open sockets; oldest idle one is dropped
+#define STATS_DOC_MAX       4096      // bytes, rendered JSON document
+
+// ============================================
+// Custom screen: two derived metrics, syntax in expr.h
+// e.g. "max(piTemps)" or "unraid.used / unraid.total * 100"
+// ============================================
+#define CUSTOM_TITLE        "NETWORK"
+#define CUSTOM_MAIN_LABEL   "DOWN"
+#define CUSTOM_MAIN_EXPR    "rate(m900.net.rx) * 8 / 1e6"
+#define CUSTOM_MAIN_UNIT    "Mbps"
+#define CUSTOM_MAIN_MAX     100       // gauge full scale (warn 50%, crit 80%)
+#define CUSTOM_SUB_LABEL    "UP"
+#define CUSTOM_SUB_EXPR     "rate(m900.net.tx) * 8 / 1e6"
+#define CUSTOM_SUB_UNIT     "Mbps"
+
+// ============================================
+// Event tracing (see trace.h)
+// Off by default: build with -DTRACE_ENABLED=1, then send 't' over
+// USB serial or GET /trace for a Chrome/Perfetto trace
+// ============================================
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED       0
+#endif
+#define TRACE_EVENTS        1024      // ring capacity (power of two), 16 bytes each
 
 // ============================================
 // Screen assignments (which screen shows what)
@@ -78,7 +168,21 @@
 // ============================================
 #define SCREEN_UNRAID       0   // Unraid drive temps + storage
 #define SCREEN_M900         1   // M900 CPU/RAM gauges
-#define SCREEN_PIHEALTH     2   // All 4 Pi temps
+#define SCREEN_PIHEALTH     2   // All 4 Pi temps (if RADAR_SCREEN is 0)
+#define SCREEN_RADAR        2   // ADS-B radar
 #define SCREEN_SERVICES     3   // Service up/down status
-#define SCREEN_CUSTOM       4   // Custom stats gauge
+#define SCREEN_CUSTOM       4   // Custom stats gauge (if SWITCH_SCREEN is 0)
+#define SCREEN_SWITCH       4   // Switch top talkers (if DNS_SCREEN is 0)
+#define SCREEN_DNS          4   // Pi-hole query rate + block ratio
 #define SCREEN_CLOCK        5   // Clock (lowest priority, rightmost)
+
+// Panel 4 shows the switch top talkers; 0 = the Custom screen
+#define SWITCH_SCREEN       1
+
+// Panel 4 shows Pi-hole instead of either (the switches are still
+// polled for /stats when SWITCH_SCREEN is 1)
+#define DNS_SCREEN          1
+
+// Panel 2 shows the ADS-B radar; 0 = the Pi rack gauges (the Pis
+// are polled for /stats either way)
+#define RADAR_SCREEN        1
@@ -3,6 +3,7 @@
 #define LGFX_USE_V1
 #include <LovyanGFX.hpp>
 #include "config.h"
+#include "palette.h"
 
 // GC9A01 display class for LovyanGFX
 class LGFX_GC9A01 : public lgfx::LGFX_Device {
@@ -40,5 +41,77 @@ public:
 // All 6 displays
 extern LGFX_GC9A01* displays[NUM_DISPLAYS];
 
+// A set of panels, bit i = displays[i]
+#define PANEL_MASK_ALL  ((1 << NUM_DISPLAYS) - 1)
+
+// Off-screen framebuffer per panel, FRAME_DEPTH bits of palette
+// index per pixel. Screens draw here with PAL_* colours; the flush
+// task expands and pushes finished frames to the glass (pipeline.h)
+extern LGFX_Sprite* frames[NUM_DISPLAYS];
+
+// Visible chord of each scanline on the round glass: pixels
+// [x0, x0 + w) of row y can be seen, the corners are behind the
+// bezel. Spans are conservative and 2-pixel aligned.
+struct RowSpan {
+    uint8_t x0;
+    uint8_t w;
+};
+extern RowSpan visibleSpans[DISPLAY_HEIGHT];
+
 void initDisplays();
-void clearDisplay(int idx, uint32_t color = 0x000000);
+void clearDisplay(int idx, uint32_t color = PAL_BLACK);
+
+// Fill only the visible disc of a surface, one span per row
+void fillVisible(lgfx::LovyanGFX* d, uint32_t color);
+
+// Shrink a rect to the bounding box of its visible part.
+// Returns false if none of it can be seen.
+bool clipToVisible(int& x, int& y, int& w, int& h);
+
+// Expand frames[idx] through the palette and push it to
+// displays[idx] over DMA, visible chords only (flush task only)
+void flushFrame(int idx);
+
+// Same for one widget's bounding box
+void flushRect(int idx, int x, int y, int w, int h);
+
+// ============================================
+// Broadcast
+// The panels share MOSI/SCLK/DC and differ only in CS, so holding
+// several CS lines low sends one transfer to all of them. Between
+// beginBroadcast() and endBroadcast(), everything written through
+// the returned device (commands, address windows, pixels) reaches
+// every panel in mask. Whoever owns the bus only (flush task once
+// the pipeline runs).
+// ============================================
+LGFX_GC9A01* beginBroadcast(uint8_t mask);
+void endBroadcast();
+
+// frames[src] (or an area of it) to every panel in mask, in one
+// transfer. Their framebuffers should already hold the same
+// pixels, so later partial flushes stay consistent.
+void flushFrameTo(uint8_t mask, int src);
+void flushRectTo(uint8_t mask, int src, int x, int y, int w, int h);
+
+// ============================================
+// Vertical scroll
+// VSCRDEF (0x33) splits the glass into a fixed top, a scrolling
+// area and a fixed bottom; VSCRSADD (0x37) picks the GRAM row shown
+// at the top of the area, the rows after it following on and
+// wrapping round inside it. Moving a list by a row is then one
+// command and the row that wrapped, not the whole list.
+//
+// A scrolling panel's framebuffer holds GRAM order, not what the
+// glass shows. GRAM outside a row's chord is never flushed but can
+// scroll into view, so when an area is defined its rows go out
+// once at full width.
+// ============================================
+struct PanelScroll {
+    uint8_t top;        // first row of the area
+    uint8_t rows;       // rows in it, 0 = panel doesn't scroll
+    uint8_t start;      // GRAM row at the top of the area
+};
+
+// Bring panel idx's scroll in line with s, sending only what
+// changed (flush task only)
+void scrollPanel(int idx, const PanelScroll& s);
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "metrics.h"
+#include <stdint.h>
+
+// ============================================
+// Derived-metric expressions
+// Small arithmetic language over the metric store, compiled once
+// at boot into postfix ops and evaluated on a fixed-size stack:
+//
+//   unraid.used / unraid.total * 100
+//   max(piTemps)
+//   rate(m900.net.rx) * 8 / 1e6
+//
+// + - * / and unary minus, parentheses, numbers (1e6 ok), metric
+// names (see exprNames in expr.cpp) and functions:
+//
+//   min max sum avg (any mix of values and groups like piTemps;
+//                    never-sampled group members are left out)
+//   abs(x)
+//   rate(metric)     per-second change of a counter between its
+//                    last two samples (0 until two, and on reset)
+//
+// An expression is only re-evaluated when one of its inputs has a
+// new sample or changed state; otherwise its cached value stands.
+// ============================================
+
+#define EXPR_MAX_OPS    32
+#define EXPR_MAX_RATES  4       // rate() calls per expression
+#define EXPR_STACK      16
+#define EXPR_DEP_WORDS  ((M_COUNT + 31) / 32)
+
+struct ExprOp {
+    uint8_t code;
+    uint8_t id;         // metric
+    uint8_t count;      // group size, or rate slot
+    uint8_t fn;         // aggregate the op folds into
+    float   k;          // constant
+};
+
+struct ExprRate {
+    double   prev;
+    uint32_t prevMs;    // sample time of prev (0 = none yet)
+    double   rate;
+};
+
+struct Expr {
+    ExprOp   ops[EXPR_MAX_OPS];
+    uint8_t  len;
+    uint8_t  rates;
+    uint32_t deps[EXPR_DEP_WORDS];  // metrics read, one bit each
+    ExprRate rate[EXPR_MAX_RATES];
+
+    double   value;     // NAN if undefined (e.g. max of nothing)
+    bool     stale;     // some input is stale, or none sampled yet
+    bool     valid;     // compiled
+    bool     evaluated;
+};
+
+// Compile src into e. On failure e is invalid and *error / *column
+// (when given) say what went wrong and where.
+bool exprCompile(Expr& e, const char* src, const char** error = nullptr, int* column = nullptr);
+
+// Inputs seen at the previous update, to tell what changed
+struct ExprInputs {
+    uint32_t sampledMs[M_COUNT];
+    uint8_t  state[M_COUNT];
+};
+
+// Bit per metric whose sample or state differs from last; last is
+// brought up to date
+void exprChangedInputs(const MetricStore& m, ExprInputs& last, uint32_t changed[EXPR_DEP_WORDS]);
+
+// Re-evaluate e if any input changed (or it was never evaluated);
+// the stale flag is refreshed every call. True if re-evaluated.
+bool exprUpdate(Expr& e, const MetricStore& m, const uint32_t changed[EXPR_DEP_WORDS],
+                uint32_t nowMs);
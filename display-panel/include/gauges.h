@@ -19,8 +19,11 @@ struct GaugeConfig {
     int   sweepAngle;     // Total sweep in degrees (270 = full gauge)
 };
 
+// Arc maths runs in float, degrees to radians included
+static constexpr float GAUGE_DEG2RAD = 0.017453292f;
+
 // Default gauge config (tachometer style: 7 o'clock to 5 o'clock)
-static const GaugeConfig DEFAULT_GAUGE = {
+static constexpr GaugeConfig DEFAULT_GAUGE = {
     .minVal     = 0,
     .maxVal     = 100,
     .warnVal    = 70,
@@ -32,7 +35,7 @@ static const GaugeConfig DEFAULT_GAUGE = {
 };
 
 // Temperature gauge (20°C to 70°C for drives)
-static const GaugeConfig TEMP_GAUGE = {
+static constexpr GaugeConfig TEMP_GAUGE = {
     .minVal     = 20,
     .maxVal     = 70,
     .warnVal    = 45,
@@ -44,7 +47,7 @@ static const GaugeConfig TEMP_GAUGE = {
 };
 
 // CPU gauge (0-100%)
-static const GaugeConfig CPU_GAUGE = {
+static constexpr GaugeConfig CPU_GAUGE = {
     .minVal     = 0,
     .maxVal     = 100,
     .warnVal    = 75,
@@ -56,7 +59,7 @@ static const GaugeConfig CPU_GAUGE = {
 };
 
 // RAM gauge (0-100%)
-static const GaugeConfig RAM_GAUGE = {
+static constexpr GaugeConfig RAM_GAUGE = {
     .minVal     = 0,
     .maxVal     = 100,
     .warnVal    = 80,
@@ -68,7 +71,7 @@ static const GaugeConfig RAM_GAUGE = {
 };
 
 // Small gauge for multi-gauge layouts (Pi rack screen)
-static const GaugeConfig SMALL_GAUGE = {
+static constexpr GaugeConfig SMALL_GAUGE = {
     .minVal     = 20,
     .maxVal     = 85,
     .warnVal    = 65,
@@ -79,24 +82,35 @@ static const GaugeConfig SMALL_GAUGE = {
     .sweepAngle = 270
 };
 
-// Draw a full RPM-style gauge with value, label, and unit
-void drawGauge(LGFX_GC9A01* d, int cx, int cy,
+// The configs are constexpr so each can also pick a renderer
+// built for it at compile time (gaugetables.h); the functions
+// below take any config at runtime.
+
+// Draw a full RPM-style gauge with value, label, and unit.
+// muted = stale value: the fill and value are drawn in grey
+void drawGauge(LGFX_Sprite* d, int cx, int cy,
                float value, const GaugeConfig& cfg,
                const char* label, const char* unit,
-               const char* valueFormat = "%.0f");
+               const char* valueFormat = "%.0f", bool muted = false);
 
 // Draw just the arc (for custom layouts)
-void drawArc(LGFX_GC9A01* d, int cx, int cy,
-             float value, const GaugeConfig& cfg);
+void drawArc(LGFX_Sprite* d, int cx, int cy,
+             float value, const GaugeConfig& cfg, bool muted = false);
 
 // Draw tick marks around the gauge
-void drawTicks(LGFX_GC9A01* d, int cx, int cy,
+void drawTicks(LGFX_Sprite* d, int cx, int cy,
                const GaugeConfig& cfg, int numTicks = 9);
 
 // Draw a mini gauge (for multi-gauge screens)
-void drawMiniGauge(LGFX_GC9A01* d, int cx, int cy,
+void drawMiniGauge(LGFX_Sprite* d, int cx, int cy,
                    float value, const GaugeConfig& cfg,
-                   const char* label, const char* valueStr);
+                   const char* label, const char* valueStr, bool muted = false);
+
+// Text parts of drawGauge() and drawMiniGauge()
+void drawGaugeText(LGFX_Sprite* d, int cx, int cy, float value, uint32_t valColor,
+                   const char* label, const char* unit, const char* valueFormat);
+void drawMiniGaugeText(LGFX_Sprite* d, int cx, int cy, uint32_t valColor,
+                       const char* label, const char* valueStr);
 
 // Color for a value given warn/crit thresholds
 uint32_t gaugeColor(float value, float warn, float crit);
@@ -0,0 +1,240 @@
+#pragma once
+
+#include "gauges.h"
+#include <stdint.h>
+
+// ============================================
+// Compile-time gauges
+// The same drawing as drawArc() / drawGauge() / drawMiniGauge(),
+// specialised on a constexpr GaugeConfig:
+//
+//   drawMiniGauge<SMALL_GAUGE>(d, cx, cy, value, label, valueStr);
+//
+// Everything that depends only on the config is worked out by the
+// compiler and lands in flash (.rodata):
+//
+//   arc pixels    each degree's run of pixels, as offsets from the
+//                 centre; one table per geometry, shared by configs
+//                 that differ only in range and thresholds
+//   needle ends   per degree
+//   colour runs   the degrees where the fill turns yellow and red
+//   ticks         end points and colour of each
+//
+// Drawing is then a walk over a few runs of the table: no trig, no
+// per-degree threshold test, nothing read from the config. Offsets
+// and boundaries come from the same float arithmetic as the runtime
+// path, so both put the same pixels in the framebuffer (the bench
+// checks). A NaN value draws as the minimum.
+// ============================================
+
+// cos in double by Taylor series, for the tables. Rounded to float
+// it gives what cosf() does for the angles a gauge uses.
+constexpr double gaugeCos(double x) {
+    const double PI = 3.14159265358979323846;
+    while (x > PI) x -= 2 * PI;
+    while (x < -PI) x += 2 * PI;
+    double term = 1, sum = 1;
+    for (int n = 1; n <= 16; n++) {
+        term *= -x * x / ((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double gaugeSin(double x) {
+    return gaugeCos(x - 3.14159265358979323846 / 2);
+}
+
+struct GaugePixel {
+    int8_t dx, dy;
+};
+
+struct GaugeLine {
+    int8_t  x1, y1, x2, y2;
+    uint8_t color;
+};
+
+// ============================================
+// Arc geometry
+// Degree a's pixels are px[first[a]] up to px[first[a + 1]], inner
+// radius outwards; radii that land on the pixel before are dropped
+// ============================================
+template <int R_OUTER, int R_INNER, int START, int SWEEP>
+struct GaugeArc {
+    static_assert(R_OUTER + 2 <= 127, "offsets are int8_t");
+
+    // Visits every pixel the runtime path draws for degree a
+    template <typename F>
+    static constexpr void walk(int a, F&& fn) {
+        float rad = (START + a) * GAUGE_DEG2RAD;
+        float cs = (float)gaugeCos(rad);
+        float sn = (float)gaugeSin(rad);
+        int px = 0, py = 0;
+        for (int r = R_INNER; r <= R_OUTER; r++) {
+            int x = (int)(r * cs);
+            int y = (int)(r * sn);
+            if (r == R_INNER || x != px || y != py) fn(x, y);
+            px = x;
+            py = y;
+        }
+    }
+
+    static constexpr int countPixels() {
+        int n = 0;
+        for (int a = 0; a <= SWEEP; a++) walk(a, [&n](int, int) { n++; });
+        return n;
+    }
+
+    static constexpr int COUNT = countPixels();
+
+    struct Table {
+        uint16_t   first[SWEEP + 2];
+        GaugePixel px[COUNT];
+        GaugeLine  needle[SWEEP + 1];
+    };
+
+    static constexpr Table build() {
+        Table t{};
+        int n = 0;
+        for (int a = 0; a <= SWEEP; a++) {
+            t.first[a] = n;
+            walk(a, [&t, &n](int x, int y) { t.px[n++] = {(int8_t)x, (int8_t)y}; });
+
+            float rad = (START + a) * GAUGE_DEG2RAD;
+            float cs = (float)gaugeCos(rad);
+            float sn = (float)gaugeSin(rad);
+            t.needle[a] = {(int8_t)(int)((R_INNER - 4) * cs), (int8_t)(int)((R_INNER - 4) * sn),
+                           (int8_t)(int)((R_OUTER + 2) * cs), (int8_t)(int)((R_OUTER + 2) * sn),
+                           (uint8_t)PAL_WHITE};
+        }
+        t.first[SWEEP + 1] = n;
+        return t;
+    }
+
+    static constexpr Table table = build();
+
+    // Degrees [from, to) in one colour
+    static void plot(LGFX_Sprite* d, int cx, int cy, int from, int to, uint32_t color) {
+        if (from >= to) return;
+        const GaugePixel* p = table.px + table.first[from];
+        const GaugePixel* end = table.px + table.first[to];
+        for (; p < end; p++) d->drawPixel(cx + p->dx, cy + p->dy, color);
+    }
+};
+
+template <const GaugeConfig& C>
+using GaugeArcOf = GaugeArc<C.arcRadius, C.arcRadius - C.arcWidth, C.startAngle, C.sweepAngle>;
+
+// ============================================
+// Colour runs
+// gaugeColor() of each degree's value, as the degrees where it
+// first reaches the warn and crit thresholds
+// ============================================
+template <const GaugeConfig& C>
+struct GaugeRuns {
+    static_assert(C.maxVal > C.minVal, "gauge range is empty");
+
+    // First degree whose value reaches v, SWEEP + 1 if none does
+    static constexpr int firstAt(float v) {
+        for (int a = 0; a <= C.sweepAngle; a++) {
+            float segPct = (float)a / C.sweepAngle;
+            float segVal = C.minVal + segPct * (C.maxVal - C.minVal);
+            if (segVal >= v) return a;
+        }
+        return C.sweepAngle + 1;
+    }
+
+    static constexpr int RED    = firstAt(C.critVal);
+    static constexpr int YELLOW = firstAt(C.warnVal) < RED ? firstAt(C.warnVal) : RED;
+
+    // Degrees of arc filled for value
+    static int fill(float value) {
+        float v = constrain(value, C.minVal, C.maxVal);
+        if (v != v) v = C.minVal;
+        float pct = (v - C.minVal) / (C.maxVal - C.minVal);
+        return (int)(pct * C.sweepAngle);
+    }
+
+    static uint32_t valueColor(float value, bool muted) {
+        if (muted) return PAL_DARKGREY;
+        return value >= C.critVal ? PAL_RED : value >= C.warnVal ? PAL_YELLOW : PAL_GREEN;
+    }
+};
+
+// ============================================
+// Ticks: N + 1 of them, every other one long
+// ============================================
+template <const GaugeConfig& C, int N>
+struct GaugeTicks {
+    struct Table {
+        GaugeLine tick[N + 1];
+    };
+
+    static constexpr Table build() {
+        Table t{};
+        const int rOuter = C.arcRadius + 4;
+        const int rInner = C.arcRadius - C.arcWidth - 2;
+        for (int i = 0; i <= N; i++) {
+            float pct = (float)i / N;
+            float angle = (C.startAngle + pct * C.sweepAngle) * GAUGE_DEG2RAD;
+            float cs = (float)gaugeCos(angle);
+            float sn = (float)gaugeSin(angle);
+            bool major = (i % 2 == 0);
+            int r1 = major ? rInner : rInner + 3;
+            t.tick[i] = {(int8_t)(int)(r1 * cs), (int8_t)(int)(r1 * sn),
+                         (int8_t)(int)(rOuter * cs), (int8_t)(int)(rOuter * sn),
+                         (uint8_t)(major ? PAL_LIGHTGREY : PAL_DARKGREY)};
+        }
+        return t;
+    }
+
+    static constexpr Table table = build();
+};
+
+// ============================================
+// Renderers
+// ============================================
+template <const GaugeConfig& C>
+void drawArc(LGFX_Sprite* d, int cx, int cy, float value, bool muted = false) {
+    using Arc = GaugeArcOf<C>;
+    using Runs = GaugeRuns<C>;
+    int fill = Runs::fill(value);
+
+    // Unlit part first, then the fill up to and including its last
+    // degree: a pixel two degrees share ends up in the later one's
+    // colour, as when the runtime path draws over its background
+    Arc::plot(d, cx, cy, fill + 1, C.sweepAngle + 1, PAL_ARC_BG);
+    if (muted) {
+        Arc::plot(d, cx, cy, 0, fill + 1, PAL_DARKGREY);
+    } else {
+        Arc::plot(d, cx, cy, 0, min(fill + 1, Runs::YELLOW), PAL_GREEN);
+        Arc::plot(d, cx, cy, Runs::YELLOW, min(fill + 1, Runs::RED), PAL_YELLOW);
+        Arc::plot(d, cx, cy, Runs::RED, fill + 1, PAL_RED);
+    }
+
+    const GaugeLine& n = Arc::table.needle[fill];
+    d->drawLine(cx + n.x1, cy + n.y1, cx + n.x2, cy + n.y2, n.color);
+}
+
+template <const GaugeConfig& C, int N = 9>
+void drawTicks(LGFX_Sprite* d, int cx, int cy) {
+    for (const GaugeLine& t : GaugeTicks<C, N>::table.tick) {
+        d->drawLine(cx + t.x1, cy + t.y1, cx + t.x2, cy + t.y2, t.color);
+    }
+}
+
+template <const GaugeConfig& C>
+void drawGauge(LGFX_Sprite* d, int cx, int cy, float value,
+               const char* label, const char* unit,
+               const char* valueFormat = "%.0f", bool muted = false) {
+    drawArc<C>(d, cx, cy, value, muted);
+    drawTicks<C>(d, cx, cy);
+    drawGaugeText(d, cx, cy, value, GaugeRuns<C>::valueColor(value, muted), label, unit, valueFormat);
+}
+
+template <const GaugeConfig& C>
+void drawMiniGauge(LGFX_Sprite* d, int cx, int cy, float value,
+                   const char* label, const char* valueStr, bool muted = false) {
+    drawArc<C>(d, cx, cy, value, muted);
+    drawMiniGaugeText(d, cx, cy, GaugeRuns<C>::valueColor(value, muted), label, valueStr);
+}
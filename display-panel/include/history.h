@@ -0,0 +1,80 @@
+#pragma once
+
+#include "metrics.h"
+#include <stdint.h>
+
+// ============================================
+// Metric history
+// Samples of every metric, compressed Gorilla-style into the
+// "history" flash partition for trend views:
+//
+//   timestamps  epoch seconds as delta-of-delta; a source polled
+//               on schedule costs 1 bit a sample
+//   values      as float, XOR'd with the previous one: unchanged
+//               is 1 bit. A short decimal reading (23.4) goes in
+//               as the integer 234, so a change flips low bits
+//               only rather than the whole mantissa
+//
+// Each metric fills its own block in RAM. A full block, or one
+// open HISTORY_SEAL_S, is appended to the partition as a record
+// whose header carries the metric, time span and min/max/sum.
+// The partition is a circular log of 4 KB sectors: when it wraps
+// the oldest sector is erased, so every sector is erased once per
+// lap (wear levelling) and nothing is rewritten in place. A record
+// is one write, and a torn one is dropped at the next mount.
+//
+// Queries bin one metric over a window into equal buckets. Sectors
+// whose span misses the window are skipped on a RAM index, other
+// records on their header, and a record that falls inside a single
+// bucket is folded in from its rollup without being decompressed.
+// Loop task only.
+// ============================================
+
+#define HISTORY_BLOCK_BYTES 256     // compressed payload per record (RAM: one block per metric)
+#define HISTORY_MAX_SECTORS 1024    // 4 MB partition at most (10 KB RAM index)
+
+struct HistoryBucket {
+    float    min;
+    float    max;
+    float    mean;
+    uint32_t count;         // samples, 0 = no data (gap)
+};
+
+struct HistoryStats {
+    uint32_t samples;       // appended since mount
+    uint32_t records;       // written since mount
+    uint32_t flashBytes;    // those records, headers included
+    uint32_t erases;        // sectors erased since mount
+    uint16_t sectors;       // in the partition
+    uint16_t used;          // holding records
+    uint32_t oldest;        // epoch s of the oldest record held, 0 = none
+
+    // Last query
+    uint16_t sectorsRead;   // overlapping the window
+    uint16_t headersRead;   // record headers looked at
+    uint16_t decoded;       // records decompressed
+    uint16_t rolledUp;      // records taken from their header alone
+};
+
+// Mount the partition: find the head of the log and index every
+// sector's time span. Open blocks start empty. False if there is
+// no history partition (everything else is then a no-op).
+bool historyBegin();
+
+// Append one sample; t (epoch seconds) should not go backwards
+// for a metric. Non-finite values are dropped.
+void historyAppend(int id, uint32_t t, float value);
+
+// Append each metric's new live samples from the store, at most
+// one per HISTORY_INTERVAL_S, and write out blocks open longer than
+// HISTORY_SEAL_S. Does nothing until NTP has set the clock.
+void historyRecord();
+
+// Write every open block now (before a restart)
+void historySeal();
+
+// Bin id's samples in [from, to) into `buckets` equal buckets.
+// Returns the number of buckets holding samples.
+int historyQuery(int id, uint32_t from, uint32_t to, HistoryBucket* out, int buckets);
+
+const HistoryStats& historyStats();
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================
+// Streaming gzip / deflate decoder
+// Wraps the response stream and inflates on demand as the parser
+// reads, so a compressed body is never held whole in RAM: the
+// only buffers are the 32 KB history window deflate requires, a
+// small input buffer and the Huffman tables, all inside the
+// object. Allocates nothing; keep one instance and begin() it
+// per response.
+// ============================================
+
+#define INFLATE_WINDOW_BITS 15                  // deflate maximum, what servers use
+#define INFLATE_WINDOW_SIZE (1 << INFLATE_WINDOW_BITS)
+#define INFLATE_INPUT_SIZE  512
+#define INFLATE_FAST_BITS   9                   // first-level Huffman lookup
+
+class InflateStream : public Stream {
+public:
+    enum Format {
+        GZIP,       // Content-Encoding: gzip
+        DEFLATE,    // Content-Encoding: deflate (zlib-wrapped, or raw)
+    };
+
+    // Start decoding a new body read from src
+    void begin(Stream& src, Format format);
+
+    // Drain whatever the parser left unread and check the trailer
+    // (CRC32 / Adler-32 and length). False on any corrupt input.
+    bool finish();
+
+    bool failed() const { return _state == S_ERROR; }
+    uint32_t totalIn() const { return _totalIn; }
+    uint32_t totalOut() const { return _totalOut; }
+
+    // Stream
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t readBytes(char* buf, size_t len) override;
+    size_t write(uint8_t) override { return 0; }
+
+private:
+    struct Huffman {
+        uint16_t count[16];     // codes per bit length
+        uint16_t symbol[288];   // symbols in canonical order
+        uint16_t fast[1 << INFLATE_FAST_BITS];  // (len << 9) | symbol, 0 = slow path
+    };
+
+    enum State {
+        S_HEADER, S_BLOCK, S_STORED, S_HUFF, S_TRAILER, S_DONE, S_ERROR,
+    };
+
+    int  produce();
+    bool header();
+    bool blockHeader();
+    bool dynamicTables();
+    bool trailer();
+    int  decode(const Huffman& h);
+    bool build(Huffman& h, const uint8_t* lengths, int n);
+
+    int  nextByte(bool block);
+    bool need(int n);
+    uint32_t bits(int n);
+    int  alignedByte();
+    void put(uint8_t c);
+    int  fail();
+
+    Stream*  _src = nullptr;
+    Format   _format = GZIP;
+    bool     _zlib = false;
+    State    _state = S_DONE;
+    bool     _final = false;
+    int      _peeked = -1;
+
+    uint8_t  _in[INFLATE_INPUT_SIZE];
+    uint16_t _inPos = 0;
+    uint16_t _inLen = 0;
+    uint32_t _bitBuf = 0;
+    int      _bitCnt = 0;
+
+    uint8_t  _window[INFLATE_WINDOW_SIZE];
+    uint32_t _totalIn = 0;
+    uint32_t _totalOut = 0;
+    uint32_t _storedLeft = 0;
+    uint16_t _copyLen = 0;
+    uint16_t _copyDist = 0;
+
+    uint32_t _crc = 0;          // gzip
+    uint32_t _adlerA = 1;       // zlib
+    uint32_t _adlerB = 0;
+
+    Huffman  _lencode;
+    Huffman  _distcode;
+    uint8_t  _lengths[320];     // code lengths while reading a dynamic header
+};
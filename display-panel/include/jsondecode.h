@@ -0,0 +1,72 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <type_traits>
+
+// ============================================
+// Schema-driven streaming JSON decoder
+// Each endpoint declares, at compile time, which JSON paths it
+// wants and where they land in a plain struct. jsonDecode() reads
+// the response once, straight off the stream, writing matched
+// values into the struct as they go past. Anything not in the
+// schema is skipped by bracket counting without being stored, so
+// memory use is a few hundred bytes of stack whatever the reply
+// contains. No DOM, no allocation.
+//
+// Paths are dotted keys from the root ("cpu.temp_c"). An array of
+// objects is declared with JSON_ARRAY at "name[]" and its element
+// members as "name[].key"; one level of arrays is supported.
+// ============================================
+
+#define JSON_PATH_MAX   48      // longest path tracked; longer keys are skipped
+#define JSON_DEPTH_MAX  8       // nesting followed into (skipped subtrees are unlimited)
+#define JSON_READ_CHUNK 64      // bytes pulled from the stream at a time
+
+enum JsonFieldType : uint8_t {
+    JF_NUMBER,      // double
+    JF_INT,         // int32_t (fraction truncated)
+    JF_STRING,      // char[N], truncated to fit, always terminated
+    JF_ARRAY,       // int32_t element count; elements are the "[]" fields
+};
+
+struct JsonField {
+    const char*   path;
+    JsonFieldType type;
+    uint16_t      offset;   // into the target; array members: in element 0
+    uint16_t      size;     // string: buffer size; array: element stride
+    uint8_t       count;    // array: capacity in elements
+};
+
+struct JsonSchema {
+    const JsonField* fields;
+    uint8_t          count;
+};
+
+// Member type -> field type; any other member type fails to compile
+template <typename T> struct JsonFieldTypeOf;
+template <> struct JsonFieldTypeOf<double>  { static constexpr JsonFieldType value = JF_NUMBER; };
+template <> struct JsonFieldTypeOf<int32_t> { static constexpr JsonFieldType value = JF_INT; };
+template <size_t N> struct JsonFieldTypeOf<char[N]> { static constexpr JsonFieldType value = JF_STRING; };
+
+#define JSON_MEMBER_TYPE(T, member) \
+    std::remove_reference<decltype(((T*)nullptr)->member)>::type
+
+// Scalar or string member; its type picks the conversion
+#define JSON_FIELD(T, path, member)                                 \
+    { path, JsonFieldTypeOf<JSON_MEMBER_TYPE(T, member)>::value,    \
+      (uint16_t)offsetof(T, member),                                \
+      (uint16_t)sizeof(JSON_MEMBER_TYPE(T, member)), 0 }
+
+// Array of structs; counter (int32_t) gets how many were stored
+#define JSON_ARRAY(T, path, counter, array)                                     \
+    { path, JF_ARRAY, (uint16_t)offsetof(T, counter),                           \
+      (uint16_t)sizeof(((T*)nullptr)->array[0]),                                \
+      (uint8_t)(sizeof(((T*)nullptr)->array) / sizeof(((T*)nullptr)->array[0])) }
+
+#define JSON_SCHEMA(fields) JsonSchema{ fields, (uint8_t)(sizeof(fields) / sizeof(fields[0])) }
+
+// Decode one JSON value from in into out. Fields missing from the
+// reply keep whatever out held, so initialise it with defaults.
+// False on malformed or truncated input (out may be partly written).
+bool jsonDecode(Stream& in, const JsonSchema& schema, void* out);
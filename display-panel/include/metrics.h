@@ -0,0 +1,129 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================
+// Metric store
+// Every numeric value the screens show, keyed by a compile-time
+// ID and laid out as parallel arrays (value / sample time /
+// state / source) so a frame's reads stay in a few cache lines.
+//
+// Fetches write into a private staging copy and publish it once
+// per poll through a seqlock; any task on either core takes a
+// consistent snapshot with metricsRead() without locking.
+// Free text (drive names, array status) stays with the screens.
+// ============================================
+
+#define METRIC_DRIVES     8
+#define METRIC_PIS        4
+#define METRIC_SERVICES   11
+#define METRIC_SWITCHES   2
+#define METRIC_SWITCH_PORTS 5       // per switch (USW Flex)
+#define METRIC_DNS_CLIENTS  4       // Pi-hole top clients
+
+enum MetricId : uint8_t {
+    // Unraid
+    M_UNRAID_DRIVE_TEMP,                                    // + drive
+    M_UNRAID_DRIVE_COUNT = M_UNRAID_DRIVE_TEMP + METRIC_DRIVES,
+    M_UNRAID_STORAGE_USED_TB,
+    M_UNRAID_STORAGE_TOTAL_TB,
+    M_UNRAID_CPU,
+    M_UNRAID_MEM,
+    M_UNRAID_DOCKER_RUNNING,
+    M_UNRAID_DOCKER_TOTAL,
+    M_UNRAID_ARRAY_STARTED,                                 // 1 / 0
+
+    // M900
+    M_M900_CPU,
+    M_M900_CPU_TEMP,
+    M_M900_MEM,
+    M_M900_MEM_USED_GB,
+    M_M900_MEM_TOTAL_GB,
+    M_M900_DISK,
+    M_M900_DISK_USED_GB,
+    M_M900_DISK_TOTAL_GB,
+    M_M900_NET_SENT,                                        // bytes, counter
+    M_M900_NET_RECV,                                        // bytes, counter
+    M_M900_NET_UP_MBPS,
+    M_M900_NET_DOWN_MBPS,
+
+    // Pi rack
+    M_PI_TEMP,                                              // + pi
+    M_PI_CPU = M_PI_TEMP + METRIC_PIS,
+    M_PI_MEM = M_PI_CPU + METRIC_PIS,
+
+    // Services, as Uptime Kuma sees them
+    M_SERVICE_UP = M_PI_MEM + METRIC_PIS,                   // + service (1 = up)
+    M_SERVICE_MS = M_SERVICE_UP + METRIC_SERVICES,          // + service, response time
+
+    // Switch ports, Mbps as seen by the switch (in = from the device)
+    M_SWITCH_IN_MBPS = M_SERVICE_MS + METRIC_SERVICES,      // + switch * ports + port
+    M_SWITCH_OUT_MBPS = M_SWITCH_IN_MBPS + METRIC_SWITCHES * METRIC_SWITCH_PORTS,
+
+    // ADS-B feed
+    M_ADSB_AIRCRAFT = M_SWITCH_OUT_MBPS + METRIC_SWITCHES * METRIC_SWITCH_PORTS,
+    M_ADSB_MSG_RATE,                                        // Mode S frames / s
+
+    // Pi-hole; counts cover FTL's last 24 hours
+    M_DNS_QUERIES,
+    M_DNS_BLOCKED,
+    M_DNS_FORWARDED,
+    M_DNS_CACHED,
+    M_DNS_CLIENTS,                                          // active
+    M_DNS_QPS,                                              // queries / s over the last poll
+    M_DNS_BLOCK_PCT,                                        // blocked share, last PIHOLE_RATIO_POLLS
+    M_DNS_CLIENT_QUERIES,                                   // + top client
+
+    M_COUNT = M_DNS_CLIENT_QUERIES + METRIC_DNS_CLIENTS
+};
+
+enum MetricState : uint8_t {
+    MS_EMPTY,       // never sampled
+    MS_LIVE,        // sampled by its source
+    MS_STALE,       // source stopped answering, or restored from flash
+};
+
+enum MetricSource : uint8_t {
+    SRC_NONE,
+    SRC_SNAPSHOT,   // warm-start restore
+    SRC_UNRAID,
+    SRC_M900,
+    SRC_PI,         // + pi
+    SRC_KUMA = SRC_PI + METRIC_PIS,
+    SRC_SWITCH,     // + switch
+    SRC_ADSB = SRC_SWITCH + METRIC_SWITCHES,
+    SRC_PIHOLE,
+    SRC_COUNT
+};
+
+struct MetricStore {
+    double   value[M_COUNT];
+    uint32_t sampledMs[M_COUNT];    // millis() at the sample
+    uint8_t  state[M_COUNT];
+    uint8_t  source[M_COUNT];
+};
+
+// --- Writer side (loop task only) ---
+// Stage a fresh sample; nothing is visible until metricsPublish()
+void metricSet(int id, double value, MetricSource src);
+
+// Source failed: keep the last values but mark them stale
+void metricMarkStale(int id, int count = 1);
+
+// Overwrite a value with one restored from flash (stale)
+void metricRestore(int id, double value);
+
+// Make every staged change visible to readers at once
+void metricsPublish();
+
+// --- Reader side (any task) ---
+// Consistent copy of the whole store; returns its sequence
+uint32_t metricsRead(MetricStore& out);
+
+// Current publish sequence; equal to an earlier metricsRead()
+// return = nothing new since
+uint32_t metricsSequence();
+
+// Stale = marked so by its writer, never sampled, or older than
+// three polls of its source
+bool metricStale(const MetricStore& m, int id, uint32_t nowMs);
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================
+// Shared colour table
+// Framebuffers hold palette indices, not RGB565 (see FRAME_DEPTH
+// in config.h): screens draw with the PAL_* names below and
+// flushFrame() expands them to RGB565 on the way to the panel.
+// Adding a colour = a new index here + its entry in PALETTE.
+// ============================================
+
+static constexpr int PAL_BLACK     = 0;
+static constexpr int PAL_WHITE     = 1;
+static constexpr int PAL_LIGHTGREY = 2;
+static constexpr int PAL_DARKGREY  = 3;
+static constexpr int PAL_ARC_BG    = 4;     // unlit gauge arc
+static constexpr int PAL_GREEN     = 5;
+static constexpr int PAL_YELLOW    = 6;
+static constexpr int PAL_RED       = 7;
+static constexpr int PAL_ORANGE    = 8;     // Unraid title
+static constexpr int PAL_CYAN      = 9;
+static constexpr int PAL_MAGENTA   = 10;
+static constexpr int PAL_COUNT     = 11;
+
+// RGB565 for each index above
+static const uint16_t PALETTE[PAL_COUNT] = {
+    0x0000,     // black
+    0xFFFF,     // white
+    0xD69A,     // light grey
+    0x7BEF,     // dark grey
+    0x2104,     // arc background
+    0x07E0,     // green
+    0xFFE0,     // yellow
+    0xF800,     // red
+    0xFD20,     // orange
+    0x07FF,     // cyan
+    0xF81F,     // magenta
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================
+// Two-stage render -> flush pipeline
+// Core 1 (Arduino loop) draws a panel into its framebuffer,
+// core 0 DMA-flushes finished frames to the glass. Frames are
+// handed over and returned through lock-free SPSC queues, so
+// panel N+1 renders while panel N is still on the SPI bus.
+// ============================================
+
+typedef void (*DrawFn)(int idx);
+
+struct PanelScroll;     // displays.h
+
+struct PipelineStats {
+    uint32_t windowUs;      // Wall time covered by the counters
+    uint32_t renderBusyUs;  // Core 1 time spent drawing into framebuffers
+    uint32_t renderWaitUs;  // Core 1 time blocked on a panel still flushing
+    uint32_t flushBusyUs;   // Core 0 time spent pushing frames over SPI
+    uint32_t frames;        // Frames flushed in the window
+};
+
+// Start the flush task on core 0 (call from setup(), after initDisplays)
+void startPipeline();
+
+// Claim panel idx's framebuffer for drawing. Blocks only while
+// that panel's previous frame is still queued or on the bus.
+void beginFrame(int idx);
+
+// Hand the finished framebuffer to the flush task
+void submitFrame(int idx);
+
+// Only this area of it changed
+void submitRect(int idx, int x, int y, int w, int h);
+
+// Send frames[idx] to every panel in mask in one transfer
+// (displays.h broadcast); only idx's framebuffer is held
+void submitBroadcast(int idx, uint8_t mask);
+
+// Hardware scroll for idx (displays.h): goes out with each of its
+// jobs from now on, ahead of the pixels
+void scrollFrame(int idx, const PanelScroll& s);
+
+// beginFrame + fn(idx) + submitFrame
+void renderPanel(int idx, DrawFn fn);
+
+// Block until every submitted frame has reached the glass
+void pipelineDrain();
+
+// Read and reset the utilisation counters
+PipelineStats pipelineTakeStats();
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================
+// Prometheus text-format parser
+// Reads an exposition (/metrics) once, straight off the stream.
+// Metric names, label names and label values are never stored:
+// each is folded into a 32-bit FNV-1a hash as its bytes go past
+// and compared with hashes the caller worked out at compile time
+// with promHash(). A line whose metric isn't asked for is skipped
+// as soon as its name ends, comments and all.
+//
+// For each wanted sample fn gets the metric, the value of one key
+// label (e.g. monitor_name, as a hash) and the number. Timestamps
+// are ignored. No allocation; the parser is ~350 bytes of stack.
+// ============================================
+
+#define PROM_READ_CHUNK 256     // bytes pulled from the stream at a time
+
+constexpr uint32_t PROM_HASH_SEED = 2166136261u;
+
+constexpr uint32_t promHashStep(uint32_t h, uint8_t c) {
+    return (h ^ c) * 16777619u;
+}
+
+// FNV-1a of s; constexpr, so name tables cost nothing at runtime
+constexpr uint32_t promHash(const char* s, uint32_t h = PROM_HASH_SEED) {
+    return *s ? promHash(s + 1, promHashStep(h, (uint8_t)*s)) : h;
+}
+
+struct PromQuery {
+    const uint32_t* names;      // promHash of each metric wanted
+    uint8_t         count;
+    uint32_t        keyLabel;   // promHash of the label that names the series
+};
+
+struct PromSample {
+    uint8_t  metric;            // index into PromQuery::names
+    uint32_t key;               // promHash of the key label's value, 0 = no such label
+    double   value;             // NaN and +/-Inf as the exposition has them
+};
+
+typedef void (*PromSampleFn)(void* ctx, const PromSample& s);
+
+// Parse the exposition in `in` to its end, calling fn for each
+// sample of a wanted metric. Returns the number of samples, or -1
+// if a wanted line is malformed (samples before it were delivered).
+int promParse(Stream& in, const PromQuery& q, PromSampleFn fn, void* ctx);
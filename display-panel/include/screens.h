@@ -2,7 +2,6 @@
 
 #include "displays.h"
 #include "gauges.h"
-#include <ArduinoJson.h>
 
 // --- Screen drawing functions ---
 
@@ -15,12 +14,28 @@ void drawM900(int idx);
 // Screen 2: Pi rack health (4 mini gauges for each Pi)
 void drawPiHealth(int idx);
 
-// Screen 3: Service status (up/down indicators)
+// Screen 2 (alternative): ADS-B radar around the receiver
+void drawRadar(int idx);
+
+// Screen 3: Service status (up/down indicators), a list that
+// scrolls in hardware. drawServices() paints all of it; after that
+// updateServices() keeps it current a row at a time: each call
+// draws the next thing that changed (or, with scroll, moves the
+// list one row) and returns its rect, false once nothing has.
+// Jobs for the panel carry servicesScroll() (pipeline.h).
 void drawServices(int idx);
+bool updateServices(int idx, bool scroll, int& x, int& y, int& w, int& h);
+PanelScroll servicesScroll();
 
 // Screen 4: Custom stats (configurable gauge)
 void drawCustom(int idx);
 
+// Screen 4 (alternative): Switch top talkers (per-port Mbps)
+void drawSwitches(int idx);
+
+// Screen 4 (alternative): Pi-hole query rate, block ratio, top clients
+void drawPihole(int idx);
+
 // Screen 5: Clock + date (minimal)
 void drawClock(int idx);
 
@@ -30,6 +45,35 @@ void fetchM900();
 void fetchPiHealth();
 void fetchServices();
 void fetchCustom();
+void fetchSwitches();
+void fetchRadar();      // reads the ADS-B feed's latest view (adsbfeed.h)
+void fetchPihole();
+
+// Compile the custom screen's expressions (config.h); call once
+void setupCustom();
 
 // --- Boot splash ---
-void drawBootSplash(int idx, const char* label);
+// In two parts so the ring, the same on every panel, can be
+// broadcast once: the background, then the panel's label, whose
+// bounding box comes back for a partial flush
+void drawBootSplash(int idx);
+void drawBootLabel(int idx, const char* label, int& x, int& y, int& w, int& h);
+
+// Status line the clock shows until NTP sync (nullptr = none)
+void setBootStatus(const char* status);
+
+// --- Warm-start state (see snapshot.h) ---
+// Serialise / restore the cached values; restored screens are
+// marked stale until their source answers live
+size_t saveScreenState(uint8_t* buf, size_t cap);
+bool   loadScreenState(const uint8_t* buf, size_t len);
+
+// Render every cached value, with per-source fetch time and stale
+// flag, as one JSON document. Returns its length, 0 if it didn't fit.
+size_t formatStatsJson(char* buf, size_t cap);
+
+// True once any source has been fetched live since boot
+bool screensLive();
+
+// Mark a panel showing a restored frame as stale
+void markStaleFrame(int idx);
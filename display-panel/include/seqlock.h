@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+// ============================================
+// Single-writer sequence lock
+// The writer never waits; readers copy the value out and retry
+// if a write overlapped the copy. Suits small, plain structs
+// published by one task and read by others.
+// ============================================
+
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock value must be trivially copyable");
+
+public:
+    // Writer side (one task only)
+    void write(const T& value) {
+        uint32_t seq = _seq.load(std::memory_order_relaxed);
+        _seq.store(seq + 1, std::memory_order_relaxed);     // odd = write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&_value, &value, sizeof(T));
+        _seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // Reader side (any task). Returns the sequence the copy belongs to.
+    uint32_t read(T& out) const {
+        uint32_t before, after;
+        do {
+            before = _seq.load(std::memory_order_acquire);
+            memcpy(&out, &_value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = _seq.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        return before;
+    }
+
+    // Even and unchanged between two calls = nothing was written
+    uint32_t sequence() const { return _seq.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<uint32_t> _seq{0};
+    T _value{};
+};
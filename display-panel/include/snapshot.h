@@ -0,0 +1,22 @@
+#pragma once
+
+// ============================================
+// Warm-start snapshot
+// Last-known metrics (and optionally RLE-compressed panel frames)
+// are saved to the "snapshot" flash partition so the next boot can
+// paint them immediately, marked stale, while WiFi and NTP come up.
+//
+// The partition is split into fixed slots written round-robin;
+// each save erases only the sectors it needs, and the header is
+// written last so a power cut mid-save leaves the previous slot
+// as the newest valid one.
+// ============================================
+
+// Restore the newest valid snapshot. Cached metrics are loaded
+// into the screens (marked stale) and saved frames are submitted
+// straight to their panels. Returns the mask of panels painted
+// from frames, or -1 if there was no valid snapshot.
+int restoreSnapshot();
+
+// Save current metrics (+frames) to the next slot
+void saveSnapshot();
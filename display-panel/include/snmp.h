@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================
+// SNMPv2c GETBULK
+// Builds a GetBulkRequest into a caller buffer and walks the
+// Response in place. Varbinds are handed out as views into the
+// received datagram (OID and value bytes are never copied), so a
+// whole port table costs one UDP round-trip and one packet buffer.
+//
+// Only what the switch poller needs: v2c, no traps, no SET.
+// ============================================
+
+#define SNMP_PORT       161
+#define SNMP_LOCAL_PORT 50161   // replies come back here
+#define SNMP_PACKET_MAX 512     // one GETBULK reply (~16 Counter64 varbinds)
+#define SNMP_MAX_ARCS   16      // sub-identifiers in a request OID
+
+// OID as sub-identifiers, e.g. {1,3,6,1,2,1,31,1,1,1,6}
+struct SnmpOid {
+    const uint32_t* arcs;
+    uint8_t         len;
+};
+
+// BER types seen in varbind values
+enum SnmpType : uint8_t {
+    SNMP_INTEGER        = 0x02,
+    SNMP_OCTET_STRING   = 0x04,
+    SNMP_NULL           = 0x05,
+    SNMP_OID            = 0x06,
+    SNMP_COUNTER32      = 0x41,
+    SNMP_GAUGE32        = 0x42,
+    SNMP_TIMETICKS      = 0x43,
+    SNMP_COUNTER64      = 0x46,
+    SNMP_NO_SUCH_OBJECT = 0x80,
+    SNMP_NO_SUCH_INSTANCE = 0x81,
+    SNMP_END_OF_MIB_VIEW = 0x82,
+};
+
+// One name/value pair, pointing into the response packet
+struct SnmpVarbind {
+    const uint8_t* oid;         // encoded sub-identifiers (no tag/length)
+    uint16_t       oidLen;
+    uint8_t        type;        // SnmpType
+    const uint8_t* value;       // content octets
+    uint16_t       valueLen;
+};
+
+// GetBulkRequest for oids (all repeaters) into buf. Returns its
+// length, 0 if it doesn't fit.
+size_t snmpGetBulk(uint8_t* buf, size_t cap, const char* community, int32_t requestId,
+                   uint8_t maxRepetitions, const SnmpOid* oids, int count);
+
+// Walk a Response: fn is called once per varbind, in packet order.
+// Returns the varbind count, or -1 if the packet is malformed, is
+// not the response to requestId, or carries an error-status.
+typedef void (*SnmpVarbindFn)(void* ctx, const SnmpVarbind& vb);
+int snmpParseResponse(const uint8_t* pkt, size_t len, int32_t requestId,
+                      SnmpVarbindFn fn, void* ctx);
+
+// True if vb's name is column.<index> (a single trailing
+// sub-identifier); the index is stored
+bool snmpColumnIndex(const SnmpVarbind& vb, const SnmpOid& column, uint32_t* index);
+
+// Unsigned value of a Counter32/Gauge32/TimeTicks/Counter64 or
+// non-negative INTEGER; false for anything else
+bool snmpUnsigned(const SnmpVarbind& vb, uint64_t* value);
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "jsondecode.h"
+
+// ============================================
+// /stats replies from the homelab agents, decoded field by field
+// into these structs (see jsondecode.h). Only what the screens use
+// is declared; the rest of each reply is skipped.
+// ============================================
+
+#define STATS_MAX_DRIVES 8
+
+// --- Unraid :9100 ---
+struct UnraidStats {
+    struct Drive {
+        char   device[8];
+        double tempC;
+    };
+    Drive   drives[STATS_MAX_DRIVES];
+    int32_t driveCount;
+    double  storageUsedGB;
+    double  storageTotalGB;
+    double  cpuPercent;
+    double  memPercent;
+    int32_t dockerRunning;
+    int32_t dockerTotal;
+    char    arrayStatus[12];
+};
+
+static const JsonField UNRAID_FIELDS[] = {
+    JSON_ARRAY(UnraidStats, "drives[]", driveCount, drives),
+    JSON_FIELD(UnraidStats, "drives[].device", drives[0].device),
+    JSON_FIELD(UnraidStats, "drives[].temp_c", drives[0].tempC),
+    JSON_FIELD(UnraidStats, "storage.used_gb", storageUsedGB),
+    JSON_FIELD(UnraidStats, "storage.total_gb", storageTotalGB),
+    JSON_FIELD(UnraidStats, "system.cpu_percent", cpuPercent),
+    JSON_FIELD(UnraidStats, "system.mem_percent", memPercent),
+    JSON_FIELD(UnraidStats, "docker.running", dockerRunning),
+    JSON_FIELD(UnraidStats, "docker.total", dockerTotal),
+    JSON_FIELD(UnraidStats, "array_status", arrayStatus),
+};
+static const JsonSchema UNRAID_SCHEMA = JSON_SCHEMA(UNRAID_FIELDS);
+
+// Values used when a field is missing from the reply
+static const UnraidStats UNRAID_DEFAULTS = {
+    .drives = {{"??", 0}, {"??", 0}, {"??", 0}, {"??", 0},
+               {"??", 0}, {"??", 0}, {"??", 0}, {"??", 0}},
+    .driveCount = 0,
+    .storageUsedGB = 0, .storageTotalGB = 0,
+    .cpuPercent = 0, .memPercent = 0,
+    .dockerRunning = 0, .dockerTotal = 0,
+    .arrayStatus = "unknown",
+};
+
+// --- M900 :9300 ---
+struct M900Stats {
+    double cpuPercent;
+    double cpuTempC;
+    double memPercent;
+    double memUsedGB;
+    double memTotalGB;
+    double diskPercent;
+    double diskUsedGB;
+    double diskTotalGB;
+    double bytesSent;       // counters, beyond int32
+    double bytesRecv;
+};
+
+static const JsonField M900_FIELDS[] = {
+    JSON_FIELD(M900Stats, "cpu.percent", cpuPercent),
+    JSON_FIELD(M900Stats, "cpu.temp_c", cpuTempC),
+    JSON_FIELD(M900Stats, "memory.percent", memPercent),
+    JSON_FIELD(M900Stats, "memory.used_gb", memUsedGB),
+    JSON_FIELD(M900Stats, "memory.total_gb", memTotalGB),
+    JSON_FIELD(M900Stats, "disk.percent", diskPercent),
+    JSON_FIELD(M900Stats, "disk.used_gb", diskUsedGB),
+    JSON_FIELD(M900Stats, "disk.total_gb", diskTotalGB),
+    JSON_FIELD(M900Stats, "network.bytes_sent", bytesSent),
+    JSON_FIELD(M900Stats, "network.bytes_recv", bytesRecv),
+};
+static const JsonSchema M900_SCHEMA = JSON_SCHEMA(M900_FIELDS);
+
+// --- Pi agents :9200 ---
+struct PiStats {
+    double tempC;
+    double cpuPercent;
+    double memPercent;
+};
+
+static const JsonField PI_FIELDS[] = {
+    JSON_FIELD(PiStats, "cpu.temp_c", tempC),
+    JSON_FIELD(PiStats, "cpu.percent", cpuPercent),
+    JSON_FIELD(PiStats, "memory.percent", memPercent),
+};
+static const JsonSchema PI_SCHEMA = JSON_SCHEMA(PI_FIELDS);
+
+// --- Pi-hole v6, FTL's REST API ---
+#define STATS_MAX_DNS_CLIENTS 4
+
+// /api/stats/summary; counts cover the last 24 hours. The query
+// type, status and reply breakdowns are skipped unread.
+struct PiholeSummary {
+    double  total;
+    double  blocked;
+    double  forwarded;
+    double  cached;
+    int32_t activeClients;
+};
+
+static const JsonField PIHOLE_SUMMARY_FIELDS[] = {
+    JSON_FIELD(PiholeSummary, "queries.total", total),
+    JSON_FIELD(PiholeSummary, "queries.blocked", blocked),
+    JSON_FIELD(PiholeSummary, "queries.forwarded", forwarded),
+    JSON_FIELD(PiholeSummary, "queries.cached", cached),
+    JSON_FIELD(PiholeSummary, "clients.active", activeClients),
+};
+static const JsonSchema PIHOLE_SUMMARY_SCHEMA = JSON_SCHEMA(PIHOLE_SUMMARY_FIELDS);
+
+// /api/stats/top_clients?count=N, busiest first
+struct PiholeTopClients {
+    struct Client {
+        char   name[16];    // hostname, "" if FTL has none
+        char   ip[40];
+        double count;
+    };
+    Client  clients[STATS_MAX_DNS_CLIENTS];
+    int32_t clientCount;
+};
+
+static const JsonField PIHOLE_CLIENTS_FIELDS[] = {
+    JSON_ARRAY(PiholeTopClients, "clients[]", clientCount, clients),
+    JSON_FIELD(PiholeTopClients, "clients[].name", clients[0].name),
+    JSON_FIELD(PiholeTopClients, "clients[].ip", clients[0].ip),
+    JSON_FIELD(PiholeTopClients, "clients[].count", clients[0].count),
+};
+static const JsonSchema PIHOLE_CLIENTS_SCHEMA = JSON_SCHEMA(PIHOLE_CLIENTS_FIELDS);
+
+// POST /api/auth; sid is null when the API has no password
+struct PiholeAuth {
+    char sid[48];
+};
+
+static const JsonField PIHOLE_AUTH_FIELDS[] = {
+    JSON_FIELD(PiholeAuth, "session.sid", sid),
+};
+static const JsonSchema PIHOLE_AUTH_SCHEMA = JSON_SCHEMA(PIHOLE_AUTH_FIELDS);
@@ -0,0 +1,23 @@
+#pragma once
+
+// ============================================
+// Cached-metrics HTTP endpoint
+// Serves everything the panel has already fetched as one JSON
+// document (GET /stats) so other consumers, like the web
+// dashboard, read it from here instead of polling every machine
+// again. Each source carries its fetch time and a stale flag;
+// responses carry an ETag and answer If-None-Match with 304.
+//
+// The server runs in its own task on core 0 below the flush
+// task, with a fixed socket limit and static buffers. The loop
+// only re-renders the document and publishes it through a
+// seqlock, so a slow client can never hold up a frame.
+// ============================================
+
+// Start the HTTP server once the link is up and WiFiManager's
+// portal, which also listens on port 80, is closed
+void startStatsServer();
+
+// Re-render the document from the cached values and publish it.
+// Loop task only; call after a fetch.
+void publishStats();
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "config.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================
+// Event tracing
+// Begin/end events with microsecond timestamps and the core they
+// ran on, recorded into a fixed lock-free ring (newest events
+// overwrite the oldest). Dump it as Chrome trace JSON and open it
+// in chrome://tracing or ui.perfetto.dev to see how loop phases,
+// fetches, draws and SPI flushes overlap across the two cores.
+//
+// Build with -DTRACE_ENABLED=1. With it 0 (the default) every
+// TRACE_* macro expands to nothing and the ring doesn't exist.
+//
+// Names must be string literals: only the pointer is stored.
+// ============================================
+
+#if TRACE_ENABLED
+
+// phase: 'B' begin, 'E' end, 'i' instant. arg < 0 = none
+// (otherwise shown as args.id, e.g. the panel or service index)
+void traceEvent(const char* name, char phase, int arg = -1);
+
+// Writes the ring as {"traceEvents":[...]} through out, in pieces
+typedef void (*TraceWriter)(void* ctx, const char* data, size_t len);
+void traceDump(TraceWriter out, void* ctx);
+
+class TraceScope {
+public:
+    TraceScope(const char* name, int arg = -1) : _name(name), _arg(arg) {
+        traceEvent(name, 'B', arg);
+    }
+    ~TraceScope() { traceEvent(_name, 'E', _arg); }
+
+private:
+    const char* _name;
+    int         _arg;
+};
+
+#define TRACE_CAT_(a, b) a##b
+#define TRACE_CAT(a, b)  TRACE_CAT_(a, b)
+
+#define TRACE_BEGIN(name)           traceEvent(name, 'B')
+#define TRACE_END(name)             traceEvent(name, 'E')
+#define TRACE_INSTANT(name)         traceEvent(name, 'i')
+#define TRACE_SCOPE(name)           TraceScope TRACE_CAT(_trace, __LINE__)(name)
+#define TRACE_SCOPE_ARG(name, arg)  TraceScope TRACE_CAT(_trace, __LINE__)(name, arg)
+
+#else
+
+#define TRACE_BEGIN(name)           ((void)0)
+#define TRACE_END(name)             ((void)0)
+#define TRACE_INSTANT(name)         ((void)0)
+#define TRACE_SCOPE(name)           ((void)0)
+#define TRACE_SCOPE_ARG(name, arg)  ((void)0)
+
+#endif
@@ -0,0 +1,407 @@
+#include "adsb.h"
+#include "seqlock.h"
+#include <math.h>
+#include <string.h>
+
+// ============================================
+// Tables (flash)
+// ============================================
+
+// CRC-24, generator 0xFFF409, one entry per leading byte
+static const uint32_t crcTable[256] = {
+    0x000000, 0xFFF409, 0x001C1B, 0xFFE812, 0x003836, 0xFFCC3F, 0x00242D, 0xFFD024,
+    0x00706C, 0xFF8465, 0x006C77, 0xFF987E, 0x00485A, 0xFFBC53, 0x005441, 0xFFA048,
+    0x00E0D8, 0xFF14D1, 0x00FCC3, 0xFF08CA, 0x00D8EE, 0xFF2CE7, 0x00C4F5, 0xFF30FC,
+    0x0090B4, 0xFF64BD, 0x008CAF, 0xFF78A6, 0x00A882, 0xFF5C8B, 0x00B499, 0xFF4090,
+    0x01C1B0, 0xFE35B9, 0x01DDAB, 0xFE29A2, 0x01F986, 0xFE0D8F, 0x01E59D, 0xFE1194,
+    0x01B1DC, 0xFE45D5, 0x01ADC7, 0xFE59CE, 0x0189EA, 0xFE7DE3, 0x0195F1, 0xFE61F8,
+    0x012168, 0xFED561, 0x013D73, 0xFEC97A, 0x01195E, 0xFEED57, 0x010545, 0xFEF14C,
+    0x015104, 0xFEA50D, 0x014D1F, 0xFEB916, 0x016932, 0xFE9D3B, 0x017529, 0xFE8120,
+    0x038360, 0xFC7769, 0x039F7B, 0xFC6B72, 0x03BB56, 0xFC4F5F, 0x03A74D, 0xFC5344,
+    0x03F30C, 0xFC0705, 0x03EF17, 0xFC1B1E, 0x03CB3A, 0xFC3F33, 0x03D721, 0xFC2328,
+    0x0363B8, 0xFC97B1, 0x037FA3, 0xFC8BAA, 0x035B8E, 0xFCAF87, 0x034795, 0xFCB39C,
+    0x0313D4, 0xFCE7DD, 0x030FCF, 0xFCFBC6, 0x032BE2, 0xFCDFEB, 0x0337F9, 0xFCC3F0,
+    0x0242D0, 0xFDB6D9, 0x025ECB, 0xFDAAC2, 0x027AE6, 0xFD8EEF, 0x0266FD, 0xFD92F4,
+    0x0232BC, 0xFDC6B5, 0x022EA7, 0xFDDAAE, 0x020A8A, 0xFDFE83, 0x021691, 0xFDE298,
+    0x02A208, 0xFD5601, 0x02BE13, 0xFD4A1A, 0x029A3E, 0xFD6E37, 0x028625, 0xFD722C,
+    0x02D264, 0xFD266D, 0x02CE7F, 0xFD3A76, 0x02EA52, 0xFD1E5B, 0x02F649, 0xFD0240,
+    0x0706C0, 0xF8F2C9, 0x071ADB, 0xF8EED2, 0x073EF6, 0xF8CAFF, 0x0722ED, 0xF8D6E4,
+    0x0776AC, 0xF882A5, 0x076AB7, 0xF89EBE, 0x074E9A, 0xF8BA93, 0x075281, 0xF8A688,
+    0x07E618, 0xF81211, 0x07FA03, 0xF80E0A, 0x07DE2E, 0xF82A27, 0x07C235, 0xF8363C,
+    0x079674, 0xF8627D, 0x078A6F, 0xF87E66, 0x07AE42, 0xF85A4B, 0x07B259, 0xF84650,
+    0x06C770, 0xF93379, 0x06DB6B, 0xF92F62, 0x06FF46, 0xF90B4F, 0x06E35D, 0xF91754,
+    0x06B71C, 0xF94315, 0x06AB07, 0xF95F0E, 0x068F2A, 0xF97B23, 0x069331, 0xF96738,
+    0x0627A8, 0xF9D3A1, 0x063BB3, 0xF9CFBA, 0x061F9E, 0xF9EB97, 0x060385, 0xF9F78C,
+    0x0657C4, 0xF9A3CD, 0x064BDF, 0xF9BFD6, 0x066FF2, 0xF99BFB, 0x0673E9, 0xF987E0,
+    0x0485A0, 0xFB71A9, 0x0499BB, 0xFB6DB2, 0x04BD96, 0xFB499F, 0x04A18D, 0xFB5584,
+    0x04F5CC, 0xFB01C5, 0x04E9D7, 0xFB1DDE, 0x04CDFA, 0xFB39F3, 0x04D1E1, 0xFB25E8,
+    0x046578, 0xFB9171, 0x047963, 0xFB8D6A, 0x045D4E, 0xFBA947, 0x044155, 0xFBB55C,
+    0x041514, 0xFBE11D, 0x04090F, 0xFBFD06, 0x042D22, 0xFBD92B, 0x043139, 0xFBC530,
+    0x054410, 0xFAB019, 0x05580B, 0xFAAC02, 0x057C26, 0xFA882F, 0x05603D, 0xFA9434,
+    0x05347C, 0xFAC075, 0x052867, 0xFADC6E, 0x050C4A, 0xFAF843, 0x051051, 0xFAE458,
+    0x05A4C8, 0xFA50C1, 0x05B8D3, 0xFA4CDA, 0x059CFE, 0xFA68F7, 0x0580E5, 0xFA74EC,
+    0x05D4A4, 0xFA20AD, 0x05C8BF, 0xFA3CB6, 0x05EC92, 0xFA189B, 0x05F089, 0xFA0480,
+};
+
+// Latitudes where the number of longitude zones drops from 59, 58, ... 2
+static const float nlTransitions[58] = {
+    10.47047130f, 14.82817437f, 18.18626357f, 21.02939493f, 23.54504487f, 25.82924707f,
+    27.93898710f, 29.91135686f, 31.77209708f, 33.53993436f, 35.22899598f, 36.85025108f,
+    38.41241892f, 39.92256684f, 41.38651832f, 42.80914012f, 44.19454951f, 45.54626723f,
+    46.86733252f, 48.16039128f, 49.42776439f, 50.67150166f, 51.89342469f, 53.09516153f,
+    54.27817472f, 55.44378444f, 56.59318756f, 57.72747354f, 58.84763776f, 59.95459277f,
+    61.04917774f, 62.13216659f, 63.20427479f, 64.26616523f, 65.31845310f, 66.36171008f,
+    67.39646774f, 68.42322022f, 69.44242631f, 70.45451075f, 71.45986473f, 72.45884545f,
+    73.45177442f, 74.43893416f, 75.42056257f, 76.39684391f, 77.36789461f, 78.33374083f,
+    79.29428225f, 80.24923213f, 81.19801349f, 82.13956981f, 83.07199445f, 83.99173563f,
+    84.89166191f, 85.75541621f, 86.53536998f, 87.00000000f,
+};
+
+static const char callsignChars[] =
+    "#ABCDEFGHIJKLMNOPQRSTUVWXYZ##### ###############0123456789######";
+
+uint32_t adsbCrc(const uint8_t* msg, int len) {
+    uint32_t crc = 0;
+    for (int i = 0; i < len; i++) {
+        crc = ((crc << 8) ^ crcTable[((crc >> 16) ^ msg[i]) & 0xFF]) & 0xFFFFFF;
+    }
+    return crc;
+}
+
+// ============================================
+// CPR (compact position reporting), airborne format
+// ============================================
+#define CPR_SCALE 131072.0f     // 2^17
+
+static int cprNL(float lat) {
+    lat = fabsf(lat);
+    for (int i = 0; i < 58; i++) {
+        if (lat < nlTransitions[i]) return 59 - i;
+    }
+    return 1;
+}
+
+// Non-negative remainder
+static float cprMod(float a, float b) {
+    float r = fmodf(a, b);
+    return r < 0 ? r + b : r;
+}
+
+// Both parities within ADSB_CPR_PAIR_MS: unambiguous anywhere on
+// Earth. The newer frame's zone decides the longitude.
+static bool cprGlobal(const AdsbAircraft& a, int newest, float* lat, float* lon) {
+    float latE = a.cprLat[0] / CPR_SCALE, latO = a.cprLat[1] / CPR_SCALE;
+    float lonE = a.cprLon[0] / CPR_SCALE, lonO = a.cprLon[1] / CPR_SCALE;
+
+    float j = floorf(59 * latE - 60 * latO + 0.5f);
+    float rlatE = (360.0f / 60) * (cprMod(j, 60) + latE);
+    float rlatO = (360.0f / 59) * (cprMod(j, 59) + latO);
+    if (rlatE >= 270) rlatE -= 360;
+    if (rlatO >= 270) rlatO -= 360;
+    if (cprNL(rlatE) != cprNL(rlatO)) return false;     // straddles a zone boundary
+
+    float rlat = newest ? rlatO : rlatE;
+    int nl = cprNL(rlat);
+    int ni = nl - newest;
+    if (ni < 1) ni = 1;
+    float m = floorf(lonE * (nl - 1) - lonO * nl + 0.5f);
+    float rlon = (360.0f / ni) * (cprMod(m, ni) + (newest ? lonO : lonE));
+    if (rlon >= 180) rlon -= 360;
+
+    *lat = rlat;
+    *lon = rlon;
+    return true;
+}
+
+// One frame, resolved against a nearby reference (the aircraft's
+// last fix): good while the reference is within half a zone
+static void cprLocal(float refLat, float refLon, int odd, uint32_t latCpr, uint32_t lonCpr,
+                     float* lat, float* lon) {
+    float dLat = 360.0f / (odd ? 59 : 60);
+    float x = latCpr / CPR_SCALE;
+    float j = floorf(refLat / dLat) + floorf(cprMod(refLat, dLat) / dLat - x + 0.5f);
+    float rlat = dLat * (j + x);
+
+    int ni = cprNL(rlat) - odd;
+    if (ni < 1) ni = 1;
+    float dLon = 360.0f / ni;
+    float y = lonCpr / CPR_SCALE;
+    float m = floorf(refLon / dLon) + floorf(cprMod(refLon, dLon) / dLon - y + 0.5f);
+
+    *lat = rlat;
+    *lon = dLon * (m + y);
+}
+
+// ============================================
+// Aircraft table
+// Linear probing from a Fibonacci hash of the address; removal
+// shifts the rest of the chain back, so there are no tombstones
+// and lookups never scan more than the chain they belong to
+// ============================================
+static uint32_t home(uint32_t icao) {
+    return (icao * 2654435769u) >> (32 - ADSB_TABLE_BITS);
+}
+
+void AdsbDecoder::begin(float rxLat, float rxLon) {
+    memset(_table, 0, sizeof(_table));
+    _count = 0;
+    _stats = {};
+    _rxLat = rxLat;
+    _rxLon = rxLon;
+    _need = _got = 0;
+    _escape = false;
+}
+
+AdsbAircraft* AdsbDecoder::slot(uint32_t icao, bool insert, uint32_t nowMs) {
+    for (uint32_t i = home(icao);; i = (i + 1) & (ADSB_MAX_AIRCRAFT - 1)) {
+        AdsbAircraft& a = _table[i];
+        if (a.icao == icao) return &a;
+        if (a.icao != 0) continue;
+
+        if (!insert) return nullptr;
+        if (_count >= ADSB_MAX_LOAD) {
+            _stats.tableFull++;
+            return nullptr;
+        }
+        memset(&a, 0, sizeof(a));
+        a.icao = icao;
+        a.seenMs = nowMs;
+        _count++;
+        return &a;
+    }
+}
+
+const AdsbAircraft* AdsbDecoder::find(uint32_t icao) const {
+    return const_cast<AdsbDecoder*>(this)->slot(icao, false, 0);
+}
+
+void AdsbDecoder::remove(AdsbAircraft* a) {
+    const uint32_t mask = ADSB_MAX_AIRCRAFT - 1;
+    uint32_t hole = a - _table;
+    for (uint32_t i = (hole + 1) & mask; _table[i].icao; i = (i + 1) & mask) {
+        // Move back any entry whose home isn't between the hole and it
+        uint32_t h = home(_table[i].icao);
+        if (((i - h) & mask) >= ((i - hole) & mask)) {
+            _table[hole] = _table[i];
+            hole = i;
+        }
+    }
+    _table[hole].icao = 0;
+    _count--;
+}
+
+void AdsbDecoder::expire(uint32_t nowMs) {
+    // Removal can shift a later entry into the current slot, so
+    // re-check it before moving on
+    for (int i = 0; i < ADSB_MAX_AIRCRAFT;) {
+        AdsbAircraft& a = _table[i];
+        if (a.icao && nowMs - a.seenMs > ADSB_AGE_MS) {
+            remove(&a);
+        } else {
+            i++;
+        }
+    }
+}
+
+bool AdsbDecoder::inRange(float lat, float lon) const {
+    float dy = (lat - _rxLat) * 60;
+    float dx = (lon - _rxLon) * 60 * cosf(_rxLat * (float)M_PI / 180);
+    return dx * dx + dy * dy <= (float)ADSB_MAX_RANGE_NM * ADSB_MAX_RANGE_NM;
+}
+
+void AdsbDecoder::position(AdsbAircraft& a, int odd, uint32_t latCpr, uint32_t lonCpr,
+                           uint32_t nowMs) {
+    a.cprLat[odd] = latCpr;
+    a.cprLon[odd] = lonCpr;
+    a.cprMs[odd] = nowMs;
+
+    float lat, lon;
+    bool ok;
+    if (a.posMs && nowMs - a.posMs < ADSB_AGE_MS) {
+        cprLocal(a.lat, a.lon, odd, latCpr, lonCpr, &lat, &lon);
+        ok = fabsf(lat - a.lat) < 1 && fabsf(lon - a.lon) < 1.5f;   // well inside half a zone
+    } else {
+        int other = odd ^ 1;
+        ok = a.cprMs[other] && nowMs - a.cprMs[other] <= ADSB_CPR_PAIR_MS &&
+             cprGlobal(a, odd, &lat, &lon);
+    }
+    if (!ok || !inRange(lat, lon)) return;
+
+    a.lat = lat;
+    a.lon = lon;
+    a.posMs = nowMs;
+    _stats.positions++;
+}
+
+// ============================================
+// Extended squitter
+// ME field bits are numbered 1..56 as in the spec
+// ============================================
+static inline uint32_t meBits(uint64_t me, int first, int count) {
+    return (uint32_t)(me >> (56 - first - count + 1)) & ((1u << count) - 1);
+}
+
+bool AdsbDecoder::apply(const uint8_t* msg, int len, uint32_t nowMs) {
+    int df = msg[0] >> 3;
+    if (len != 14 || (df != 17 && df != 18)) return false;
+    if (df == 18 && (msg[0] & 7) > 1) return false;     // TIS-B / rebroadcast: no real address
+    if (adsbCrc(msg, 14) != 0) {
+        _stats.badCrc++;
+        return false;
+    }
+
+    uint32_t icao = (uint32_t)msg[1] << 16 | msg[2] << 8 | msg[3];
+    AdsbAircraft* a = slot(icao, true, nowMs);
+    if (!a) return false;
+    a->seenMs = nowMs;
+    a->messages++;
+    _stats.applied++;
+
+    uint64_t me = 0;
+    for (int i = 4; i < 11; i++) me = me << 8 | msg[i];
+    int tc = meBits(me, 1, 5);
+
+    if (tc >= 1 && tc <= 4) {
+        // Identification: eight 6-bit characters
+        int n = 0;
+        for (int i = 0; i < 8; i++) {
+            char c = callsignChars[meBits(me, 9 + 6 * i, 6)];
+            if (c != '#') a->callsign[n++] = c;
+        }
+        while (n && a->callsign[n - 1] == ' ') n--;
+        a->callsign[n] = '\0';
+        a->flags |= ADSB_HAS_CALLSIGN;
+    } else if ((tc >= 9 && tc <= 18) || (tc >= 20 && tc <= 22)) {
+        // Airborne position
+        uint32_t alt = meBits(me, 9, 12);
+        if (tc <= 18 && (alt & 0x10)) {
+            // 25 ft steps, Q bit removed (Gillham-coded 100 ft steps are left out)
+            a->altFt = (int32_t)(((alt >> 1) & 0x7F0) | (alt & 0xF)) * 25 - 1000;
+            a->flags |= ADSB_HAS_ALT;
+        } else if (tc >= 20 && alt) {
+            a->altFt = (int32_t)(alt * 3.28084f);       // GNSS height, metres
+            a->flags |= ADSB_HAS_ALT;
+        }
+        position(*a, meBits(me, 22, 1), meBits(me, 23, 17), meBits(me, 40, 17), nowMs);
+    } else if (tc == 19) {
+        // Velocity over ground (subtypes 1, 2 = supersonic)
+        int st = meBits(me, 6, 3);
+        if (st == 1 || st == 2) {
+            int vew = meBits(me, 15, 10), vns = meBits(me, 26, 10);
+            if (vew && vns) {
+                int scale = (st == 2) ? 4 : 1;
+                float ve = (vew - 1) * scale * (meBits(me, 14, 1) ? -1 : 1);
+                float vn = (vns - 1) * scale * (meBits(me, 25, 1) ? -1 : 1);
+                a->gsKt = (uint16_t)(sqrtf(ve * ve + vn * vn) + 0.5f);
+                float track = atan2f(ve, vn) * 180 / (float)M_PI;
+                a->track = (uint16_t)(cprMod(track + 0.5f, 360));
+                a->flags |= ADSB_HAS_VELOCITY;
+            }
+        }
+        int vr = meBits(me, 38, 9);
+        if (vr) a->vrateFpm = (int16_t)((vr - 1) * 64 * (meBits(me, 37, 1) ? -1 : 1));
+    }
+    return true;
+}
+
+// ============================================
+// Beast framing
+// <1A> <type> <6-byte timestamp> <signal> <message>, with every
+// 1A inside the frame doubled. A lone 1A mid-frame means bytes
+// were lost: that frame is dropped and the 1A starts the next.
+// ============================================
+static uint8_t beastLength(uint8_t type) {
+    switch (type) {
+    case '1': return 7 + 2;     // Mode A/C
+    case '2': return 7 + 7;     // Mode S short
+    case '3': return 7 + 14;    // Mode S long
+    default:  return 0;
+    }
+}
+
+void AdsbDecoder::feed(const uint8_t* data, size_t len, uint32_t nowMs) {
+    for (size_t i = 0; i < len; i++) {
+        uint8_t b = data[i];
+
+        if (_escape) {
+            _escape = false;
+            if (b != 0x1A) {
+                // Frame start (mid-frame: the current one is lost)
+                if (_need) _stats.resyncs++;
+                _need = beastLength(b);
+                _got = 0;
+                continue;
+            }
+            if (!_need) continue;       // escaped 1A while hunting
+        } else if (b == 0x1A) {
+            _escape = true;
+            continue;
+        } else if (!_need) {
+            continue;                   // hunting for a frame start
+        }
+
+        _frame[_got++] = b;
+        if (_got == _need) {
+            int msgLen = _need - 7;
+            if (msgLen != 2) {
+                _stats.frames++;
+                apply(_frame + 7, msgLen, nowMs);
+            }
+            _need = 0;
+        }
+    }
+}
+
+// ============================================
+// Radar view
+// Insertion into a distance-ordered list; with at most
+// ADSB_MAX_LOAD candidates this costs well under a millisecond
+// every publish
+// ============================================
+static Seqlock<RadarView> radar;
+static RadarView building;      // feed task only
+
+void adsbPublish(const AdsbDecoder& dec, float rangeNm, uint32_t msgsPerSec, bool connected,
+                 uint32_t nowMs) {
+    RadarView& v = building;
+    float dist[RADAR_MAX_BLIPS];
+    float kx = 60 * cosf(dec.rxLat() * (float)M_PI / 180);
+    int n = 0;
+
+    dec.forEach([&](const AdsbAircraft& a) {
+        if (!a.posMs) return;
+        float east = (a.lon - dec.rxLon()) * kx;
+        float north = (a.lat - dec.rxLat()) * 60;
+        float d = east * east + north * north;
+        if (d > rangeNm * rangeNm) return;
+
+        int at = n;
+        while (at > 0 && dist[at - 1] > d) at--;
+        if (at == RADAR_MAX_BLIPS) return;
+        int last = (n < RADAR_MAX_BLIPS) ? n++ : n - 1;
+        for (int i = last; i > at; i--) {
+            dist[i] = dist[i - 1];
+            v.blips[i] = v.blips[i - 1];
+        }
+
+        RadarBlip& b = v.blips[at];
+        dist[at] = d;
+        b.eastNm = east;
+        b.northNm = north;
+        b.altFt = a.altFt;
+        b.track = a.track;
+        b.posAgeS = (uint16_t)((nowMs - a.posMs) / 1000);
+        b.flags = a.flags;
+        memcpy(b.callsign, a.callsign, sizeof(b.callsign));
+    });
+
+    v.msgsPerSec = msgsPerSec;
+    v.aircraft = (uint16_t)dec.count();
+    v.connected = connected;
+    v.blipCount = (uint8_t)n;
+    radar.write(v);
+}
+
+void adsbRead(RadarView& out) {
+    radar.read(out);
+}
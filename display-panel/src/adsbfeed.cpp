@@ -0,0 +1,63 @@
+#include "adsbfeed.h"
+#include "adsb.h"
+#include "config.h"
+#include "trace.h"
+#include <Arduino.h>
+#include <WiFi.h>
+
+static AdsbDecoder decoder;     // feed task only
+
+// ============================================
+// Feed task (core 0)
+// Drains the socket every few milliseconds: readsb at a busy
+// airport is ~50 KB/s, well inside what one 1 KB read per pass
+// keeps up with, and lwIP's receive window covers the gaps
+// ============================================
+static void feedLoop(void*) {
+    static uint8_t buf[ADSB_READ_CHUNK];
+    WiFiClient client;
+    uint32_t lastConnect = 0, lastPublish = 0;
+    uint32_t windowStart = millis(), windowFrames = 0, rate = 0;
+
+    decoder.begin(RADAR_LAT, RADAR_LON);
+
+    for (;;) {
+        uint32_t now = millis();
+
+        if (!client.connected()) {
+            if (WiFi.status() == WL_CONNECTED && (!lastConnect || now - lastConnect >= ADSB_RETRY_MS)) {
+                lastConnect = now;
+                if (client.connect(ADSB_HOST, ADSB_BEAST_PORT, 2000)) {
+                    client.setNoDelay(true);
+                    Serial.printf("ADS-B: connected to %s:%d\n", ADSB_HOST, ADSB_BEAST_PORT);
+                }
+            }
+        } else {
+            int avail;
+            while ((avail = client.available()) > 0) {
+                TRACE_SCOPE("adsb");
+                int n = client.read(buf, min(avail, (int)sizeof(buf)));
+                if (n <= 0) break;
+                decoder.feed(buf, n, millis());
+            }
+        }
+
+        if (now - lastPublish >= ADSB_PUBLISH_MS) {
+            lastPublish = now;
+            if (now - windowStart >= 1000) {
+                uint32_t frames = decoder.stats().frames;
+                rate = (frames - windowFrames) * 1000 / (now - windowStart);
+                windowFrames = frames;
+                windowStart = now;
+            }
+            decoder.expire(now);
+            adsbPublish(decoder, RADAR_RANGE_NM, rate, client.connected(), now);
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(ADSB_POLL_MS));
+    }
+}
+
+void startAdsbFeed() {
+    xTaskCreatePinnedToCore(feedLoop, "adsb", 4096, nullptr, 1, nullptr, 0);
+}
@@ -6,21 +6,297 @@ static const int cs_pins[NUM_DISPLAYS] = {
 };
 
 LGFX_GC9A01* displays[NUM_DISPLAYS];
+LGFX_Sprite* frames[NUM_DISPLAYS];
+RowSpan      visibleSpans[DISPLAY_HEIGHT];
+
+// ============================================
+// Round-glass mask
+// A pixel counts as visible if any part of it is inside the
+// circle; spans are widened to even x so 4bpp rows stay
+// byte-aligned. Drops ~21% of every full-frame transfer.
+// ============================================
+static void buildSpans() {
+    const float r = DISPLAY_WIDTH / 2.0f;
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        float dy = fabsf(y + 0.5f - DISPLAY_HEIGHT / 2.0f) - 0.5f;
+        if (dy < 0) dy = 0;
+        float half = dy < r ? sqrtf(r * r - dy * dy) : 0;
+        int x0 = (int)floorf(r - half) & ~1;
+        int x1 = ((int)ceilf(r + half) + 1) & ~1;
+        x0 = constrain(x0, 0, DISPLAY_WIDTH);
+        x1 = constrain(x1, x0, DISPLAY_WIDTH);
+        visibleSpans[y] = {(uint8_t)x0, (uint8_t)(x1 - x0)};
+    }
+}
+
+void fillVisible(lgfx::LovyanGFX* d, uint32_t color) {
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        const RowSpan& s = visibleSpans[y];
+        if (s.w) d->fillRect(s.x0, y, s.w, 1, color);
+    }
+}
+
+bool clipToVisible(int& x, int& y, int& w, int& h) {
+    int x1 = min(x + w, DISPLAY_WIDTH), y1 = min(y + h, DISPLAY_HEIGHT);
+    int nx0 = DISPLAY_WIDTH, nx1 = 0, ny0 = -1, ny1 = -1;
+    for (int row = max(y, 0); row < y1; row++) {
+        const RowSpan& s = visibleSpans[row];
+        int a = max(x, (int)s.x0), b = min(x1, s.x0 + s.w);
+        if (a >= b) continue;
+        if (ny0 < 0) ny0 = row;
+        ny1 = row + 1;
+        nx0 = min(nx0, a);
+        nx1 = max(nx1, b);
+    }
+    if (ny0 < 0) return false;
+    x = nx0;
+    y = ny0;
+    w = nx1 - nx0;
+    h = ny1 - ny0;
+    return true;
+}
+
+// ============================================
+// Palette expansion tables (byte-swapped RGB565, as the panel
+// takes it). At 4bpp one framebuffer byte is two pixels, so the
+// table maps a whole byte to a pixel pair in one lookup.
+// ============================================
+#if FRAME_DEPTH == 4
+static_assert(PAL_COUNT <= 16, "4bpp framebuffers hold at most 16 colours");
+static uint32_t expandLut[256];
+#elif FRAME_DEPTH == 8
+static uint16_t expandLut[256];
+#else
+#error "FRAME_DEPTH must be 4 or 8"
+#endif
+
+// Two line buffers: one is expanded while the other is on the bus
+static uint16_t lineBuf[2][FLUSH_LINES * DISPLAY_WIDTH];
+
+static uint16_t swapped(int idx) {
+    uint16_t c = idx < PAL_COUNT ? PALETTE[idx] : 0;
+    return (c >> 8) | (c << 8);
+}
+
+static void buildExpandLut() {
+    for (int b = 0; b < 256; b++) {
+#if FRAME_DEPTH == 4
+        // First pixel lives in the high nibble
+        expandLut[b] = swapped(b >> 4) | ((uint32_t)swapped(b & 0x0F) << 16);
+#else
+        expandLut[b] = swapped(b);
+#endif
+    }
+}
 
 void initDisplays() {
+    buildExpandLut();
+    buildSpans();
+
     for (int i = 0; i < NUM_DISPLAYS; i++) {
         displays[i] = new LGFX_GC9A01(cs_pins[i]);
         displays[i]->init();
         displays[i]->setRotation(0);
         displays[i]->setBrightness(200);
-        displays[i]->fillScreen(TFT_BLACK);
-        displays[i]->setTextColor(TFT_WHITE, TFT_BLACK);
-        displays[i]->setTextDatum(middle_center);
+
+        // Palette-indexed, so all six fit in internal RAM. A bare 8
+        // would be rgb332: LovyanGFX only adds a palette below 8 bits
+        frames[i] = new LGFX_Sprite(displays[i]);
+        frames[i]->setPsram(false);
+        frames[i]->setColorDepth(FRAME_DEPTH == 8 ? lgfx::palette_8bit : lgfx::palette_4bit);
+        if (!frames[i]->createSprite(DISPLAY_WIDTH, DISPLAY_HEIGHT)) {
+            Serial.printf("Framebuffer %d alloc failed\n", i);
+        }
+        frames[i]->fillScreen(PAL_BLACK);
+        frames[i]->setTextColor(PAL_WHITE, PAL_BLACK);
+        frames[i]->setTextDatum(middle_center);
     }
+
+    // One black clear for all six
+    fillVisible(beginBroadcast(PANEL_MASK_ALL), TFT_BLACK);
+    endBroadcast();
 }
 
 void clearDisplay(int idx, uint32_t color) {
     if (idx >= 0 && idx < NUM_DISPLAYS) {
-        displays[idx]->fillScreen(color);
+        frames[idx]->fillScreen(color);
+    }
+}
+
+// Expand w pixels (palette indices at src) into out
+static void expandSpan(const uint8_t* src, uint16_t* out, int w) {
+    int bytes = w * FRAME_DEPTH / 8;
+#if FRAME_DEPTH == 4
+    uint32_t* o = (uint32_t*)out;
+    for (int i = 0; i < bytes; i++) o[i] = expandLut[src[i]];
+#else
+    for (int i = 0; i < bytes; i++) out[i] = expandLut[src[i]];
+#endif
+}
+
+// Row's visible part inside [rx0, rx1), kept 2-pixel aligned
+static void rowChord(int row, int rx0, int rx1, int& x0, int& x1) {
+    const RowSpan& s = visibleSpans[row];
+    x0 = max(rx0 & ~1, (int)s.x0);
+    x1 = min((rx1 + 1) & ~1, s.x0 + s.w);
+}
+
+// ============================================
+// Broadcast
+// The lead panel (lowest bit of the mask) drives the bus through
+// LovyanGFX, which asserts its own CS; the others are pulled low
+// by hand for the duration.
+//
+// LovyanGFX skips CASET/RASET when a window's columns or rows
+// match the last ones it sent to that panel, and each panel's
+// driver only knows its own history. Two throwaway windows that
+// differ on both axes put every panel in the mask on the same
+// window first, and afterwards each follower gets the same so its
+// driver's record is true again. ~22 bytes a panel.
+// ============================================
+static uint8_t broadcastMask = 0;
+static int     broadcastLead = 0;
+
+static void syncWindow(LGFX_GC9A01* d) {
+    d->setAddrWindow(0, 0, 1, 1);
+    d->setAddrWindow(1, 1, 1, 1);
+}
+
+LGFX_GC9A01* beginBroadcast(uint8_t mask) {
+    broadcastMask = mask & PANEL_MASK_ALL;
+    broadcastLead = __builtin_ctz(broadcastMask | (1 << NUM_DISPLAYS));
+    if (broadcastLead == NUM_DISPLAYS) return nullptr;
+
+    auto* d = displays[broadcastLead];
+    d->startWrite();
+    for (int i = broadcastLead + 1; i < NUM_DISPLAYS; i++) {
+        if (broadcastMask & (1 << i)) digitalWrite(cs_pins[i], LOW);
+    }
+    syncWindow(d);
+    return d;
+}
+
+void endBroadcast() {
+    if (!broadcastMask) return;
+    auto* d = displays[broadcastLead];
+    d->waitDMA();
+    for (int i = broadcastLead + 1; i < NUM_DISPLAYS; i++) {
+        if (broadcastMask & (1 << i)) digitalWrite(cs_pins[i], HIGH);
+    }
+    d->endWrite();
+
+    for (int i = broadcastLead + 1; i < NUM_DISPLAYS; i++) {
+        if (!(broadcastMask & (1 << i))) continue;
+        displays[i]->startWrite();
+        syncWindow(displays[i]);
+        displays[i]->endWrite();
+    }
+    broadcastMask = 0;
+}
+
+// Push an area of frames[srcIdx] through d, each row cut to its
+// visible chord unless fullWidth
+static void pushArea(LGFX_GC9A01* d, int srcIdx, int x, int y, int w, int h, bool fullWidth) {
+    const uint8_t* src = (const uint8_t*)frames[srcIdx]->getBuffer();
+    const int rowBytes = DISPLAY_WIDTH * FRAME_DEPTH / 8;
+    const int cap = FLUSH_LINES * DISPLAY_WIDTH;
+    const int yEnd = y + h;
+
+    // One address window per run of rows sharing the same chord;
+    // each run streams through the two line buffers
+    int flip = 0;
+    int row = y;
+    while (row < yEnd) {
+        int x0 = x, x1 = x + w;
+        int runEnd = yEnd;
+        if (!fullWidth) {
+            rowChord(row, x, x + w, x0, x1);
+            for (runEnd = row + 1; runEnd < yEnd; runEnd++) {
+                int a, b;
+                rowChord(runEnd, x, x + w, a, b);
+                if (a != x0 || b != x1) break;
+            }
+        }
+
+        int cw = x1 - x0;
+        if (cw <= 0) {
+            row = runEnd;
+            continue;
+        }
+
+        d->setAddrWindow(x0, row, cw, runEnd - row);
+        int rowsPerChunk = cap / cw;
+        while (row < runEnd) {
+            int rows = min(rowsPerChunk, runEnd - row);
+            uint16_t* out = lineBuf[flip];
+            for (int r = 0; r < rows; r++) {
+                expandSpan(src + (row + r) * rowBytes + x0 * FRAME_DEPTH / 8, out + r * cw, cw);
+            }
+            // Waits for the previous chunk's DMA, then starts this one
+            d->pushPixelsDMA(out, rows * cw, false);
+            flip ^= 1;
+            row += rows;
+        }
+    }
+    d->waitDMA();
+}
+
+void flushRectTo(uint8_t mask, int srcIdx, int x, int y, int w, int h) {
+    mask &= PANEL_MASK_ALL;
+    if (!mask || !clipToVisible(x, y, w, h)) return;
+
+    // A single panel needs none of the broadcast bookkeeping
+    bool single = !(mask & (mask - 1));
+    LGFX_GC9A01* d;
+    if (single) {
+        d = displays[__builtin_ctz(mask)];
+        d->startWrite();
+    } else {
+        d = beginBroadcast(mask);
+    }
+    pushArea(d, srcIdx, x, y, w, h, false);
+    if (single) d->endWrite();
+    else endBroadcast();
+}
+
+void flushRect(int idx, int x, int y, int w, int h) {
+    flushRectTo(1 << idx, idx, x, y, w, h);
+}
+
+void flushFrameTo(uint8_t mask, int src) {
+    flushRectTo(mask, src, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+}
+
+void flushFrame(int idx) {
+    flushRect(idx, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+}
+
+// ============================================
+// Vertical scroll
+// ============================================
+static PanelScroll panelScroll[NUM_DISPLAYS];   // as last sent
+
+static void writeData16(LGFX_GC9A01* d, uint16_t v) {
+    d->writeData(v >> 8);
+    d->writeData(v & 0xFF);
+}
+
+void scrollPanel(int idx, const PanelScroll& s) {
+    PanelScroll& cur = panelScroll[idx];
+    if (!s.rows || (s.top == cur.top && s.rows == cur.rows && s.start == cur.start)) return;
+
+    auto* d = displays[idx];
+    bool define = (s.top != cur.top || s.rows != cur.rows);
+    d->startWrite();
+    if (define) {
+        d->writeCommand(0x33);      // VSCRDEF: top, area, bottom
+        writeData16(d, s.top);
+        writeData16(d, s.rows);
+        writeData16(d, DISPLAY_HEIGHT - s.top - s.rows);
     }
+    d->writeCommand(0x37);          // VSCRSADD
+    writeData16(d, s.start);
+    if (define) pushArea(d, idx, 0, s.top, DISPLAY_WIDTH, s.rows, true);
+    d->endWrite();
+    cur = s;
 }
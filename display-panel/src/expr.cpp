@@ -0,0 +1,366 @@
+#include "expr.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================
+// Names an expression can read
+// count > 1 = group, only usable inside min/max/sum/avg
+// ============================================
+struct ExprName {
+    const char* name;
+    uint8_t     id;
+    uint8_t     count;
+};
+
+static const ExprName exprNames[] = {
+    {"unraid.driveTemps",     M_UNRAID_DRIVE_TEMP,       METRIC_DRIVES},
+    {"unraid.drives",         M_UNRAID_DRIVE_COUNT,      1},
+    {"unraid.used",           M_UNRAID_STORAGE_USED_TB,  1},
+    {"unraid.total",          M_UNRAID_STORAGE_TOTAL_TB, 1},
+    {"unraid.cpu",            M_UNRAID_CPU,              1},
+    {"unraid.mem",            M_UNRAID_MEM,              1},
+    {"unraid.docker.running", M_UNRAID_DOCKER_RUNNING,   1},
+    {"unraid.docker.total",   M_UNRAID_DOCKER_TOTAL,     1},
+    {"m900.cpu",              M_M900_CPU,                1},
+    {"m900.temp",             M_M900_CPU_TEMP,           1},
+    {"m900.mem",              M_M900_MEM,                1},
+    {"m900.mem.used",         M_M900_MEM_USED_GB,        1},
+    {"m900.mem.total",        M_M900_MEM_TOTAL_GB,       1},
+    {"m900.disk",             M_M900_DISK,               1},
+    {"m900.disk.used",        M_M900_DISK_USED_GB,       1},
+    {"m900.disk.total",       M_M900_DISK_TOTAL_GB,      1},
+    {"m900.net.tx",           M_M900_NET_SENT,           1},     // bytes, counter
+    {"m900.net.rx",           M_M900_NET_RECV,           1},     // bytes, counter
+    {"m900.net.up",           M_M900_NET_UP_MBPS,        1},
+    {"m900.net.down",         M_M900_NET_DOWN_MBPS,      1},
+    {"piTemps",               M_PI_TEMP,                 METRIC_PIS},
+    {"piCpu",                 M_PI_CPU,                  METRIC_PIS},
+    {"piMem",                 M_PI_MEM,                  METRIC_PIS},
+    {"services.up",           M_SERVICE_UP,              METRIC_SERVICES},
+    {"services.ms",           M_SERVICE_MS,              METRIC_SERVICES},
+    {"adsb.aircraft",         M_ADSB_AIRCRAFT,           1},
+    {"adsb.rate",             M_ADSB_MSG_RATE,           1},     // messages / s
+    {"dns.queries",           M_DNS_QUERIES,             1},     // last 24 h
+    {"dns.blocked",           M_DNS_BLOCKED,             1},
+    {"dns.forwarded",         M_DNS_FORWARDED,           1},
+    {"dns.cached",            M_DNS_CACHED,              1},
+    {"dns.clients",           M_DNS_CLIENTS,             1},
+    {"dns.qps",               M_DNS_QPS,                 1},
+    {"dns.blockPct",          M_DNS_BLOCK_PCT,           1},
+};
+
+// ============================================
+// Ops
+// Aggregates keep (accumulator, count) on the stack between
+// AGG_BEGIN and AGG_END; each argument folds into them
+// ============================================
+enum ExprCode : uint8_t {
+    OP_CONST, OP_LOAD, OP_RATE,
+    OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_NEG, OP_ABS,
+    OP_AGG_BEGIN, OP_AGG_ADD, OP_AGG_GROUP, OP_AGG_END,
+};
+
+enum ExprAgg : uint8_t { AGG_MIN, AGG_MAX, AGG_SUM, AGG_AVG };
+
+// ============================================
+// Compiler: recursive descent, emitting postfix as it goes
+// ============================================
+struct Compiler {
+    Expr&       e;
+    const char* src;
+    const char* p;
+    const char* error;
+    int         depth;
+
+    void fail(const char* msg) {
+        if (!error) error = msg;
+    }
+
+    void emit(uint8_t code, int push, uint8_t id = 0, uint8_t count = 0, uint8_t fn = 0,
+              float k = 0) {
+        if (error) return;
+        if (e.len == EXPR_MAX_OPS) return fail("expression too long");
+        depth += push;
+        if (depth > EXPR_STACK) return fail("expression too deep");
+        e.ops[e.len++] = {code, id, count, fn, k};
+    }
+
+    void use(int id, int count) {
+        for (int i = id; i < id + count; i++) e.deps[i / 32] |= 1u << (i % 32);
+    }
+
+    void space() {
+        while (*p == ' ' || *p == '\t') p++;
+    }
+
+    bool accept(char c) {
+        space();
+        if (*p != c) return false;
+        p++;
+        return true;
+    }
+
+    // Identifier into buf; false if there isn't one here
+    bool ident(char* buf, size_t cap) {
+        space();
+        const char* start = p;
+        while ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') || *p == '_' ||
+               (p > start && ((*p >= '0' && *p <= '9') || *p == '.'))) {
+            p++;
+        }
+        size_t n = p - start;
+        if (n == 0) return false;
+        if (n >= cap) {
+            fail("name too long");
+            return false;
+        }
+        memcpy(buf, start, n);
+        buf[n] = '\0';
+        return true;
+    }
+
+    const ExprName* lookup(const char* name) {
+        for (const ExprName& n : exprNames) {
+            if (strcmp(n.name, name) == 0) return &n;
+        }
+        return nullptr;
+    }
+
+    void expr() {
+        term();
+        for (;;) {
+            if (accept('+'))      { term(); emit(OP_ADD, -1); }
+            else if (accept('-')) { term(); emit(OP_SUB, -1); }
+            else return;
+        }
+    }
+
+    void term() {
+        unary();
+        for (;;) {
+            if (accept('*'))      { unary(); emit(OP_MUL, -1); }
+            else if (accept('/')) { unary(); emit(OP_DIV, -1); }
+            else return;
+        }
+    }
+
+    void unary() {
+        if (accept('-')) {
+            unary();
+            emit(OP_NEG, 0);
+        } else {
+            primary();
+        }
+    }
+
+    void primary() {
+        if (error) return;
+        space();
+
+        if (accept('(')) {
+            expr();
+            if (!accept(')')) fail("expected )");
+            return;
+        }
+
+        if ((*p >= '0' && *p <= '9') || *p == '.') {
+            char* end;
+            double v = strtod(p, &end);
+            p = end;
+            emit(OP_CONST, 1, 0, 0, 0, (float)v);
+            return;
+        }
+
+        const char* at = p;
+        char name[24];
+        if (!ident(name, sizeof(name))) return fail("expected a value");
+
+        if (accept('(')) return call(name, at);
+
+        const ExprName* n = lookup(name);
+        if (!n) {
+            p = at;
+            return fail("unknown metric");
+        }
+        if (n->count > 1) {
+            p = at;
+            return fail("group needs min/max/sum/avg");
+        }
+        use(n->id, 1);
+        emit(OP_LOAD, 1, n->id);
+    }
+
+    void call(const char* fn, const char* at) {
+        static const char* aggs[] = {"min", "max", "sum", "avg"};
+        for (int a = 0; a < 4; a++) {
+            if (strcmp(fn, aggs[a]) == 0) return aggregate(a);
+        }
+
+        if (strcmp(fn, "abs") == 0) {
+            expr();
+            emit(OP_ABS, 0);
+        } else if (strcmp(fn, "rate") == 0) {
+            const char* argAt = p;
+            char name[24];
+            const ExprName* n = ident(name, sizeof(name)) ? lookup(name) : nullptr;
+            if (!n || n->count > 1) {
+                p = argAt;
+                return fail("rate() takes one metric");
+            }
+            if (e.rates == EXPR_MAX_RATES) return fail("too many rate() calls");
+            use(n->id, 1);
+            emit(OP_RATE, 1, n->id, e.rates++);
+        } else {
+            p = at;
+            return fail("unknown function");
+        }
+        if (!accept(')')) fail("expected )");
+    }
+
+    // Arguments may be plain values or whole groups
+    void aggregate(uint8_t fn) {
+        emit(OP_AGG_BEGIN, 2, 0, 0, fn);
+        do {
+            const char* at = p;
+            char name[24];
+            const ExprName* n = nullptr;
+            if (ident(name, sizeof(name))) {
+                space();
+                n = (*p == ',' || *p == ')') ? lookup(name) : nullptr;
+                if (!n || n->count == 1) p = at;   // parse it as an expression
+            }
+            if (n && n->count > 1) {
+                use(n->id, n->count);
+                emit(OP_AGG_GROUP, 0, n->id, n->count, fn);
+            } else {
+                expr();
+                emit(OP_AGG_ADD, -1, 0, 0, fn);
+            }
+        } while (!error && accept(','));
+        if (!accept(')')) fail("expected )");
+        emit(OP_AGG_END, -1, 0, 0, fn);
+    }
+};
+
+bool exprCompile(Expr& e, const char* src, const char** error, int* column) {
+    memset(&e, 0, sizeof(e));
+    e.value = NAN;
+
+    Compiler c = {e, src, src, nullptr, 0};
+    c.expr();
+    c.space();
+    if (*c.p) c.fail("unexpected character");
+
+    if (error) *error = c.error;
+    if (column) *column = (int)(c.p - src) + 1;
+    e.valid = (c.error == nullptr);
+    if (!e.valid) e.len = 0;
+    return e.valid;
+}
+
+// ============================================
+// Evaluation
+// ============================================
+static void fold(double* acc, double v, uint8_t fn) {
+    if (isnan(v)) return;
+    if (fn == AGG_MIN) acc[0] = fmin(acc[0], v);
+    else if (fn == AGG_MAX) acc[0] = fmax(acc[0], v);
+    else acc[0] += v;
+    acc[1] += 1;
+}
+
+static double rateOf(ExprRate& r, const MetricStore& m, int id) {
+    uint32_t at = m.sampledMs[id];
+    double v = m.value[id];
+    if (at == 0 || at == r.prevMs) return r.rate;     // nothing new (or restored)
+
+    if (r.prevMs != 0 && v >= r.prev) {
+        r.rate = (v - r.prev) * 1000.0 / (uint32_t)(at - r.prevMs);
+    } else {
+        r.rate = 0;     // first sample, or the counter reset
+    }
+    r.prev = v;
+    r.prevMs = at;
+    return r.rate;
+}
+
+static double evaluate(Expr& e, const MetricStore& m) {
+    double st[EXPR_STACK];
+    int sp = 0;
+
+    for (int i = 0; i < e.len; i++) {
+        const ExprOp& op = e.ops[i];
+        switch (op.code) {
+        case OP_CONST: st[sp++] = op.k; break;
+        case OP_LOAD:  st[sp++] = (m.state[op.id] == MS_EMPTY) ? NAN : m.value[op.id]; break;
+        case OP_RATE:  st[sp++] = rateOf(e.rate[op.count], m, op.id); break;
+        case OP_ADD:   sp--; st[sp - 1] += st[sp]; break;
+        case OP_SUB:   sp--; st[sp - 1] -= st[sp]; break;
+        case OP_MUL:   sp--; st[sp - 1] *= st[sp]; break;
+        case OP_DIV:   sp--; st[sp - 1] = (st[sp] != 0) ? st[sp - 1] / st[sp] : NAN; break;
+        case OP_NEG:   st[sp - 1] = -st[sp - 1]; break;
+        case OP_ABS:   st[sp - 1] = fabs(st[sp - 1]); break;
+
+        case OP_AGG_BEGIN:
+            st[sp++] = (op.fn == AGG_MIN) ? INFINITY : (op.fn == AGG_MAX) ? -INFINITY : 0;
+            st[sp++] = 0;
+            break;
+        case OP_AGG_ADD:
+            sp--;
+            fold(&st[sp - 2], st[sp], op.fn);
+            break;
+        case OP_AGG_GROUP:
+            for (int id = op.id; id < op.id + op.count; id++) {
+                if (m.state[id] != MS_EMPTY) fold(&st[sp - 2], m.value[id], op.fn);
+            }
+            break;
+        case OP_AGG_END: {
+            double n = st[--sp];
+            double acc = st[sp - 1];
+            st[sp - 1] = (n == 0) ? NAN : (op.fn == AGG_AVG) ? acc / n : acc;
+            break;
+        }
+        }
+    }
+    return sp == 1 ? st[0] : NAN;
+}
+
+// ============================================
+// Change tracking
+// ============================================
+void exprChangedInputs(const MetricStore& m, ExprInputs& last, uint32_t changed[EXPR_DEP_WORDS]) {
+    memset(changed, 0, EXPR_DEP_WORDS * sizeof(uint32_t));
+    for (int id = 0; id < M_COUNT; id++) {
+        if (m.sampledMs[id] != last.sampledMs[id] || m.state[id] != last.state[id]) {
+            changed[id / 32] |= 1u << (id % 32);
+            last.sampledMs[id] = m.sampledMs[id];
+            last.state[id] = m.state[id];
+        }
+    }
+}
+
+bool exprUpdate(Expr& e, const MetricStore& m, const uint32_t changed[EXPR_DEP_WORDS],
+                uint32_t nowMs) {
+    if (!e.valid) return false;
+
+    // Stale if any sampled input is; never-sampled group members
+    // don't count, but at least one input must have a value
+    bool anyStale = false, anySampled = false, anyInput = false, dirty = !e.evaluated;
+    for (int w = 0; w < EXPR_DEP_WORDS; w++) {
+        if (e.deps[w]) anyInput = true;
+        if (e.deps[w] & changed[w]) dirty = true;
+        for (uint32_t bits = e.deps[w]; bits; bits &= bits - 1) {
+            int id = w * 32 + __builtin_ctz(bits);
+            if (m.state[id] == MS_EMPTY) continue;
+            anySampled = true;
+            if (metricStale(m, id, nowMs)) anyStale = true;
+        }
+    }
+    e.stale = anyStale || (anyInput && !anySampled);
+
+    if (!dirty) return false;
+    e.value = evaluate(e, m);
+    e.evaluated = true;
+    return true;
+}
@@ -1,24 +1,20 @@
 #include "gauges.h"
 #include <math.h>
 
-#ifndef DEG2RAD
-#define DEG2RAD 0.017453292f
-#endif
-
 // ============================================
 // Color based on thresholds
 // ============================================
 uint32_t gaugeColor(float value, float warn, float crit) {
-    if (value >= crit) return TFT_RED;
-    if (value >= warn) return TFT_YELLOW;
-    return TFT_GREEN;
+    if (value >= crit) return PAL_RED;
+    if (value >= warn) return PAL_YELLOW;
+    return PAL_GREEN;
 }
 
 // ============================================
 // Draw arc background + filled portion
 // ============================================
-void drawArc(LGFX_GC9A01* d, int cx, int cy,
-             float value, const GaugeConfig& cfg) {
+void drawArc(LGFX_Sprite* d, int cx, int cy,
+             float value, const GaugeConfig& cfg, bool muted) {
 
     int r_outer = cfg.arcRadius;
     int r_inner = cfg.arcRadius - cfg.arcWidth;
@@ -29,14 +25,14 @@ void drawArc(LGFX_GC9A01* d, int cx, int cy,
 
     // Draw background arc (dark grey)
     for (int a = 0; a <= cfg.sweepAngle; a++) {
-        float rad = (cfg.startAngle + a) * DEG2RAD;
+        float rad = (cfg.startAngle + a) * GAUGE_DEG2RAD;
         float cs = cos(rad);
         float sn = sin(rad);
 
         for (int r = r_inner; r <= r_outer; r++) {
             int px = cx + (int)(r * cs);
             int py = cy + (int)(r * sn);
-            d->drawPixel(px, py, 0x2104);  // dark grey
+            d->drawPixel(px, py, PAL_ARC_BG);
         }
     }
 
@@ -45,9 +41,9 @@ void drawArc(LGFX_GC9A01* d, int cx, int cy,
     for (int a = 0; a <= fillAngle; a++) {
         float segPct = (float)a / cfg.sweepAngle;
         float segVal = cfg.minVal + segPct * (cfg.maxVal - cfg.minVal);
-        uint32_t color = gaugeColor(segVal, cfg.warnVal, cfg.critVal);
+        uint32_t color = muted ? PAL_DARKGREY : gaugeColor(segVal, cfg.warnVal, cfg.critVal);
 
-        float rad = (cfg.startAngle + a) * DEG2RAD;
+        float rad = (cfg.startAngle + a) * GAUGE_DEG2RAD;
         float cs = cos(rad);
         float sn = sin(rad);
 
@@ -59,18 +55,18 @@ void drawArc(LGFX_GC9A01* d, int cx, int cy,
     }
 
     // Draw needle line
-    float needleRad = (cfg.startAngle + fillAngle) * DEG2RAD;
+    float needleRad = (cfg.startAngle + fillAngle) * GAUGE_DEG2RAD;
     int nx1 = cx + (int)((r_inner - 4) * cos(needleRad));
     int ny1 = cy + (int)((r_inner - 4) * sin(needleRad));
     int nx2 = cx + (int)((r_outer + 2) * cos(needleRad));
     int ny2 = cy + (int)((r_outer + 2) * sin(needleRad));
-    d->drawLine(nx1, ny1, nx2, ny2, TFT_WHITE);
+    d->drawLine(nx1, ny1, nx2, ny2, PAL_WHITE);
 }
 
 // ============================================
 // Draw tick marks
 // ============================================
-void drawTicks(LGFX_GC9A01* d, int cx, int cy,
+void drawTicks(LGFX_Sprite* d, int cx, int cy,
                const GaugeConfig& cfg, int numTicks) {
 
     int r_outer = cfg.arcRadius + 4;
@@ -78,7 +74,7 @@ void drawTicks(LGFX_GC9A01* d, int cx, int cy,
 
     for (int i = 0; i <= numTicks; i++) {
         float pct = (float)i / numTicks;
-        float angle = (cfg.startAngle + pct * cfg.sweepAngle) * DEG2RAD;
+        float angle = (cfg.startAngle + pct * cfg.sweepAngle) * GAUGE_DEG2RAD;
         float cs = cos(angle);
         float sn = sin(angle);
 
@@ -90,11 +86,11 @@ void drawTicks(LGFX_GC9A01* d, int cx, int cy,
         // Major ticks are longer
         bool major = (i % 2 == 0);
         if (major) {
-            d->drawLine(x1, y1, x2, y2, TFT_LIGHTGREY);
+            d->drawLine(x1, y1, x2, y2, PAL_LIGHTGREY);
         } else {
             int xm = cx + (int)((r_inner + 3) * cs);
             int ym = cy + (int)((r_inner + 3) * sn);
-            d->drawLine(xm, ym, x2, y2, TFT_DARKGREY);
+            d->drawLine(xm, ym, x2, y2, PAL_DARKGREY);
         }
     }
 }
@@ -102,53 +98,62 @@ void drawTicks(LGFX_GC9A01* d, int cx, int cy,
 // ============================================
 // Full gauge with label, value, and unit
 // ============================================
-void drawGauge(LGFX_GC9A01* d, int cx, int cy,
+void drawGauge(LGFX_Sprite* d, int cx, int cy,
                float value, const GaugeConfig& cfg,
                const char* label, const char* unit,
-               const char* valueFormat) {
+               const char* valueFormat, bool muted) {
 
     // Draw arc and ticks
-    drawArc(d, cx, cy, value, cfg);
+    drawArc(d, cx, cy, value, cfg, muted);
     drawTicks(d, cx, cy, cfg);
 
+    uint32_t valColor = muted ? PAL_DARKGREY : gaugeColor(value, cfg.warnVal, cfg.critVal);
+    drawGaugeText(d, cx, cy, value, valColor, label, unit, valueFormat);
+}
+
+void drawGaugeText(LGFX_Sprite* d, int cx, int cy, float value, uint32_t valColor,
+                   const char* label, const char* unit, const char* valueFormat) {
     // Label at top
     d->setTextDatum(middle_center);
     d->setTextSize(1.5);
-    d->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+    d->setTextColor(PAL_LIGHTGREY, PAL_BLACK);
     d->drawString(label, cx, cy - 35);
 
     // Value in center (big)
     char valStr[16];
     snprintf(valStr, sizeof(valStr), valueFormat, value);
     d->setTextSize(3.5);
-    uint32_t valColor = gaugeColor(value, cfg.warnVal, cfg.critVal);
-    d->setTextColor(valColor, TFT_BLACK);
+    d->setTextColor(valColor, PAL_BLACK);
     d->drawString(valStr, cx, cy + 5);
 
     // Unit below value
     d->setTextSize(1.5);
-    d->setTextColor(TFT_DARKGREY, TFT_BLACK);
+    d->setTextColor(PAL_DARKGREY, PAL_BLACK);
     d->drawString(unit, cx, cy + 35);
 }
 
 // ============================================
 // Mini gauge for multi-gauge layouts
 // ============================================
-void drawMiniGauge(LGFX_GC9A01* d, int cx, int cy,
+void drawMiniGauge(LGFX_Sprite* d, int cx, int cy,
                    float value, const GaugeConfig& cfg,
-                   const char* label, const char* valueStr) {
+                   const char* label, const char* valueStr, bool muted) {
 
-    drawArc(d, cx, cy, value, cfg);
+    drawArc(d, cx, cy, value, cfg, muted);
+    uint32_t valColor = muted ? PAL_DARKGREY : gaugeColor(value, cfg.warnVal, cfg.critVal);
+    drawMiniGaugeText(d, cx, cy, valColor, label, valueStr);
+}
 
+void drawMiniGaugeText(LGFX_Sprite* d, int cx, int cy, uint32_t valColor,
+                       const char* label, const char* valueStr) {
     // Label above
     d->setTextDatum(middle_center);
     d->setTextSize(1);
-    d->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+    d->setTextColor(PAL_LIGHTGREY, PAL_BLACK);
     d->drawString(label, cx, cy - 12);
 
     // Value in center
     d->setTextSize(1.5);
-    uint32_t valColor = gaugeColor(value, cfg.warnVal, cfg.critVal);
-    d->setTextColor(valColor, TFT_BLACK);
+    d->setTextColor(valColor, PAL_BLACK);
     d->drawString(valueStr, cx, cy + 8);
 }
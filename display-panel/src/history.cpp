@@ -0,0 +1,602 @@
+#include "history.h"
+#include "config.h"
+#include <Arduino.h>
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+#include <math.h>
+#include <stddef.h>
+#include <time.h>
+
+// ============================================
+// Flash layout
+// Each 4 KB sector: a SectorHeader, then records packed to the
+// first erased byte. A record is a RecordHeader plus its payload
+// padded to 4 bytes, never split across sectors.
+// ============================================
+#define HISTORY_MAGIC       0x54534948    // "HIST"
+#define HISTORY_VERSION     1
+#define HISTORY_SUBTYPE     0x41          // see partitions.csv
+#define SECTOR_SIZE         0x1000
+#define NO_SPAN             0xFFFFFFFF    // erased header field
+
+struct SectorHeader {
+    uint32_t magic;
+    uint32_t seq;           // sectors opened since the log began; highest = head
+    uint16_t version;
+    uint16_t metrics;       // M_COUNT when written: ids must still mean the same
+    uint32_t tMin, tMax;    // records' span  } filled in when the
+    uint32_t end;           // past the last  } sector is closed
+};
+
+struct RecordHeader {
+    uint8_t  metric;        // 0xFF = erased: no more records in the sector
+    uint8_t  scale;         // value words: decimal digits, or SCALE_FLOAT
+    uint16_t bits;          // compressed payload length
+    uint16_t count;         // samples
+    uint16_t reserved2;
+    uint32_t tStart, tEnd;  // first and last sample, epoch s
+    float    min, max, sum;
+    uint32_t crc;           // fields above + payload
+};
+
+static_assert(sizeof(RecordHeader) == 32, "record header layout");
+
+static uint32_t recordSize(const RecordHeader& r) {
+    return sizeof(RecordHeader) + (((r.bits + 7) / 8 + 3) & ~3u);
+}
+
+// ============================================
+// Open blocks: one per metric, filled bit by bit
+// ============================================
+#define NO_WINDOW       0xFF
+#define MAX_SAMPLE_BITS (4 + 32 + 2 + 5 + 5 + 32)   // worst timestamp + worst value
+
+struct Block {
+    uint8_t  data[HISTORY_BLOCK_BYTES];
+    uint16_t bits;
+    uint16_t count;
+    uint32_t tStart, tPrev;
+    int32_t  delta;         // previous timestamp delta
+    uint32_t vPrev;         // previous value's float bits
+    uint8_t  lead, trail;   // meaningful-bit window of the last XOR written out
+    uint8_t  scale;
+    float    min, max;
+    double   sum;
+};
+
+static Block    blocks[M_COUNT];
+static uint32_t lastT[M_COUNT];         // newest sample appended, epoch s
+static uint32_t lastMs[M_COUNT];        // its sampledMs in the store
+static uint8_t  scaleOf[M_COUNT];       // digits the metric has needed so far
+
+static const esp_partition_t* part = nullptr;
+static uint16_t sectorCount = 0;
+static int      head = -1;              // sector being appended to, -1 = none yet
+static uint32_t headSeq = 0;
+static uint32_t headOff = 0;            // next record offset in head
+static bool     headClosed = false;     // span already written: append nothing more
+static uint32_t spanMin[HISTORY_MAX_SECTORS];   // sector's records, min > max = none
+static uint32_t spanMax[HISTORY_MAX_SECTORS];
+static uint16_t sectorEnd[HISTORY_MAX_SECTORS]; // past its last good record
+static HistoryStats stats;
+
+// ============================================
+// Bit stream, MSB first
+// ============================================
+static void putBits(Block& b, uint32_t v, int n) {
+    while (n > 0) {
+        int used = b.bits & 7;
+        int take = min(n, 8 - used);
+        uint8_t chunk = (v >> (n - take)) & ((1u << take) - 1);
+        if (used == 0) b.data[b.bits >> 3] = 0;
+        b.data[b.bits >> 3] |= chunk << (8 - used - take);
+        b.bits += take;
+        n -= take;
+    }
+}
+
+struct BitReader {
+    const uint8_t* data;
+    uint32_t pos, end;
+    bool     bad;
+
+    uint32_t get(int n) {
+        if (pos + n > end) {
+            bad = true;
+            return 0;
+        }
+        uint32_t v = 0;
+        while (n > 0) {
+            int used = pos & 7;
+            int take = min(n, 8 - used);
+            v = (v << take) | ((data[pos >> 3] >> (8 - used - take)) & ((1u << take) - 1));
+            pos += take;
+            n -= take;
+        }
+        return v;
+    }
+};
+
+// ============================================
+// Value words
+// A float read off a decimal source (23.4) has a mantissa that
+// churns end to end from one reading to the next, so values that
+// survive the round trip are XOR'd as decimal integers (234)
+// instead and only their low bits change. The scale is per block
+// and only grows for a metric; anything that won't fit (byte
+// counters, unrounded floats) falls back to the float's own bits.
+// ============================================
+#define MAX_SCALE   3
+#define SCALE_FLOAT 0xFF
+
+static const double POW10[MAX_SCALE + 1] = {1, 10, 100, 1000};
+
+static bool toWord(float v, uint8_t scale, uint32_t& w) {
+    if (scale == SCALE_FLOAT) {
+        memcpy(&w, &v, sizeof(w));
+        return true;
+    }
+    double n = round((double)v * POW10[scale]);
+    if (fabs(n) >= 2147483648.0 || (float)(n / POW10[scale]) != v) return false;
+    w = (uint32_t)(int32_t)n;
+    return true;
+}
+
+static float fromWord(uint32_t w, uint8_t scale) {
+    if (scale == SCALE_FLOAT) {
+        float f;
+        memcpy(&f, &w, sizeof(f));
+        return f;
+    }
+    return (float)((int32_t)w / POW10[scale]);
+}
+
+// ============================================
+// Gorilla encoding
+// Timestamps: delta-of-delta against the previous delta (the first
+// delta counts against HISTORY_INTERVAL_S), in Gorilla's prefix
+// classes plus a narrow [-3, 4] one for the second or two of jitter
+// a poll on a millis() schedule picks up:
+//
+//   0                  same delta
+//   10   + 3 bits      [-3, 4]
+//   110  + 7 bits      [-63, 64]
+//   1110 + 12 bits     [-2047, 2048]
+//   1111 + 32 bits     anything
+//
+// Values: XOR with the previous value word.
+//
+//   0                  unchanged
+//   10 + bits          fits the last leading/trailing-zero window
+//   11 + 5 bits leading zeros + 5 bits length-1 + bits
+// ============================================
+static void encodeTime(Block& b, uint32_t t) {
+    int32_t delta = (int32_t)(t - b.tPrev);
+    int32_t dod = delta - b.delta;
+    if (dod == 0) {
+        putBits(b, 0, 1);
+    } else if (dod >= -3 && dod <= 4) {
+        putBits(b, 0b10, 2);
+        putBits(b, dod + 3, 3);
+    } else if (dod >= -63 && dod <= 64) {
+        putBits(b, 0b110, 3);
+        putBits(b, dod + 63, 7);
+    } else if (dod >= -2047 && dod <= 2048) {
+        putBits(b, 0b1110, 4);
+        putBits(b, dod + 2047, 12);
+    } else {
+        putBits(b, 0b1111, 4);
+        putBits(b, (uint32_t)dod, 32);
+    }
+    b.delta = delta;
+    b.tPrev = t;
+}
+
+static void encodeValue(Block& b, uint32_t v) {
+    uint32_t x = v ^ b.vPrev;
+    if (x == 0) {
+        putBits(b, 0, 1);
+        return;
+    }
+    int lead = __builtin_clz(x);
+    int trail = __builtin_ctz(x);
+    if (b.lead != NO_WINDOW && lead >= b.lead && trail >= b.trail) {
+        putBits(b, 0b10, 2);
+        putBits(b, x >> b.trail, 32 - b.lead - b.trail);
+        return;
+    }
+    int len = 32 - lead - trail;
+    putBits(b, 0b11, 2);
+    putBits(b, lead, 5);
+    putBits(b, len - 1, 5);
+    putBits(b, x >> trail, len);
+    b.lead = lead;
+    b.trail = trail;
+}
+
+// fn(t, value) for each sample; false if the stream is short or
+// runs past its bit count
+template <typename F>
+static bool decodeBlock(const uint8_t* data, uint32_t bits, uint32_t count, uint32_t tStart,
+                        uint8_t scale, F&& fn) {
+    BitReader r = {data, 0, bits, false};
+    uint32_t t = tStart;
+    int32_t delta = HISTORY_INTERVAL_S;
+    uint32_t v = r.get(32);
+    int lead = 0, trail = 0;
+
+    for (uint32_t i = 0; i < count && !r.bad; i++) {
+        if (i > 0) {
+            int32_t dod = 0;
+            int ones = 0;
+            while (ones < 4 && r.get(1)) ones++;
+            switch (ones) {
+            case 0: break;
+            case 1: dod = (int32_t)r.get(3) - 3; break;
+            case 2: dod = (int32_t)r.get(7) - 63; break;
+            case 3: dod = (int32_t)r.get(12) - 2047; break;
+            default: dod = (int32_t)r.get(32); break;
+            }
+            delta += dod;
+            t += delta;
+
+            if (r.get(1)) {
+                if (r.get(1)) {
+                    lead = r.get(5);
+                    int len = r.get(5) + 1;
+                    trail = 32 - lead - len;
+                    if (trail < 0) return false;
+                }
+                v ^= r.get(32 - lead - trail) << trail;
+            }
+        }
+        if (r.bad) return false;
+        fn(t, fromWord(v, scale));
+    }
+    return !r.bad;
+}
+
+// ============================================
+// Log
+// ============================================
+static bool spanEmpty(int s) {
+    return spanMin[s] > spanMax[s];
+}
+
+static void spanAdd(int s, uint32_t tStart, uint32_t tEnd) {
+    if (tStart < spanMin[s]) spanMin[s] = tStart;
+    if (tEnd > spanMax[s]) spanMax[s] = tEnd;
+}
+
+static uint32_t recordCrc(const RecordHeader& r, const uint8_t* payload) {
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t*)&r, offsetof(RecordHeader, crc));
+    return esp_rom_crc32_le(crc, payload, (r.bits + 7) / 8);
+}
+
+// Header of the record at off; false at the end of the sector's records
+static bool readRecord(int s, uint32_t off, RecordHeader& r) {
+    if (off + sizeof(r) > SECTOR_SIZE) return false;
+    if (esp_partition_read(part, s * SECTOR_SIZE + off, &r, sizeof(r)) != ESP_OK) return false;
+    return r.metric < M_COUNT && (r.scale <= MAX_SCALE || r.scale == SCALE_FLOAT) &&
+           r.bits <= HISTORY_BLOCK_BYTES * 8 &&
+           off + recordSize(r) <= SECTOR_SIZE;
+}
+
+// Records of a sector a power cut left open, checked one by one:
+// the span of the good ones and where they end. False if the walk
+// stopped at anything but erased flash (a torn write).
+static bool walkSector(int s) {
+    RecordHeader r;
+    uint8_t payload[HISTORY_BLOCK_BYTES];
+    uint32_t end = sizeof(SectorHeader);
+    bool clean = true;
+    while (readRecord(s, end, r)) {
+        if (esp_partition_read(part, s * SECTOR_SIZE + end + sizeof(r), payload,
+                               (r.bits + 7) / 8) != ESP_OK ||
+            recordCrc(r, payload) != r.crc) {
+            clean = false;
+            break;
+        }
+        spanAdd(s, r.tStart, r.tEnd);
+        end += recordSize(r);
+    }
+    if (clean && end + sizeof(r) <= SECTOR_SIZE && r.metric != 0xFF) clean = false;
+    sectorEnd[s] = end;
+    return clean;
+}
+
+// Span and end go into the header's erased fields
+static void closeSector(int s) {
+    if (spanEmpty(s)) return;
+    uint32_t fields[3] = {spanMin[s], spanMax[s], sectorEnd[s]};
+    esp_partition_write(part, s * SECTOR_SIZE + offsetof(SectorHeader, tMin), fields, sizeof(fields));
+}
+
+// Next sector round the ring becomes head; whatever it held (the
+// oldest records) is erased
+static bool openSector() {
+    if (head >= 0 && !headClosed) closeSector(head);
+    headClosed = true;
+    int s = (head + 1) % sectorCount;
+    spanMin[s] = NO_SPAN;
+    spanMax[s] = 0;
+    sectorEnd[s] = sizeof(SectorHeader);
+    if (esp_partition_erase_range(part, s * SECTOR_SIZE, SECTOR_SIZE) != ESP_OK) return false;
+    stats.erases++;
+
+    SectorHeader h = {HISTORY_MAGIC, headSeq + 1, HISTORY_VERSION, M_COUNT, NO_SPAN, NO_SPAN, NO_SPAN};
+    if (esp_partition_write(part, s * SECTOR_SIZE, &h, sizeof(h)) != ESP_OK) return false;
+    head = s;
+    headSeq = h.seq;
+    headOff = sizeof(h);
+    headClosed = false;
+    return true;
+}
+
+// Append metric id's block to the log and empty it
+static void sealBlock(int id) {
+    Block& b = blocks[id];
+    if (b.count == 0) return;
+
+    static uint8_t buf[sizeof(RecordHeader) + HISTORY_BLOCK_BYTES];
+    RecordHeader r = {};
+    r.metric = id;
+    r.scale = b.scale;
+    r.bits = b.bits;
+    r.count = b.count;
+    r.tStart = b.tStart;
+    r.tEnd = b.tPrev;
+    r.min = b.min;
+    r.max = b.max;
+    r.sum = (float)b.sum;
+    r.crc = recordCrc(r, b.data);
+
+    uint32_t size = recordSize(r);
+    memcpy(buf, &r, sizeof(r));
+    memcpy(buf + sizeof(r), b.data, (b.bits + 7) / 8);
+    memset(buf + sizeof(r) + (b.bits + 7) / 8, 0xFF, size - sizeof(r) - (b.bits + 7) / 8);
+    b.count = 0;
+    b.bits = 0;
+
+    if (head < 0 || headClosed || headOff + size > SECTOR_SIZE) {
+        if (!openSector()) {
+            Serial.println("History: sector erase failed");
+            return;
+        }
+    }
+    if (esp_partition_write(part, head * SECTOR_SIZE + headOff, buf, size) != ESP_OK) {
+        Serial.println("History: flash write failed");
+        return;
+    }
+    headOff += size;
+    sectorEnd[head] = headOff;
+    spanAdd(head, r.tStart, r.tEnd);
+    stats.records++;
+    stats.flashBytes += size;
+}
+
+// ============================================
+// Mount
+// ============================================
+bool historyBegin() {
+    memset(blocks, 0, sizeof(blocks));
+    memset(lastT, 0, sizeof(lastT));
+    memset(lastMs, 0, sizeof(lastMs));
+    memset(scaleOf, 0, sizeof(scaleOf));
+    stats = {};
+    head = -1;
+    headSeq = 0;
+    headClosed = false;
+
+    part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                    (esp_partition_subtype_t)HISTORY_SUBTYPE, "history");
+    if (!part) {
+        Serial.println("History: no partition");
+        return false;
+    }
+    sectorCount = min((uint32_t)(part->size / SECTOR_SIZE), (uint32_t)HISTORY_MAX_SECTORS);
+    stats.sectors = sectorCount;
+
+    // Sector headers: spans of closed sectors, and the head
+    static bool unclosed[HISTORY_MAX_SECTORS];
+    for (int s = 0; s < sectorCount; s++) {
+        spanMin[s] = NO_SPAN;
+        spanMax[s] = 0;
+        sectorEnd[s] = sizeof(SectorHeader);
+        unclosed[s] = false;
+        SectorHeader h;
+        if (esp_partition_read(part, s * SECTOR_SIZE, &h, sizeof(h)) != ESP_OK) continue;
+        if (h.magic != HISTORY_MAGIC || h.version != HISTORY_VERSION || h.metrics != M_COUNT) continue;
+        if (head < 0 || (int32_t)(h.seq - headSeq) > 0) {
+            head = s;
+            headSeq = h.seq;
+        }
+        if (h.tMin != NO_SPAN && h.end <= SECTOR_SIZE) {
+            spanMin[s] = h.tMin;
+            spanMax[s] = h.tMax;
+            sectorEnd[s] = h.end;
+        } else {
+            unclosed[s] = true;
+        }
+    }
+
+    // Open sectors: the head, and any a power cut left unclosed.
+    // The head carries on after its last good record unless there
+    // was a torn one, which can't be written past; the others are
+    // closed now so the next mount needn't walk them.
+    for (int s = 0; s < sectorCount; s++) {
+        if (!unclosed[s]) continue;
+        bool clean = walkSector(s);
+        if (s != head) closeSector(s);
+        else headOff = clean ? sectorEnd[s] : SECTOR_SIZE;
+    }
+    headClosed = (head >= 0 && !unclosed[head]);
+
+    const HistoryStats& st = historyStats();
+    Serial.printf("History: %u/%u sectors in use, head %d, oldest %lu\n",
+                  st.used, st.sectors, head, (unsigned long)st.oldest);
+    return true;
+}
+
+// ============================================
+// Append
+// ============================================
+void historyAppend(int id, uint32_t t, float value) {
+    if (!part || id < 0 || id >= M_COUNT || !isfinite(value)) return;
+    if (lastT[id] && t < lastT[id]) return;
+
+    uint32_t v;
+    uint8_t scale = scaleOf[id];
+    while (!toWord(value, scale, v)) scale = (scale < MAX_SCALE) ? scale + 1 : SCALE_FLOAT;
+    scaleOf[id] = scale;
+
+    Block& b = blocks[id];
+    if (b.count && (b.bits + MAX_SAMPLE_BITS > HISTORY_BLOCK_BYTES * 8 || b.count == 0xFFFF ||
+                    b.scale != scale)) {
+        sealBlock(id);
+    }
+
+    if (b.count == 0) {
+        b.tStart = b.tPrev = t;
+        b.delta = HISTORY_INTERVAL_S;
+        b.lead = NO_WINDOW;
+        b.scale = scale;
+        b.min = b.max = value;
+        b.sum = 0;
+        putBits(b, v, 32);
+    } else {
+        encodeTime(b, t);
+        encodeValue(b, v);
+        if (value < b.min) b.min = value;
+        if (value > b.max) b.max = value;
+    }
+    b.vPrev = v;
+    b.sum += value;
+    b.count++;
+    lastT[id] = t;
+    stats.samples++;
+
+    if (t - b.tStart >= HISTORY_SEAL_S) sealBlock(id);
+}
+
+void historyRecord() {
+    if (!part) return;
+    time_t now = time(nullptr);
+    if (now < 1600000000) return;       // no NTP yet
+
+    static MetricStore m;
+    metricsRead(m);
+    uint32_t nowMs = millis();
+    for (int id = 0; id < M_COUNT; id++) {
+        if (m.state[id] == MS_LIVE && m.sampledMs[id] != lastMs[id]) {
+            // Stamped when it was sampled, not when we got round to it
+            uint32_t t = now - (nowMs - m.sampledMs[id]) / 1000;
+            if (!lastT[id] || t - lastT[id] >= HISTORY_INTERVAL_S) {
+                historyAppend(id, t, (float)m.value[id]);
+                lastMs[id] = m.sampledMs[id];
+            }
+        }
+        // A source that went quiet still gets its block to flash
+        if (blocks[id].count && (uint32_t)now - blocks[id].tStart >= HISTORY_SEAL_S) sealBlock(id);
+    }
+}
+
+void historySeal() {
+    if (!part) return;
+    for (int id = 0; id < M_COUNT; id++) sealBlock(id);
+}
+
+// ============================================
+// Query
+// ============================================
+struct Binner {
+    uint32_t from, to;
+    int      buckets;
+    HistoryBucket* out;
+
+    int bucket(uint32_t t) const {
+        return (int)((uint64_t)(t - from) * buckets / (to - from));
+    }
+
+    void add(uint32_t t, float v) {
+        if (t < from || t >= to) return;
+        HistoryBucket& o = out[bucket(t)];
+        if (v < o.min) o.min = v;
+        if (v > o.max) o.max = v;
+        o.mean += v;
+        o.count++;
+    }
+
+    // A span inside one bucket needs only its rollup
+    bool fold(uint32_t tStart, uint32_t tEnd, float mn, float mx, float sum, uint32_t count) {
+        if (tStart < from || tEnd >= to || bucket(tStart) != bucket(tEnd)) return false;
+        HistoryBucket& o = out[bucket(tStart)];
+        if (mn < o.min) o.min = mn;
+        if (mx > o.max) o.max = mx;
+        o.mean += sum;
+        o.count += count;
+        return true;
+    }
+};
+
+int historyQuery(int id, uint32_t from, uint32_t to, HistoryBucket* out, int buckets) {
+    for (int i = 0; i < buckets; i++) out[i] = {INFINITY, -INFINITY, 0, 0};
+    stats.sectorsRead = stats.headersRead = stats.decoded = stats.rolledUp = 0;
+    if (id < 0 || id >= M_COUNT || buckets <= 0 || to <= from) return 0;
+
+    Binner bin = {from, to, buckets, out};
+    auto add = [&bin](uint32_t t, float v) { bin.add(t, v); };
+
+    for (int s = 0; part && s < sectorCount; s++) {
+        if (spanEmpty(s) || spanMax[s] < from || spanMin[s] >= to) continue;
+        stats.sectorsRead++;
+
+        RecordHeader r;
+        for (uint32_t off = sizeof(SectorHeader); off < sectorEnd[s] && readRecord(s, off, r);
+             off += recordSize(r)) {
+            stats.headersRead++;
+            if (r.metric != id || r.tEnd < from || r.tStart >= to) continue;
+            if (bin.fold(r.tStart, r.tEnd, r.min, r.max, r.sum, r.count)) {
+                stats.rolledUp++;
+                continue;
+            }
+            uint8_t payload[HISTORY_BLOCK_BYTES];
+            if (esp_partition_read(part, s * SECTOR_SIZE + off + sizeof(r), payload,
+                                   (r.bits + 7) / 8) != ESP_OK ||
+                recordCrc(r, payload) != r.crc) {
+                continue;
+            }
+            decodeBlock(payload, r.bits, r.count, r.tStart, r.scale, add);
+            stats.decoded++;
+        }
+    }
+
+    // Samples not sealed yet
+    const Block& b = blocks[id];
+    if (b.count && b.tPrev >= from && b.tStart < to &&
+        !bin.fold(b.tStart, b.tPrev, b.min, b.max, (float)b.sum, b.count)) {
+        decodeBlock(b.data, b.bits, b.count, b.tStart, b.scale, add);
+    }
+
+    int filled = 0;
+    for (int i = 0; i < buckets; i++) {
+        if (out[i].count) {
+            out[i].mean /= out[i].count;
+            filled++;
+        } else {
+            out[i].min = out[i].max = out[i].mean = 0;
+        }
+    }
+    return filled;
+}
+
+const HistoryStats& historyStats() {
+    stats.used = 0;
+    stats.oldest = 0;
+    for (int s = 0; s < sectorCount; s++) {
+        if (spanEmpty(s)) continue;
+        stats.used++;
+        if (!stats.oldest || spanMin[s] < stats.oldest) stats.oldest = spanMin[s];
+    }
+    return stats;
+}
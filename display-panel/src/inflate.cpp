@@ -0,0 +1,460 @@
+#include "inflate.h"
+
+// ============================================
+// RFC 1951 tables
+// ============================================
+static const uint16_t LEN_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LEN_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577};
+static const uint8_t DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+static const uint8_t CODELEN_ORDER[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// CRC-32 (gzip), a nibble at a time to keep the table small
+static const uint32_t CRC_NIBBLE[16] = {
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+    0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+    0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+    0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c};
+
+#define WINDOW_MASK (INFLATE_WINDOW_SIZE - 1)
+
+// ============================================
+// Setup / teardown
+// ============================================
+void InflateStream::begin(Stream& src, Format format) {
+    _src = &src;
+    _format = format;
+    _zlib = false;
+    _state = S_HEADER;
+    _final = false;
+    _peeked = -1;
+    _inPos = _inLen = 0;
+    _bitBuf = 0;
+    _bitCnt = 0;
+    _totalIn = _totalOut = 0;
+    _storedLeft = 0;
+    _copyLen = _copyDist = 0;
+    _crc = 0xFFFFFFFF;
+    _adlerA = 1;
+    _adlerB = 0;
+}
+
+bool InflateStream::finish() {
+    _peeked = -1;
+    while (produce() >= 0) {}
+    return _state == S_DONE;
+}
+
+int InflateStream::fail() {
+    if (_state != S_ERROR) {
+        Serial.printf("Inflate: corrupt stream after %lu bytes in\n", (unsigned long)_totalIn);
+    }
+    _state = S_ERROR;
+    _copyLen = 0;
+    return -1;
+}
+
+// ============================================
+// Input
+// Bytes are only waited for when the decoder actually needs them;
+// look-ahead for the fast table takes just what has arrived
+// ============================================
+int InflateStream::nextByte(bool block) {
+    if (_inPos == _inLen) {
+        int avail = _src->available();
+        size_t n = 0;
+        if (avail > 0) {
+            n = _src->readBytes((char*)_in, min(avail, INFLATE_INPUT_SIZE));
+        } else if (block) {
+            n = _src->readBytes((char*)_in, 1);     // waits up to the stream timeout
+        }
+        if (n == 0) return -1;
+        _inPos = 0;
+        _inLen = n;
+    }
+    _totalIn++;
+    return _in[_inPos++];
+}
+
+bool InflateStream::need(int n) {
+    while (_bitCnt < n) {
+        int c = nextByte(true);
+        if (c < 0) return false;
+        _bitBuf |= (uint32_t)c << _bitCnt;
+        _bitCnt += 8;
+    }
+    return true;
+}
+
+uint32_t InflateStream::bits(int n) {
+    uint32_t v = _bitBuf & ((1u << n) - 1);
+    _bitBuf >>= n;
+    _bitCnt -= n;
+    return v;
+}
+
+// Whole bytes (headers, stored blocks, trailer) after the bit
+// buffer has been aligned
+int InflateStream::alignedByte() {
+    if (_bitCnt >= 8) return bits(8);
+    return nextByte(true);
+}
+
+void InflateStream::put(uint8_t c) {
+    _window[_totalOut & WINDOW_MASK] = c;
+    _totalOut++;
+    if (_format == GZIP) {
+        _crc ^= c;
+        _crc = (_crc >> 4) ^ CRC_NIBBLE[_crc & 15];
+        _crc = (_crc >> 4) ^ CRC_NIBBLE[_crc & 15];
+    } else if (_zlib) {
+        _adlerA += c;
+        if (_adlerA >= 65521) _adlerA -= 65521;
+        _adlerB += _adlerA;
+        if (_adlerB >= 65521) _adlerB -= 65521;
+    }
+}
+
+// ============================================
+// Huffman codes
+// ============================================
+bool InflateStream::build(Huffman& h, const uint8_t* lengths, int n) {
+    memset(h.count, 0, sizeof(h.count));
+    for (int s = 0; s < n; s++) h.count[lengths[s]]++;
+    h.count[0] = 0;
+
+    // Over-subscribed sets can't be decoded; incomplete ones are
+    // legal (single distance code) and fail only if actually hit
+    int left = 1;
+    for (int len = 1; len < 16; len++) {
+        left <<= 1;
+        left -= h.count[len];
+        if (left < 0) return false;
+    }
+
+    uint16_t offs[16];
+    uint16_t next[16];
+    offs[1] = 0;
+    for (int len = 1; len < 15; len++) offs[len + 1] = offs[len] + h.count[len];
+    uint16_t code = 0;
+    for (int len = 1; len < 16; len++) {
+        code = (code + h.count[len - 1]) << 1;
+        next[len] = code;
+    }
+
+    memset(h.fast, 0, sizeof(h.fast));
+    for (int s = 0; s < n; s++) {
+        int len = lengths[s];
+        if (len == 0) continue;
+        h.symbol[offs[len]++] = s;
+
+        // Codes arrive bit-reversed (LSB first), so index by the
+        // reversed code and fill every slot it prefixes
+        uint16_t c = next[len]++;
+        if (len > INFLATE_FAST_BITS) continue;
+        uint16_t rev = 0;
+        for (int i = 0; i < len; i++) rev |= ((c >> i) & 1) << (len - 1 - i);
+        for (int i = rev; i < (1 << INFLATE_FAST_BITS); i += 1 << len) {
+            h.fast[i] = (len << 9) | s;
+        }
+    }
+    return true;
+}
+
+int InflateStream::decode(const Huffman& h) {
+    while (_bitCnt <= 24) {
+        int c = nextByte(false);
+        if (c < 0) break;
+        _bitBuf |= (uint32_t)c << _bitCnt;
+        _bitCnt += 8;
+    }
+
+    uint16_t e = h.fast[_bitBuf & ((1 << INFLATE_FAST_BITS) - 1)];
+    if (e && (e >> 9) <= _bitCnt) {
+        bits(e >> 9);
+        return e & 0x1FF;
+    }
+
+    // Long code, or short on input: canonical decode a bit at a time
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len < 16; len++) {
+        if (!need(1)) return -1;
+        code |= bits(1);
+        int count = h.count[len];
+        if (code - count < first) return h.symbol[index + (code - first)];
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+// ============================================
+// Stream framing
+// ============================================
+bool InflateStream::header() {
+    if (_format == DEFLATE) {
+        // "deflate" should be zlib-wrapped, but some servers send
+        // raw deflate; tell them apart by the zlib header check
+        if (!need(16)) return false;
+        uint8_t cmf = _bitBuf & 0xFF, flg = (_bitBuf >> 8) & 0xFF;
+        if ((cmf & 0x0F) == 8 && (cmf >> 4) <= 7 && ((cmf << 8) | flg) % 31 == 0 && !(flg & 0x20)) {
+            _zlib = true;
+            bits(16);
+        }
+        return true;
+    }
+
+    if (alignedByte() != 0x1F || alignedByte() != 0x8B || alignedByte() != 8) return false;
+    int flags = alignedByte();
+    if (flags < 0 || (flags & 0xE0)) return false;
+    for (int i = 0; i < 6; i++) {           // mtime, xfl, os
+        if (alignedByte() < 0) return false;
+    }
+    if (flags & 0x04) {                     // FEXTRA
+        int lo = alignedByte(), hi = alignedByte();
+        if (lo < 0 || hi < 0) return false;
+        for (int n = lo | (hi << 8); n > 0; n--) {
+            if (alignedByte() < 0) return false;
+        }
+    }
+    for (int f = 0x08; f <= 0x10; f <<= 1) {    // FNAME, FCOMMENT
+        if (!(flags & f)) continue;
+        int c;
+        do {
+            c = alignedByte();
+            if (c < 0) return false;
+        } while (c != 0);
+    }
+    if (flags & 0x02) {                     // FHCRC
+        if (alignedByte() < 0 || alignedByte() < 0) return false;
+    }
+    return true;
+}
+
+bool InflateStream::trailer() {
+    bits(_bitCnt & 7);
+    if (_format == GZIP) {
+        uint32_t v[2] = {0, 0};
+        for (int w = 0; w < 2; w++) {
+            for (int i = 0; i < 4; i++) {
+                int c = alignedByte();
+                if (c < 0) return false;
+                v[w] |= (uint32_t)c << (8 * i);
+            }
+        }
+        return v[0] == (_crc ^ 0xFFFFFFFF) && v[1] == _totalOut;
+    }
+    if (_zlib) {
+        uint32_t adler = 0;
+        for (int i = 0; i < 4; i++) {
+            int c = alignedByte();
+            if (c < 0) return false;
+            adler = (adler << 8) | c;
+        }
+        return adler == ((_adlerB << 16) | _adlerA);
+    }
+    return true;
+}
+
+// ============================================
+// Blocks
+// ============================================
+bool InflateStream::blockHeader() {
+    if (!need(3)) return false;
+    _final = bits(1);
+    int type = bits(2);
+
+    if (type == 0) {
+        bits(_bitCnt & 7);
+        int b[4];
+        for (int i = 0; i < 4; i++) {
+            b[i] = alignedByte();
+            if (b[i] < 0) return false;
+        }
+        uint16_t len = b[0] | (b[1] << 8);
+        uint16_t nlen = b[2] | (b[3] << 8);
+        if (len != (uint16_t)~nlen) return false;
+        _storedLeft = len;
+        _state = S_STORED;
+        return true;
+    }
+
+    if (type == 1) {
+        for (int s = 0; s < 288; s++) {
+            _lengths[s] = s < 144 ? 8 : s < 256 ? 9 : s < 280 ? 7 : 8;
+        }
+        build(_lencode, _lengths, 288);
+        memset(_lengths, 5, 30);
+        build(_distcode, _lengths, 30);
+        _state = S_HUFF;
+        return true;
+    }
+
+    if (type == 2 && dynamicTables()) {
+        _state = S_HUFF;
+        return true;
+    }
+    return false;
+}
+
+bool InflateStream::dynamicTables() {
+    if (!need(14)) return false;
+    int nlen = bits(5) + 257;
+    int ndist = bits(5) + 1;
+    int ncode = bits(4) + 4;
+    if (nlen > 286 || ndist > 30) return false;
+
+    memset(_lengths, 0, 19);
+    for (int i = 0; i < ncode; i++) {
+        if (!need(3)) return false;
+        _lengths[CODELEN_ORDER[i]] = bits(3);
+    }
+    if (!build(_lencode, _lengths, 19)) return false;
+
+    int index = 0;
+    while (index < nlen + ndist) {
+        int sym = decode(_lencode);
+        if (sym < 0) return false;
+        if (sym < 16) {
+            _lengths[index++] = sym;
+            continue;
+        }
+
+        uint8_t len = 0;
+        int rep;
+        if (sym == 16) {
+            if (index == 0 || !need(2)) return false;
+            len = _lengths[index - 1];
+            rep = 3 + bits(2);
+        } else if (sym == 17) {
+            if (!need(3)) return false;
+            rep = 3 + bits(3);
+        } else {
+            if (!need(7)) return false;
+            rep = 11 + bits(7);
+        }
+        if (index + rep > nlen + ndist) return false;
+        while (rep--) _lengths[index++] = len;
+    }
+
+    if (_lengths[256] == 0) return false;       // no end-of-block code
+    return build(_lencode, _lengths, nlen) && build(_distcode, _lengths + nlen, ndist);
+}
+
+// ============================================
+// Decoder: one output byte per call
+// ============================================
+int InflateStream::produce() {
+    for (;;) {
+        if (_copyLen) {
+            uint8_t c = _window[(_totalOut - _copyDist) & WINDOW_MASK];
+            put(c);
+            _copyLen--;
+            return c;
+        }
+
+        switch (_state) {
+        case S_HEADER:
+            if (!header()) return fail();
+            _state = S_BLOCK;
+            break;
+
+        case S_BLOCK:
+            if (_final) {
+                _state = S_TRAILER;
+            } else if (!blockHeader()) {
+                return fail();
+            }
+            break;
+
+        case S_STORED: {
+            if (_storedLeft == 0) {
+                _state = S_BLOCK;
+                break;
+            }
+            int c = alignedByte();
+            if (c < 0) return fail();
+            _storedLeft--;
+            put(c);
+            return c;
+        }
+
+        case S_HUFF: {
+            int sym = decode(_lencode);
+            if (sym < 0) return fail();
+            if (sym < 256) {
+                put(sym);
+                return sym;
+            }
+            if (sym == 256) {
+                _state = S_BLOCK;
+                break;
+            }
+
+            sym -= 257;
+            if (sym >= 29 || !need(LEN_EXTRA[sym])) return fail();
+            int len = LEN_BASE[sym] + bits(LEN_EXTRA[sym]);
+
+            int dsym = decode(_distcode);
+            if (dsym < 0 || dsym >= 30 || !need(DIST_EXTRA[dsym])) return fail();
+            uint32_t dist = DIST_BASE[dsym] + bits(DIST_EXTRA[dsym]);
+            if (dist > _totalOut || dist > INFLATE_WINDOW_SIZE) return fail();
+
+            _copyLen = len;
+            _copyDist = dist;
+            break;
+        }
+
+        case S_TRAILER:
+            if (!trailer()) return fail();
+            _state = S_DONE;
+            return -1;
+
+        case S_DONE:
+        case S_ERROR:
+            return -1;
+        }
+    }
+}
+
+// ============================================
+// Stream interface
+// ============================================
+int InflateStream::available() {
+    return (_peeked >= 0 || _copyLen || (_state != S_DONE && _state != S_ERROR)) ? 1 : 0;
+}
+
+int InflateStream::read() {
+    if (_peeked >= 0) {
+        int c = _peeked;
+        _peeked = -1;
+        return c;
+    }
+    return produce();
+}
+
+int InflateStream::peek() {
+    if (_peeked < 0) _peeked = produce();
+    return _peeked;
+}
+
+size_t InflateStream::readBytes(char* buf, size_t len) {
+    size_t n = 0;
+    while (n < len) {
+        int c = read();
+        if (c < 0) break;
+        buf[n++] = (char)c;
+    }
+    return n;
+}
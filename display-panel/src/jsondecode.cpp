@@ -0,0 +1,317 @@
+#include "jsondecode.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================
+// Decoder state for one response (lives on the caller's stack)
+// ============================================
+class Decoder {
+public:
+    Decoder(Stream& in, const JsonSchema& schema, uint8_t* out)
+        : _in(in), _schema(schema), _out(out) {}
+
+    bool run() { return value(0, 0); }
+
+private:
+    int  next();
+    int  nextToken();
+    void unget() { _pos--; }
+
+    void lookup(int pathLen, const JsonField*& field, const JsonField*& list, bool& inner) const;
+    bool value(int pathLen, int depth);
+    bool object(int pathLen, int depth);
+    bool array(int pathLen, int depth, const JsonField* f);
+    bool skip(int c);
+    bool string(char* dst, size_t cap, size_t* len = nullptr);
+    bool number(int c, double* v);
+    bool literal(int c);
+    void store(const JsonField* f, double v);
+
+    Stream&           _in;
+    const JsonSchema& _schema;
+    uint8_t*          _out;
+
+    char     _buf[JSON_READ_CHUNK];
+    uint8_t  _pos = 0;
+    uint8_t  _len = 0;
+
+    char     _path[JSON_PATH_MAX + 1];
+    const JsonField* _array = nullptr;  // array being filled
+    int      _index = 0;                // its current element
+};
+
+// ============================================
+// Input
+// Whole chunks only when the stream already has them, so the
+// closing brace never waits on a read timeout
+// ============================================
+int Decoder::next() {
+    if (_pos == _len) {
+        int avail = _in.available();
+        size_t want = (avail > 1) ? min(avail, JSON_READ_CHUNK) : 1;
+        _len = _in.readBytes(_buf, want);
+        _pos = 0;
+        if (_len == 0) return -1;
+    }
+    return (uint8_t)_buf[_pos++];
+}
+
+int Decoder::nextToken() {
+    int c;
+    do {
+        c = next();
+    } while (c == ' ' || c == '\n' || c == '\r' || c == '\t');
+    return c;
+}
+
+// ============================================
+// Schema lookup for the current path
+// field = exact match; list = array declared here ("path[]");
+// inner = some field lies below this path
+// ============================================
+void Decoder::lookup(int pathLen, const JsonField*& field, const JsonField*& list,
+                     bool& inner) const {
+    field = nullptr;
+    list = nullptr;
+    inner = false;
+    for (int i = 0; i < _schema.count; i++) {
+        const JsonField* f = &_schema.fields[i];
+        if (strncmp(f->path, _path, pathLen) != 0) continue;
+        const char* after = f->path + pathLen;
+        if (*after == '\0') {
+            field = f;
+        } else if (pathLen == 0 || *after == '.' || *after == '[') {
+            inner = true;
+            if (f->type == JF_ARRAY && strcmp(after, "[]") == 0) list = f;
+        }
+    }
+}
+
+void Decoder::store(const JsonField* f, double v) {
+    uint8_t* dst = _out + f->offset;
+    if (_array) dst += _index * _array->size;
+    if (f->type == JF_NUMBER) {
+        memcpy(dst, &v, sizeof(v));
+    } else if (f->type == JF_INT) {
+        int32_t i = (int32_t)v;
+        memcpy(dst, &i, sizeof(i));
+    }
+}
+
+// ============================================
+// Values on a tracked path
+// ============================================
+bool Decoder::value(int pathLen, int depth) {
+    int c = nextToken();
+    const JsonField* f;
+    const JsonField* list;
+    bool inner;
+    lookup(pathLen, f, list, inner);
+
+    if (c == '{' && inner && depth < JSON_DEPTH_MAX) return object(pathLen, depth + 1);
+    if (c == '[' && list && !_array && depth < JSON_DEPTH_MAX) return array(pathLen, depth + 1, list);
+
+    if (c == '"' && f && f->type == JF_STRING) {
+        char* dst = (char*)_out + f->offset;
+        if (_array) dst += _index * _array->size;
+        return string(dst, f->size);
+    }
+    if (f && (f->type == JF_NUMBER || f->type == JF_INT) && (c == '-' || (c >= '0' && c <= '9'))) {
+        double v;
+        if (!number(c, &v)) return false;
+        store(f, v);
+        return true;
+    }
+    return skip(c);
+}
+
+bool Decoder::object(int pathLen, int depth) {
+    int c = nextToken();
+    if (c == '}') return true;
+
+    for (;;) {
+        if (c != '"') return false;
+
+        // Key goes straight onto the path; too long = not ours
+        int keyAt = pathLen ? pathLen + 1 : 0;
+        size_t keyLen;
+        bool fits = keyAt < JSON_PATH_MAX;
+        if (fits) {
+            if (pathLen) _path[pathLen] = '.';
+            if (!string(_path + keyAt, JSON_PATH_MAX + 1 - keyAt, &keyLen)) return false;
+            fits = keyAt + keyLen < JSON_PATH_MAX;
+        } else if (!string(nullptr, 0)) {
+            return false;
+        }
+
+        if (nextToken() != ':') return false;
+        if (fits) {
+            if (!value(keyAt + keyLen, depth)) return false;
+        } else {
+            if (!skip(nextToken())) return false;
+        }
+
+        c = nextToken();
+        if (c == '}') return true;
+        if (c != ',') return false;
+        c = nextToken();
+    }
+}
+
+bool Decoder::array(int pathLen, int depth, const JsonField* f) {
+    if (pathLen + 2 > JSON_PATH_MAX) return skip('[');
+    _path[pathLen] = '[';
+    _path[pathLen + 1] = ']';
+
+    _array = f;
+    _index = 0;
+    int c = nextToken();
+    bool ok = true;
+    if (c != ']') {
+        for (;;) {
+            // Body ended inside the array: nothing to put back
+            if (c < 0) { ok = false; break; }
+            unget();
+            if (_index < f->count) ok = value(pathLen + 2, depth);
+            else ok = skip(nextToken());
+            if (!ok) break;
+            _index++;
+
+            c = nextToken();
+            if (c == ']') break;
+            if (c != ',') { ok = false; break; }
+            c = nextToken();
+        }
+    }
+    _array = nullptr;
+
+    int32_t stored = min(_index, (int)f->count);
+    memcpy(_out + f->offset, &stored, sizeof(stored));
+    return ok;
+}
+
+// ============================================
+// Untracked subtree: walk it without keeping anything
+// ============================================
+bool Decoder::skip(int c) {
+    if (c == '"') return string(nullptr, 0);
+    if (c == '-' || (c >= '0' && c <= '9')) return number(c, nullptr);
+    if (c != '{' && c != '[') return literal(c);
+
+    int depth = 1;
+    while (depth > 0) {
+        c = next();
+        if (c < 0) return false;
+        if (c == '"') {
+            if (!string(nullptr, 0)) return false;
+        } else if (c == '{' || c == '[') {
+            depth++;
+        } else if (c == '}' || c == ']') {
+            depth--;
+        }
+    }
+    return true;
+}
+
+// ============================================
+// Scalars
+// ============================================
+
+// Opening quote already consumed. dst = nullptr discards.
+bool Decoder::string(char* dst, size_t cap, size_t* len) {
+    size_t n = 0;
+    for (;;) {
+        int c = next();
+        if (c < 0) return false;
+        if (c == '"') break;
+
+        char utf8[3];
+        int units = 1;
+        utf8[0] = (char)c;
+        if (c == '\\') {
+            c = next();
+            switch (c) {
+                case 'b': utf8[0] = '\b'; break;
+                case 'f': utf8[0] = '\f'; break;
+                case 'n': utf8[0] = '\n'; break;
+                case 'r': utf8[0] = '\r'; break;
+                case 't': utf8[0] = '\t'; break;
+                case '"': case '\\': case '/': utf8[0] = (char)c; break;
+                case 'u': {
+                    uint16_t cp = 0;
+                    for (int i = 0; i < 4; i++) {
+                        c = next();
+                        int digit = (c >= '0' && c <= '9') ? c - '0'
+                                  : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+                                  : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+                        if (digit < 0) return false;
+                        cp = (cp << 4) | digit;
+                    }
+                    // Basic plane only; surrogate halves become '?'
+                    if (cp < 0x80) {
+                        utf8[0] = (char)cp;
+                    } else if (cp < 0x800) {
+                        utf8[0] = (char)(0xC0 | (cp >> 6));
+                        utf8[1] = (char)(0x80 | (cp & 0x3F));
+                        units = 2;
+                    } else if (cp >= 0xD800 && cp <= 0xDFFF) {
+                        utf8[0] = '?';
+                    } else {
+                        utf8[0] = (char)(0xE0 | (cp >> 12));
+                        utf8[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                        utf8[2] = (char)(0x80 | (cp & 0x3F));
+                        units = 3;
+                    }
+                    break;
+                }
+                default: return false;
+            }
+        }
+
+        // Never split a multi-byte character when truncating
+        if (dst && n + units < cap) {
+            memcpy(dst + n, utf8, units);
+            n += units;
+        } else if (dst) {
+            cap = n + 1;
+        }
+    }
+    if (dst && cap > 0) dst[n] = '\0';
+    if (len) *len = n;
+    return true;
+}
+
+bool Decoder::number(int c, double* v) {
+    char text[32];
+    int n = 0;
+    while (c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E' || (c >= '0' && c <= '9')) {
+        if (n == sizeof(text) - 1) return false;
+        text[n++] = (char)c;
+        c = next();
+    }
+    if (c >= 0) unget();
+    text[n] = '\0';
+
+    char* end;
+    double parsed = strtod(text, &end);
+    if (end != text + n) return false;
+    if (v) *v = parsed;
+    return true;
+}
+
+bool Decoder::literal(int c) {
+    const char* rest = (c == 't') ? "rue" : (c == 'f') ? "alse" : (c == 'n') ? "ull" : nullptr;
+    if (!rest) return false;
+    for (; *rest; rest++) {
+        if (next() != *rest) return false;
+    }
+    return true;
+}
+
+// ============================================
+// Public API
+// ============================================
+bool jsonDecode(Stream& in, const JsonSchema& schema, void* out) {
+    Decoder d(in, schema, (uint8_t*)out);
+    return d.run();
+}
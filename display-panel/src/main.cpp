@@ -1,55 +1,226 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <WiFiManager.h>
+#include <esp_sntp.h>
 #include <time.h>
 #include "config.h"
 #include "displays.h"
+#include "history.h"
 #include "screens.h"
+#include "pipeline.h"
+#include "adsbfeed.h"
+#include "snapshot.h"
+#include "statsserver.h"
+#include "trace.h"
 
 // ============================================
-// Timing
+// Scheduled panels
+// Sources that need the network wait for the link, then fetch
+// immediately and every interval after that
 // ============================================
-static unsigned long lastClock    = 0;
-static unsigned long lastUnraid   = 0;
-static unsigned long lastM900     = 0;
-static unsigned long lastPi       = 0;
-static unsigned long lastServices = 0;
-static unsigned long lastCustom   = 0;
+struct PanelTask {
+    void (*fetch)();        // nullptr = draw only
+    DrawFn draw;            // nullptr = fetch only (panel shows something else)
+    int panel;
+    unsigned long interval;
+    unsigned long last;
+    bool started;
+};
+
+static PanelTask tasks[] = {
+    {nullptr,       drawClock,    SCREEN_CLOCK,    CLOCK_UPDATE_MS,    0, false},
+    {fetchUnraid,   drawUnraid,   SCREEN_UNRAID,   UNRAID_UPDATE_MS,   0, false},
+    {fetchM900,     drawM900,     SCREEN_M900,     M900_UPDATE_MS,     0, false},
+#if RADAR_SCREEN
+    {fetchPiHealth, nullptr,      SCREEN_PIHEALTH, PI_UPDATE_MS,       0, false},
+    {fetchRadar,    drawRadar,    SCREEN_RADAR,    RADAR_UPDATE_MS,    0, false},
+#else
+    {fetchPiHealth, drawPiHealth, SCREEN_PIHEALTH, PI_UPDATE_MS,       0, false},
+#endif
+    {fetchServices, drawServices, SCREEN_SERVICES, SERVICES_UPDATE_MS, 0, false},
+#if DNS_SCREEN
+    {fetchPihole,   drawPihole,   SCREEN_DNS,      PIHOLE_UPDATE_MS,   0, false},
+#if SWITCH_SCREEN
+    {fetchSwitches, nullptr,      SCREEN_SWITCH,   SWITCH_UPDATE_MS,   0, false},
+#endif
+#elif SWITCH_SCREEN
+    {fetchSwitches, drawSwitches, SCREEN_SWITCH,   SWITCH_UPDATE_MS,   0, false},
+#else
+    {fetchCustom,   drawCustom,   SCREEN_CUSTOM,   CUSTOM_UPDATE_MS,   0, false},
+#endif
+};
+static const int NUM_TASKS = sizeof(tasks) / sizeof(tasks[0]);
+
+static unsigned long lastStats    = 0;
+static unsigned long lastSnapshot = 0;
+static unsigned long lastScroll   = 0;
 
 // ============================================
-// WiFi setup via captive portal
+// Boot state machine
+// Nothing in setup() waits on the network: panels come up first,
+// WiFi and NTP progress in the background driven by events, and
+// loop() advances the state as they arrive
 // ============================================
-void setupWiFi() {
-    WiFiManager wm;
-    wm.setConfigPortalTimeout(180);
-    wm.setConnectTimeout(30);
+enum BootState {
+    BOOT_CONNECTING,    // trying saved credentials
+    BOOT_PORTAL,        // captive portal open, non-blocking
+    BOOT_ONLINE,
+};
+
+static BootState bootState = BOOT_CONNECTING;
+static WiFiManager wm;
+static unsigned long stateSince = 0;
+
+static volatile bool linkUp     = false;   // WiFi event task
+static volatile bool timeSynced = false;   // SNTP task
+
+// Milliseconds since power-on for each boot milestone (0 = not yet)
+static unsigned long bootDisplaysMs = 0;
+static unsigned long bootLinkMs     = 0;
+static unsigned long bootTimeMs     = 0;
+static unsigned long bootFirstLive  = 0;
+
+static void onWiFiEvent(WiFiEvent_t event) {
+    if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) linkUp = true;
+    if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) linkUp = false;
+}
+
+static void onTimeSync(struct timeval*) {
+    timeSynced = true;
+}
+
+static void enterState(BootState s, const char* status) {
+    bootState = s;
+    stateSince = millis();
+    setBootStatus(status);
+}
 
-    if (!wm.autoConnect("RackDisplay", "rackdisplay")) {
-        Serial.println("WiFi failed, restarting...");
-        ESP.restart();
+// The stats server shares port 80 with the portal's web server, so
+// it starts only once the portal is closed (or was never needed)
+static void goOnline() {
+    enterState(BOOT_ONLINE, "NTP...");
+    startStatsServer();
+}
+
+static void bootStep(unsigned long now) {
+    switch (bootState) {
+    case BOOT_CONNECTING:
+        if (linkUp) {
+            goOnline();
+        } else if (!wm.getWiFiIsSaved() || now - stateSince >= WIFI_CONNECT_MS) {
+            // Portal runs alongside the panels instead of blocking them
+            Serial.println("WiFi: opening portal \"RackDisplay\"");
+            wm.setConfigPortalBlocking(false);
+            wm.startConfigPortal("RackDisplay", "rackdisplay");
+            enterState(BOOT_PORTAL, "Setup WiFi");
+        }
+        break;
+
+    case BOOT_PORTAL:
+        wm.process();
+        if (linkUp) {
+            wm.stopConfigPortal();
+            goOnline();
+        } else if (now - stateSince >= WIFI_PORTAL_MS) {
+            Serial.println("WiFi failed, restarting...");
+            historySeal();
+            ESP.restart();
+        }
+        break;
+
+    case BOOT_ONLINE:
+        break;
     }
 
-    Serial.print("Connected. IP: ");
-    Serial.println(WiFi.localIP());
+    if (linkUp && !bootLinkMs) {
+        bootLinkMs = now;
+        Serial.print("Connected. IP: ");
+        Serial.println(WiFi.localIP());
+    }
+    if (timeSynced && !bootTimeMs) {
+        bootTimeMs = now;
+        Serial.printf("Boot: NTP synced at %lums\n", bootTimeMs);
+    }
+}
+
+// Power-on to the first gauge drawn from live data
+static void checkFirstLive() {
+    if (bootFirstLive || !screensLive()) return;
+    bootFirstLive = millis();
+    Serial.printf("Boot: first live gauge at %lums "
+                  "(displays %lums, link %lums)\n",
+                  bootFirstLive, bootDisplaysMs, bootLinkMs);
 }
 
 // ============================================
-// NTP time sync (Mountain Time)
+// Boot splash through the pipeline
+// The ring is drawn once, copied into every framebuffer and
+// broadcast to all six panels in one transfer; after that only
+// each label's box goes out
 // ============================================
-void setupTime() {
-    configTzTime("MST7MDT,M3.2.0,M11.1.0", "pool.ntp.org", "time.nist.gov");
+static void showSplash(const char* const labels[NUM_DISPLAYS]) {
+    for (int i = 0; i < NUM_DISPLAYS; i++) beginFrame(i);
+    drawBootSplash(0);
+    for (int i = 1; i < NUM_DISPLAYS; i++) {
+        memcpy(frames[i]->getBuffer(), frames[0]->getBuffer(), frames[0]->bufferLength());
+    }
+    submitBroadcast(0, PANEL_MASK_ALL);
 
-    Serial.print("Syncing time");
-    struct tm timeinfo;
-    int attempts = 0;
-    while (!getLocalTime(&timeinfo) && attempts < 10) {
-        Serial.print(".");
-        delay(500);
-        attempts++;
+    // Panel 0 last: its framebuffer is held until the broadcast is out
+    for (int i = NUM_DISPLAYS - 1; i >= 0; i--) {
+        int x, y, w, h;
+        beginFrame(i);
+        drawBootLabel(i, labels[i], x, y, w, h);
+        submitRect(i, x, y, w, h);
     }
-    Serial.println(" done");
 }
 
+// ============================================
+// Services list
+// Redrawn a row at a time rather than whole: each change (or the
+// scroll step) goes out as its own small job, with the list's
+// hardware scroll ahead of it
+// ============================================
+static void updateServicesPanel(bool scroll) {
+    int x, y, w, h;
+    beginFrame(SCREEN_SERVICES);
+    while (updateServices(SCREEN_SERVICES, scroll, x, y, w, h)) {
+        scrollFrame(SCREEN_SERVICES, servicesScroll());
+        submitRect(SCREEN_SERVICES, x, y, w, h);
+        scroll = false;
+        beginFrame(SCREEN_SERVICES);
+    }
+}
+
+// ============================================
+// Pipeline utilisation report
+// Whichever stage sits near 100% is the one limiting refresh
+// ============================================
+static void logPipelineStats() {
+    PipelineStats s = pipelineTakeStats();
+    if (s.windowUs == 0) return;
+    Serial.printf("Pipeline: %lu frames, render %.1f%% (wait %.1f%%), flush %.1f%%\n",
+                  (unsigned long)s.frames,
+                  100.0f * s.renderBusyUs / s.windowUs,
+                  100.0f * s.renderWaitUs / s.windowUs,
+                  100.0f * s.flushBusyUs / s.windowUs);
+}
+
+// ============================================
+// Trace dump over USB serial: send 't'
+// ============================================
+#if TRACE_ENABLED
+static void writeSerial(void*, const char* data, size_t len) {
+    Serial.write((const uint8_t*)data, len);
+}
+
+static void checkTraceRequest() {
+    while (Serial.available()) {
+        if (Serial.read() == 't') traceDump(writeSerial, nullptr);
+    }
+}
+#endif
+
 // ============================================
 // Setup
 // ============================================
@@ -59,42 +230,48 @@ void setup() {
 
     // Init all 6 displays
     initDisplays();
+    startPipeline();
+    bootDisplaysMs = millis();
     Serial.println("Displays initialized");
+    setupCustom();
 
-    // Boot splash
-    const char* labels[] = {
-        "UNRAID", "M900", "PI RACK",
-        "SERVICES", "NETWORK", "CLOCK"
-    };
-    for (int i = 0; i < NUM_DISPLAYS; i++) {
-        drawBootSplash(i, labels[i]);
+    // Warm start: last-known frames/metrics from flash, marked
+    // stale; boot splash only if there is no snapshot
+    int painted = restoreSnapshot();
+    if (painted < 0) {
+        const char* labels[] = {
+            "UNRAID", "M900", RADAR_SCREEN ? "RADAR" : "PI RACK",
+            "SERVICES", DNS_SCREEN ? "PI-HOLE" : "NETWORK", "CLOCK"
+        };
+        showSplash(labels);
+    } else {
+        for (int i = 0; i < NUM_TASKS; i++) {
+            int p = tasks[i].panel;
+            if (tasks[i].fetch && tasks[i].draw && !(painted & (1 << p))) {
+                renderPanel(p, tasks[i].draw);
+            }
+        }
     }
 
-    // WiFi
-    drawBootSplash(SCREEN_CLOCK, "WiFi...");
-    setupWiFi();
-    drawBootSplash(SCREEN_CLOCK, "WiFi OK");
-
-    // Time
-    drawBootSplash(SCREEN_CLOCK, "NTP...");
-    setupTime();
-
-    // Initial data fetch
-    Serial.println("Fetching initial data...");
-    fetchUnraid();
-    fetchM900();
-    fetchPiHealth();
-    fetchServices();
-    fetchCustom();
-
-    // Draw all screens once
-    drawUnraid(SCREEN_UNRAID);
-    drawM900(SCREEN_M900);
-    drawPiHealth(SCREEN_PIHEALTH);
-    drawServices(SCREEN_SERVICES);
-    drawCustom(SCREEN_CUSTOM);
-    drawClock(SCREEN_CLOCK);
+    // Metric history: samples are appended once NTP has the time
+    historyBegin();
+
+    // WiFi with saved credentials; portal only if that fails
+    WiFi.onEvent(onWiFiEvent);
+    WiFi.mode(WIFI_STA);
+    publishStats();
+#if RADAR_SCREEN
+    startAdsbFeed();
+#endif
+    WiFi.setAutoReconnect(true);
+    WiFi.begin();
+    enterState(BOOT_CONNECTING, "WiFi...");
 
+    // NTP (Mountain Time) syncs whenever the link allows
+    sntp_set_time_sync_notification_cb(onTimeSync);
+    configTzTime("MST7MDT,M3.2.0,M11.1.0", "pool.ntp.org", "time.nist.gov");
+
+    lastSnapshot = millis();
     Serial.println("Running.");
 }
 
@@ -102,48 +279,58 @@ void setup() {
 // Main loop
 // ============================================
 void loop() {
+    TRACE_SCOPE("loop");
     unsigned long now = millis();
 
-    // Clock - every second
-    if (now - lastClock >= CLOCK_UPDATE_MS) {
-        lastClock = now;
-        drawClock(SCREEN_CLOCK);
-    }
+    TRACE_BEGIN("boot step");
+    bootStep(now);
+    TRACE_END("boot step");
 
-    // Unraid - every 15 seconds
-    if (now - lastUnraid >= UNRAID_UPDATE_MS) {
-        lastUnraid = now;
-        fetchUnraid();
-        drawUnraid(SCREEN_UNRAID);
-    }
+    // Panels - at most one fetch per pass so the clock keeps ticking
+    for (int i = 0; i < NUM_TASKS; i++) {
+        PanelTask& t = tasks[i];
+        if (t.fetch && !linkUp) continue;
+        if (t.started && now - t.last < t.interval) continue;
 
-    // M900 - every 10 seconds
-    if (now - lastM900 >= M900_UPDATE_MS) {
-        lastM900 = now;
-        fetchM900();
-        drawM900(SCREEN_M900);
+        t.last = now;
+        t.started = true;
+        if (t.fetch) t.fetch();
+        if (t.panel == SCREEN_SERVICES) updateServicesPanel(false);
+        else if (t.draw) renderPanel(t.panel, t.draw);
+        if (t.fetch) {
+            TRACE_BEGIN("publish");
+            publishStats();
+            TRACE_END("publish");
+            TRACE_BEGIN("history");
+            historyRecord();
+            TRACE_END("history");
+            checkFirstLive();
+            break;
+        }
     }
 
-    // Pi health - every 15 seconds
-    if (now - lastPi >= PI_UPDATE_MS) {
-        lastPi = now;
-        fetchPiHealth();
-        drawPiHealth(SCREEN_PIHEALTH);
+    // Services list: one row of hardware scroll
+    if (now - lastScroll >= SERVICES_SCROLL_MS) {
+        lastScroll = now;
+        updateServicesPanel(true);
     }
 
-    // Services - every 30 seconds
-    if (now - lastServices >= SERVICES_UPDATE_MS) {
-        lastServices = now;
-        fetchServices();
-        drawServices(SCREEN_SERVICES);
+    // Pipeline utilisation
+    if (now - lastStats >= PIPELINE_STATS_MS) {
+        lastStats = now;
+        logPipelineStats();
     }
 
-    // Custom (network) - every 10 seconds
-    if (now - lastCustom >= CUSTOM_UPDATE_MS) {
-        lastCustom = now;
-        fetchCustom();
-        drawCustom(SCREEN_CUSTOM);
+    // Warm-start snapshot
+    if (now - lastSnapshot >= SNAPSHOT_SAVE_MS) {
+        lastSnapshot = now;
+        TRACE_SCOPE("snapshot");
+        saveSnapshot();
     }
 
+#if TRACE_ENABLED
+    checkTraceRequest();
+#endif
+
     delay(10);
 }
@@ -0,0 +1,62 @@
+#include "metrics.h"
+#include "config.h"
+#include "seqlock.h"
+#include <Arduino.h>
+
+static MetricStore staging;             // loop task only
+static Seqlock<MetricStore> published;
+
+// A value is stale once it is older than three polls of its source
+static uint32_t maxAgeMs(uint8_t src) {
+    if (src == SRC_UNRAID) return 3 * UNRAID_UPDATE_MS;
+    if (src == SRC_M900) return 3 * M900_UPDATE_MS;
+    if (src >= SRC_PI && src < SRC_PI + METRIC_PIS) return 3 * PI_UPDATE_MS;
+    if (src == SRC_KUMA) return 3 * SERVICES_UPDATE_MS;
+    if (src >= SRC_SWITCH && src < SRC_SWITCH + METRIC_SWITCHES) return 3 * SWITCH_UPDATE_MS;
+    if (src == SRC_ADSB) return 3 * RADAR_UPDATE_MS;
+    if (src == SRC_PIHOLE) return 3 * PIHOLE_UPDATE_MS;
+    return 0;
+}
+
+// ============================================
+// Writer side
+// ============================================
+void metricSet(int id, double value, MetricSource src) {
+    staging.value[id] = value;
+    staging.sampledMs[id] = millis();
+    staging.state[id] = MS_LIVE;
+    staging.source[id] = src;
+}
+
+void metricMarkStale(int id, int count) {
+    for (int i = id; i < id + count; i++) {
+        if (staging.state[i] != MS_EMPTY) staging.state[i] = MS_STALE;
+    }
+}
+
+void metricRestore(int id, double value) {
+    staging.value[id] = value;
+    staging.sampledMs[id] = 0;
+    staging.state[id] = MS_STALE;
+    staging.source[id] = SRC_SNAPSHOT;
+}
+
+void metricsPublish() {
+    published.write(staging);
+}
+
+// ============================================
+// Reader side
+// ============================================
+uint32_t metricsRead(MetricStore& out) {
+    return published.read(out);
+}
+
+uint32_t metricsSequence() {
+    return published.sequence();
+}
+
+bool metricStale(const MetricStore& m, int id, uint32_t nowMs) {
+    if (m.state[id] != MS_LIVE) return true;
+    return nowMs - m.sampledMs[id] > maxAgeMs(m.source[id]);
+}
@@ -0,0 +1,148 @@
+#include "pipeline.h"
+#include "displays.h"
+#include "spsc_queue.h"
+#include "trace.h"
+#include <Arduino.h>
+#include <atomic>
+
+// ============================================
+// Queues between the two cores
+// Each panel has at most one frame in flight, so a ring of 8
+// never fills and push() can't fail.
+// ============================================
+struct FrameJob {
+    uint8_t panel;          // framebuffer to send
+    uint8_t mask;           // panels it goes to
+    uint8_t x, y, w, h;     // area; w = 0 for the whole frame
+    PanelScroll scroll;     // sent first; rows = 0 for none
+};
+
+static SpscQueue<FrameJob, 8> flushQueue;   // core 1 -> core 0: frame ready
+static SpscQueue<FrameJob, 8> doneQueue;    // core 0 -> core 1: frame on glass
+
+static TaskHandle_t flushTask  = nullptr;
+static TaskHandle_t renderTask = nullptr;
+
+// Panels whose framebuffer is queued or being flushed (core 1 only)
+static uint8_t inFlight = 0;
+
+// Scroll each panel's jobs carry (core 1 only)
+static PanelScroll frameScroll[NUM_DISPLAYS];
+
+// ============================================
+// Utilisation counters
+// Each is written by one core and read/reset by core 1
+// ============================================
+static std::atomic<uint32_t> renderBusyUs{0};
+static std::atomic<uint32_t> renderWaitUs{0};
+static std::atomic<uint32_t> flushBusyUs{0};
+static std::atomic<uint32_t> framesFlushed{0};
+static uint32_t windowStartUs = 0;
+static uint32_t frameStartUs  = 0;
+
+// ============================================
+// Flush stage (core 0)
+// ============================================
+static void flushLoop(void*) {
+    for (;;) {
+        FrameJob job;
+        if (!flushQueue.pop(job)) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        uint32_t t0 = micros();
+        {
+            TRACE_SCOPE_ARG("flush", job.panel);
+            if (job.scroll.rows) scrollPanel(job.panel, job.scroll);
+            if (job.w) flushRectTo(job.mask, job.panel, job.x, job.y, job.w, job.h);
+            else flushFrameTo(job.mask, job.panel);
+        }
+        flushBusyUs.fetch_add(micros() - t0, std::memory_order_relaxed);
+        framesFlushed.fetch_add(1, std::memory_order_relaxed);
+
+        doneQueue.push(job);
+        xTaskNotifyGive(renderTask);
+    }
+}
+
+// ============================================
+// Render stage (core 1)
+// ============================================
+static void reapFlushed() {
+    FrameJob job;
+    while (doneQueue.pop(job)) {
+        inFlight &= ~(1 << job.panel);
+    }
+}
+
+static void waitWhile(uint8_t mask) {
+    reapFlushed();
+    if (!(inFlight & mask)) return;
+
+    TRACE_SCOPE("wait flush");
+    uint32_t t0 = micros();
+    while (inFlight & mask) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(5));
+        reapFlushed();
+    }
+    renderWaitUs.fetch_add(micros() - t0, std::memory_order_relaxed);
+}
+
+void startPipeline() {
+    renderTask = xTaskGetCurrentTaskHandle();
+    windowStartUs = micros();
+    xTaskCreatePinnedToCore(flushLoop, "flush", 4096, nullptr, 2, &flushTask, 0);
+}
+
+void beginFrame(int idx) {
+    waitWhile(1 << idx);
+    frameStartUs = micros();
+}
+
+static void submit(FrameJob job) {
+    job.scroll = frameScroll[job.panel];
+    renderBusyUs.fetch_add(micros() - frameStartUs, std::memory_order_relaxed);
+    inFlight |= (1 << job.panel);
+    flushQueue.push(job);
+    xTaskNotifyGive(flushTask);
+}
+
+void submitFrame(int idx) {
+    submit({(uint8_t)idx, (uint8_t)(1 << idx), 0, 0, 0, 0, {}});
+}
+
+void submitRect(int idx, int x, int y, int w, int h) {
+    if (w <= 0 || h <= 0) return;
+    submit({(uint8_t)idx, (uint8_t)(1 << idx), (uint8_t)x, (uint8_t)y, (uint8_t)w, (uint8_t)h, {}});
+}
+
+void submitBroadcast(int idx, uint8_t mask) {
+    submit({(uint8_t)idx, mask, 0, 0, 0, 0, {}});
+}
+
+void scrollFrame(int idx, const PanelScroll& s) {
+    frameScroll[idx] = s;
+}
+
+void renderPanel(int idx, DrawFn fn) {
+    beginFrame(idx);
+    fn(idx);
+    submitFrame(idx);
+}
+
+void pipelineDrain() {
+    waitWhile(0xFF);
+}
+
+PipelineStats pipelineTakeStats() {
+    uint32_t now = micros();
+    PipelineStats s;
+    s.windowUs     = now - windowStartUs;
+    s.renderBusyUs = renderBusyUs.exchange(0, std::memory_order_relaxed);
+    s.renderWaitUs = renderWaitUs.exchange(0, std::memory_order_relaxed);
+    s.flushBusyUs  = flushBusyUs.exchange(0, std::memory_order_relaxed);
+    s.frames       = framesFlushed.exchange(0, std::memory_order_relaxed);
+    windowStartUs = now;
+    return s;
+}
@@ -0,0 +1,332 @@
+#include "prom.h"
+#include <math.h>
+#include <string.h>
+
+static const uint32_t HASH_INF = promHash("Inf");
+
+// ============================================
+// Parser state for one exposition (lives on the caller's stack)
+// One byte at a time through a small state machine, so a name or
+// value split across two reads needs nothing carried over but the
+// hashes and the number built so far
+// ============================================
+enum PromState : uint8_t {
+    LINE_START,
+    SKIP,           // rest of the line isn't wanted
+    NAME,
+    LABEL_START,    // after '{' or ','
+    LABEL_NAME,
+    LABEL_EQUALS,   // label name done, '"' next
+    LABEL_VALUE,
+    LABEL_ESCAPE,   // after '\' in a value
+    LABEL_END,      // closing quote seen: ',' or '}'
+    VALUE_START,
+    VALUE,
+    VALUE_END,      // timestamp or trailing space
+    BAD,            // malformed wanted line, up to its newline
+};
+
+class PromParser {
+public:
+    PromParser(const PromQuery& q, PromSampleFn fn, void* ctx) : _q(q), _fn(fn), _ctx(ctx) {}
+
+    void feed(const char* p, size_t len);
+    void end() { if (_state != LINE_START) feed("\n", 1); }
+    int  result() const { return _bad ? -1 : _samples; }
+
+private:
+    bool byte(uint8_t c);
+    void startLine();
+    bool nameDone();
+    void endLine();
+
+    // Number, kept as decimal mantissa and exponent until the end
+    void numberStart();
+    bool numberByte(uint8_t c);
+    double numberValue() const;
+
+    const PromQuery& _q;
+    PromSampleFn     _fn;
+    void*            _ctx;
+
+    PromState _state = LINE_START;
+    uint32_t  _hash = 0;            // token being read
+    uint32_t  _label = 0;           // name of the label being read
+    int       _metric = -1;
+    uint32_t  _key = 0;
+
+    uint64_t  _mant = 0;
+    int16_t   _exp = 0;             // decimal exponent so far
+    int16_t   _expPart = 0;         // after 'e'
+    uint8_t   _part = 0;            // 0 int, 1 fraction, 2 exponent, 3 word (NaN/Inf)
+    bool      _neg = false;
+    bool      _expNeg = false;
+    bool      _digits = false;
+
+    int       _samples = 0;
+    bool      _bad = false;
+};
+
+static bool isNameChar(uint8_t c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           c == '_' || c == ':';
+}
+
+void PromParser::feed(const char* p, size_t len) {
+    const char* end = p + len;
+    while (p < end) {
+        // Tight loops for the long runs, the state machine for the
+        // bytes that end them. Unwanted lines are the bulk of a
+        // scrape: jump to the newline.
+        if (_state == SKIP) {
+            const char* nl = (const char*)memchr(p, '\n', end - p);
+            if (!nl) return;
+            p = nl + 1;
+            _state = LINE_START;
+            continue;
+        }
+        if (_state == NAME || _state == LABEL_NAME) {
+            uint32_t h = _hash;
+            while (p < end && isNameChar((uint8_t)*p)) h = promHashStep(h, (uint8_t)*p++);
+            _hash = h;
+            if (p == end) return;
+        } else if (_state == LABEL_VALUE) {
+            // Only the key label's value is hashed; others are stepped over
+            uint32_t h = _hash;
+            bool key = (_label == _q.keyLabel);
+            while (p < end && *p != '"' && *p != '\\' && *p != '\n') {
+                if (key) h = promHashStep(h, (uint8_t)*p);
+                p++;
+            }
+            _hash = h;
+            if (p == end) return;
+        }
+        if (!byte((uint8_t)*p++)) {
+            _bad = true;
+            _state = (p[-1] == '\n') ? LINE_START : BAD;
+        }
+    }
+}
+
+void PromParser::startLine() {
+    _hash = PROM_HASH_SEED;
+    _metric = -1;
+    _key = 0;
+}
+
+// Name complete: is it one of the wanted metrics?
+bool PromParser::nameDone() {
+    for (int i = 0; i < _q.count; i++) {
+        if (_q.names[i] == _hash) {
+            _metric = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void PromParser::endLine() {
+    PromSample s = {(uint8_t)_metric, _key, numberValue()};
+    _fn(_ctx, s);
+    _samples++;
+    _state = LINE_START;
+}
+
+// False = this (wanted) line is malformed
+bool PromParser::byte(uint8_t c) {
+    switch (_state) {
+    case LINE_START:
+        if (c == '\n' || c == ' ' || c == '\t' || c == '\r') return true;
+        if (c == '#' || !isNameChar(c)) {
+            _state = SKIP;
+            return true;
+        }
+        startLine();
+        _hash = promHashStep(_hash, c);
+        _state = NAME;
+        return true;
+
+    case NAME:
+        if (isNameChar(c)) {
+            _hash = promHashStep(_hash, c);
+            return true;
+        }
+        if (!nameDone()) {
+            _state = (c == '\n') ? LINE_START : SKIP;
+            return true;
+        }
+        if (c == '{') _state = LABEL_START;
+        else if (c == ' ' || c == '\t') _state = VALUE_START;
+        else return false;
+        return true;
+
+    case LABEL_START:
+        if (c == ' ' || c == '\t') return true;
+        if (c == '}') {
+            _state = VALUE_START;
+            return true;
+        }
+        if (!isNameChar(c)) return false;
+        _hash = promHashStep(PROM_HASH_SEED, c);
+        _state = LABEL_NAME;
+        return true;
+
+    case LABEL_NAME:
+        if (isNameChar(c)) {
+            _hash = promHashStep(_hash, c);
+            return true;
+        }
+        _label = _hash;
+        if (c == '=') {
+            _state = LABEL_EQUALS;
+            return true;
+        }
+        return false;
+
+    case LABEL_EQUALS:
+        if (c != '"') return false;
+        _hash = PROM_HASH_SEED;
+        _state = LABEL_VALUE;
+        return true;
+
+    case LABEL_VALUE:
+        if (c == '\\') {
+            _state = LABEL_ESCAPE;
+        } else if (c == '"') {
+            if (_label == _q.keyLabel) _key = _hash;
+            _state = LABEL_END;
+        } else if (c == '\n') {
+            return false;
+        } else {
+            _hash = promHashStep(_hash, c);
+        }
+        return true;
+
+    case LABEL_ESCAPE:
+        _hash = promHashStep(_hash, c == 'n' ? '\n' : c);
+        _state = LABEL_VALUE;
+        return true;
+
+    case LABEL_END:
+        if (c == ',') _state = LABEL_START;
+        else if (c == '}') _state = VALUE_START;
+        else return false;
+        return true;
+
+    case VALUE_START:
+        if (c == ' ' || c == '\t') return true;
+        numberStart();
+        _state = VALUE;
+        return numberByte(c);
+
+    case VALUE:
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            if (!_digits) return false;
+            if (c == '\n') endLine();
+            else _state = VALUE_END;
+            return true;
+        }
+        return numberByte(c);
+
+    case VALUE_END:
+        if (c == '\n') endLine();
+        return true;
+
+    case BAD:
+        if (c == '\n') _state = LINE_START;
+        return true;
+
+    case SKIP:
+        break;
+    }
+    return true;
+}
+
+// ============================================
+// Numbers
+// Digits go into a 64-bit mantissa with the decimal point and
+// exponent tracked apart, so "0.004217" is 4217e-6 and only one
+// scaling happens at the end. NaN and Inf are spotted by hash.
+// ============================================
+void PromParser::numberStart() {
+    _mant = 0;
+    _exp = 0;
+    _expPart = 0;
+    _part = 0;
+    _neg = false;
+    _expNeg = false;
+    _digits = false;
+    _hash = PROM_HASH_SEED;
+}
+
+bool PromParser::numberByte(uint8_t c) {
+    if (_part == 3) {
+        _hash = promHashStep(_hash, c);
+        return true;
+    }
+    if (c >= '0' && c <= '9') {
+        _digits = true;
+        if (_part == 2) {
+            if (_expPart < 1000) _expPart = _expPart * 10 + (c - '0');
+        } else if (_mant < 100000000000000000ull) {
+            _mant = _mant * 10 + (c - '0');
+            if (_part == 1) _exp--;
+        } else if (_part == 0) {
+            _exp++;                 // past 17 digits: keep the magnitude only
+        }
+        return true;
+    }
+    if ((c == '-' || c == '+') && !_digits) {
+        if (_part == 2) _expNeg = (c == '-');
+        else if (_part == 0) _neg = (c == '-');
+        else return false;
+        return true;
+    }
+    if (c == '.' && _part == 0) {
+        _part = 1;
+        return true;
+    }
+    if ((c == 'e' || c == 'E') && _part < 2 && _digits) {
+        _part = 2;
+        _digits = false;
+        return true;
+    }
+    if ((c == 'N' || c == 'I') && _part == 0 && !_digits) {
+        _part = 3;
+        _digits = true;
+        _hash = promHashStep(_hash, c);
+        return true;
+    }
+    return false;
+}
+
+double PromParser::numberValue() const {
+    if (_part == 3) {
+        if (_hash == HASH_INF) return _neg ? -INFINITY : INFINITY;
+        return NAN;             // "NaN", or a word we don't know
+    }
+    int e = _exp + (_expNeg ? -_expPart : _expPart);
+    double v = (double)_mant;
+    if (e > 0) v *= pow(10.0, e);
+    else if (e < 0) v /= pow(10.0, -e);
+    return _neg ? -v : v;
+}
+
+// ============================================
+// Entry point
+// Whole chunks only when the stream already has them, so the end
+// of the body never waits on a read timeout
+// ============================================
+int promParse(Stream& in, const PromQuery& q, PromSampleFn fn, void* ctx) {
+    PromParser parser(q, fn, ctx);
+    char buf[PROM_READ_CHUNK];
+    for (;;) {
+        int avail = in.available();
+        size_t want = (avail > 1) ? min(avail, PROM_READ_CHUNK) : 1;
+        size_t n = in.readBytes(buf, want);
+        if (n == 0) break;
+        parser.feed(buf, n);
+    }
+    parser.end();
+    return parser.result();
+}
@@ -1,136 +1,413 @@
 #include "screens.h"
+#include "adsb.h"
 #include "config.h"
 #include "gauges.h"
+#include "gaugetables.h"
+#include "inflate.h"
+#include "expr.h"
+#include "metrics.h"
+#include "prom.h"
+#include "snmp.h"
+#include "statsschema.h"
+#include "trace.h"
 #include <WiFi.h>
 #include <HTTPClient.h>
+#include <WiFiUdp.h>
+#include <algorithm>
+#include <stdarg.h>
 #include <time.h>
 
 // ============================================
 // Cached data from API calls
+// Numbers live in the metric store (metrics.h); only text and
+// per-source bookkeeping is kept here
 // ============================================
 
 // Unraid
-static float  unraidDriveTemps[8] = {0};
-static char   unraidDriveNames[8][8] = {"sda","sdb","sdc","sdd","sde","sdf","sdg","sdh"};
-static int    unraidDriveCount = 0;
-static float  unraidStorageUsedTB = 0;
-static float  unraidStorageTotalTB = 0;
-static float  unraidCpuPercent = 0;
-static float  unraidMemPercent = 0;
-static int    unraidDockerRunning = 0;
-static int    unraidDockerTotal = 0;
-static String unraidArrayStatus = "unknown";
-
-// M900
-static float  m900CpuPercent = 0;
-static float  m900CpuTemp = 0;
-static float  m900MemPercent = 0;
-static float  m900MemUsedGB = 0;
-static float  m900MemTotalGB = 0;
-static float  m900DiskPercent = 0;
-static float  m900DiskUsedGB = 0;
-static float  m900DiskTotalGB = 0;
+static char unraidDriveNames[METRIC_DRIVES][8] = {"sda","sdb","sdc","sdd","sde","sdf","sdg","sdh"};
+static char unraidArrayStatus[12] = "unknown";
 
 // Pi health
-static float  piTemps[4] = {0, 0, 0, 0};
-static float  piCpu[4] = {0, 0, 0, 0};
-static float  piMem[4] = {0, 0, 0, 0};
-static bool   piOnline[4] = {false, false, false, false};
 static const char* piNames[4] = {"FlightRdr", "Uptime", "Spare-1", "Spare-2"};
 static const char* piHosts[4] = {PI_FLIGHT_IP, PI_UPTIME_IP, PI_SPARE1_IP, PI_SPARE2_IP};
 
-// Services
+// Services - Uptime Kuma monitors, matched by name hash
 struct ServiceStatus {
     const char* name;
-    const char* url;
-    bool up;
+    const char* kuma;       // Kuma monitor name, also "monitor" in /stats
+    uint32_t    monitor;    // promHash of it
 };
 
-static ServiceStatus services[] = {
-    {"Jazz Stats",   JAZZ_STATS_URL,      false},
-    {"NHL Tracker",  NHL_TRACKER_URL,     false},
-    {"ClaudeCAD",    CLAUDECAD_URL,       false},
-    {"Plex",         PLEX_URL,            false},
-    {"Sonarr",       SONARR_URL,          false},
-    {"Radarr",       RADARR_URL,          false},
-    {"Overseerr",    OVERSEERR_URL,       false},
-    {"AudioBooks",   AUDIOBOOKSHELF_URL,  false},
-    {"Mammoth",      MAMMOTH_URL,         false},
-    {"FlightRadar",  FLIGHT_TAR1090_URL,  false},
-    {"UptimeKuma",   UPTIME_KUMA_URL,     false},
+static const ServiceStatus services[] = {
+    {"Jazz Stats",  KUMA_JAZZ_STATS,     promHash(KUMA_JAZZ_STATS)},
+    {"NHL Tracker", KUMA_NHL_TRACKER,    promHash(KUMA_NHL_TRACKER)},
+    {"ClaudeCAD",   KUMA_CLAUDECAD,      promHash(KUMA_CLAUDECAD)},
+    {"Plex",        KUMA_PLEX,           promHash(KUMA_PLEX)},
+    {"Sonarr",      KUMA_SONARR,         promHash(KUMA_SONARR)},
+    {"Radarr",      KUMA_RADARR,         promHash(KUMA_RADARR)},
+    {"Overseerr",   KUMA_OVERSEERR,      promHash(KUMA_OVERSEERR)},
+    {"AudioBooks",  KUMA_AUDIOBOOKSHELF, promHash(KUMA_AUDIOBOOKSHELF)},
+    {"Mammoth",     KUMA_MAMMOTH,        promHash(KUMA_MAMMOTH)},
+    {"FlightRadar", KUMA_FLIGHT_RADAR,   promHash(KUMA_FLIGHT_RADAR)},
+    {"UptimeKuma",  KUMA_UPTIME_KUMA,    promHash(KUMA_UPTIME_KUMA)},
 };
 static const int NUM_SERVICES = sizeof(services) / sizeof(services[0]);
+static_assert(NUM_SERVICES == METRIC_SERVICES, "one M_SERVICE_UP slot per service");
+
+// Kuma's monitor_status per service; M_SERVICE_UP only says up or
+// not, and the panel shows pending and maintenance in their own colours
+enum KumaStatus : uint8_t { KUMA_DOWN, KUMA_UP, KUMA_PENDING, KUMA_MAINTENANCE };
+static uint8_t serviceStatus[METRIC_SERVICES];
+
+// M900 - last network counters, for the bandwidth rate
+static double prevBytesSent = 0;
+static double prevBytesRecv = 0;
+
+// Custom screen - derived metrics, compiled by setupCustom()
+static Expr       customMain;
+static Expr       customSub;
+static ExprInputs customSeen;
+
+// Switches - last octet counters per port, for the rates
+struct SwitchCounters {
+    uint64_t in[METRIC_SWITCH_PORTS];
+    uint64_t out[METRIC_SWITCH_PORTS];
+    uint32_t sampledMs;     // 0 = none yet
+};
+
+static const char*    switchHosts[METRIC_SWITCHES] = {SWITCH_1_IP, SWITCH_2_IP};
+static SwitchCounters switchPrev[METRIC_SWITCHES];
+
+// ADS-B - latest view from the feed task, copied by fetchRadar()
+static RadarView radarView;
+
+// Pi-hole - counters from recent polls for the rates, and the top
+// clients as last listed
+struct DnsCounters {
+    double   total;
+    double   blocked;
+    uint32_t sampledMs;
+};
+
+static DnsCounters dnsHistory[PIHOLE_RATIO_POLLS];     // ring, oldest overwritten
+static uint8_t     dnsHistoryLen = 0;
+static uint8_t     dnsHistoryNext = 0;
+static char        dnsClientNames[METRIC_DNS_CLIENTS][12];
+static double      dnsClientQueries[METRIC_DNS_CLIENTS];
+static int         dnsClientCount = 0;     // listed live since boot
+static uint32_t    dnsListedMs = 0;        // 0 = never listed
+static double      dnsListedTotal = -1;    // queries.total at that listing
+static_assert(STATS_MAX_DNS_CLIENTS == METRIC_DNS_CLIENTS, "one M_DNS_CLIENT_QUERIES slot per listed client");
+
+static bool liveSinceBoot = false;
+
+// When each source last answered (0 = not since boot). One slot per
+// source, not per screen: the switch and DNS screens can share an
+// index, and /stats reports them separately
+enum LiveSource {
+    LIVE_UNRAID,
+    LIVE_M900,
+    LIVE_PIS,
+    LIVE_SERVICES,
+    LIVE_SWITCHES,
+    LIVE_PIHOLE,
+    LIVE_CUSTOM,
+    LIVE_COUNT
+};
+
+static unsigned long liveAtMs[LIVE_COUNT] = {0};
+static time_t        liveAtEpoch[LIVE_COUNT] = {0};
+
+// What boot is still waiting on, shown by the clock before NTP
+static const char* bootStatus = nullptr;
+
+static void markLive(LiveSource src) {
+    liveSinceBoot = true;
+    liveAtMs[src] = millis();
+    time_t now = time(nullptr);
+    liveAtEpoch[src] = (now > 1600000000) ? now : 0;    // 0 until NTP
+}
+
+// ============================================
+// Metric access while drawing
+// Each screen takes one consistent copy of the store up front
+// ============================================
+static MetricStore cur;     // loop task only
+static uint32_t    curMs;
+
+static void readMetrics() {
+    metricsRead(cur);
+    curMs = millis();
+}
+
+static float metric(int id) {
+    return (float)cur.value[id];
+}
 
-// Custom screen - network bandwidth
-static long netBytesSent = 0;
-static long netBytesRecv = 0;
-static long prevBytesSent = 0;
-static long prevBytesRecv = 0;
-static float netUpMbps = 0;
-static float netDownMbps = 0;
+static bool stale(int id) {
+    return metricStale(cur, id, curMs);
+}
+
+// Live colour, or grey once the value has gone stale
+static uint32_t tint(int id, uint32_t color) {
+    return stale(id) ? PAL_DARKGREY : color;
+}
 
 // ============================================
-// Helper: fetch JSON from URL
+// Helper: fetch a body from URL
+// decode reads it straight off the socket, through the inflater
+// if the server compressed it; it is never buffered whole
 // ============================================
-static bool fetchJson(const char* url, JsonDocument& doc) {
+static InflateStream inflater;      // 33 KB, shared by every fetch (loop task only)
+
+template <typename F>
+static bool fetchBody(const char* url, const char* apiKey, F&& decode, int* status = nullptr) {
     HTTPClient http;
     http.begin(url);
     http.setTimeout(3000);
+    http.useHTTP10(true);       // no chunked encoding between us and the parser
+    http.addHeader("Accept-Encoding", "gzip");
+    if (apiKey && *apiKey) http.setAuthorization("", apiKey);
+    static const char* headerKeys[] = {"Content-Encoding"};
+    http.collectHeaders(headerKeys, 1);
+
     int code = http.GET();
+    if (status) *status = code;
     bool ok = false;
     if (code == 200) {
-        DeserializationError err = deserializeJson(doc, http.getString());
-        ok = (err == DeserializationError::Ok);
+        String encoding = http.header("Content-Encoding");
+        if (encoding == "gzip" || encoding == "deflate") {
+            inflater.begin(http.getStream(),
+                           encoding == "gzip" ? InflateStream::GZIP : InflateStream::DEFLATE);
+            ok = decode(inflater) && inflater.finish();
+        } else {
+            ok = decode(http.getStream());
+        }
     }
     http.end();
     return ok;
 }
 
-static bool httpCheck(const char* url) {
+// JSON into a typed struct (statsschema.h)
+static bool fetchJson(const char* url, const JsonSchema& schema, void* out) {
+    return fetchBody(url, nullptr, [&](Stream& in) { return jsonDecode(in, schema, out); });
+}
+
+// ============================================
+// Helper: Uptime Kuma monitors
+// One scrape of /metrics covers every service; only monitor_status
+// and monitor_response_time are looked at, keyed by monitor_name
+// ============================================
+struct KumaMonitor {
+    int16_t status;         // KumaStatus, -1 = not in the scrape
+    int32_t responseMs;     // -1 = none (Kuma reports -1 while down)
+};
+
+static const uint32_t kumaMetrics[] = {promHash("monitor_status"), promHash("monitor_response_time")};
+static const PromQuery kumaQuery = {kumaMetrics, 2, promHash("monitor_name")};
+
+static void kumaSample(void* ctx, const PromSample& s) {
+    KumaMonitor* mon = (KumaMonitor*)ctx;
+    for (int i = 0; i < NUM_SERVICES; i++) {
+        if (services[i].monitor != s.key) continue;
+        if (s.metric == 0) mon[i].status = (int16_t)s.value;
+        else mon[i].responseMs = (s.value >= 0) ? (int32_t)s.value : -1;
+        return;
+    }
+}
+
+static bool fetchKuma(KumaMonitor mon[METRIC_SERVICES]) {
+    for (int i = 0; i < NUM_SERVICES; i++) mon[i] = {-1, -1};
+    return fetchBody(UPTIME_KUMA_URL "/metrics", KUMA_API_KEY, [&](Stream& in) {
+        return promParse(in, kumaQuery, kumaSample, mon) > 0;
+    });
+}
+
+// ============================================
+// Helper: Pi-hole FTL API (v6)
+// Log in once with the app password and send the session id with
+// every request until FTL answers 401, then log in again. With no
+// password set the API is open and there is no session at all.
+// ============================================
+static char piholeSid[3 * sizeof(PiholeAuth::sid)];    // URL-encoded, "" = none
+
+static bool piholeLogin() {
+    piholeSid[0] = '\0';
+    char body[96];
+    snprintf(body, sizeof(body), "{\"password\":\"%s\"}", PIHOLE_PASSWORD);
+
     HTTPClient http;
-    http.begin(url);
-    http.setTimeout(2000);
-    int code = http.GET();
+    http.begin(PIHOLE_URL "/api/auth");
+    http.setTimeout(3000);
+    http.useHTTP10(true);
+    http.addHeader("Content-Type", "application/json");
+    PiholeAuth auth = {};
+    bool ok = http.POST(body) == 200 && jsonDecode(http.getStream(), PIHOLE_AUTH_SCHEMA, &auth);
     http.end();
-    return (code > 0 && code < 400);
+    if (!ok || !auth.sid[0]) {
+        Serial.println("Pi-hole: login failed");
+        return false;
+    }
+
+    // The sid is base64: + / = need escaping in a query string
+    char* o = piholeSid;
+    for (const char* s = auth.sid; *s; s++) {
+        if (*s == '+' || *s == '/' || *s == '=') o += sprintf(o, "%%%02X", *s);
+        else *o++ = *s;
+    }
+    *o = '\0';
+    return true;
+}
+
+// GET PIHOLE_URL + path into a typed struct
+static bool piholeGet(const char* path, const JsonSchema& schema, void* out) {
+    bool auth = PIHOLE_PASSWORD[0] != '\0';
+    if (auth && !piholeSid[0] && !piholeLogin()) return false;
+
+    for (int attempt = 0;; attempt++) {
+        char url[224];
+        if (auth) {
+            snprintf(url, sizeof(url), PIHOLE_URL "%s%csid=%s", path,
+                     strchr(path, '?') ? '&' : '?', piholeSid);
+        } else {
+            snprintf(url, sizeof(url), PIHOLE_URL "%s", path);
+        }
+        int status = 0;
+        if (fetchBody(url, nullptr, [&](Stream& in) { return jsonDecode(in, schema, out); }, &status)) {
+            return true;
+        }
+        if (!auth || status != 401 || attempt > 0 || !piholeLogin()) return false;
+    }
+}
+
+// Hostname up to its first dot, else the address
+static void dnsClientName(char* dst, size_t cap, const PiholeTopClients::Client& c) {
+    const char* src = c.name[0] ? c.name : c.ip;
+    size_t n = c.name[0] ? strcspn(src, ".") : strlen(src);
+    strlcpy(dst, src, min(n + 1, cap));
+}
+
+// ============================================
+// Helper: SNMP port counters from every switch
+// Both GETBULKs go out back to back and replies are matched by
+// request-id as they arrive, so a poll costs one round-trip.
+// Counters are read straight out of the receive buffer.
+// ============================================
+static const uint32_t ifHCInOctets[]  = {1, 3, 6, 1, 2, 1, 31, 1, 1, 1, 6, SWITCH_FIRST_IFINDEX - 1};
+static const uint32_t ifHCOutOctets[] = {1, 3, 6, 1, 2, 1, 31, 1, 1, 1, 10, SWITCH_FIRST_IFINDEX - 1};
+
+// Start the walk just before port 1 (GETBULK returns what follows)
+static const uint8_t IF_COLUMN_ARCS = 11;
+static const uint8_t IF_START_ARCS = IF_COLUMN_ARCS + (SWITCH_FIRST_IFINDEX > 1);
+
+static WiFiUDP  snmpUdp;
+static uint8_t  snmpPacket[SNMP_PACKET_MAX];    // loop task only
+static int32_t  snmpRequestId = 0;
+
+struct PortWalk {
+    SwitchCounters c;
+    uint32_t       seen;    // bit per port and direction
+};
+
+static void onPortCounter(void* ctx, const SnmpVarbind& vb) {
+    static const SnmpOid inColumn = {ifHCInOctets, IF_COLUMN_ARCS};
+    static const SnmpOid outColumn = {ifHCOutOctets, IF_COLUMN_ARCS};
+    PortWalk* w = (PortWalk*)ctx;
+    uint32_t ifIndex;
+    uint64_t octets;
+    if (!snmpUnsigned(vb, &octets)) return;      // endOfMibView etc.
+
+    bool in = snmpColumnIndex(vb, inColumn, &ifIndex);
+    if (!in && !snmpColumnIndex(vb, outColumn, &ifIndex)) return;
+    uint32_t port = ifIndex - SWITCH_FIRST_IFINDEX;
+    if (port >= METRIC_SWITCH_PORTS) return;
+
+    (in ? w->c.in : w->c.out)[port] = octets;
+    w->seen |= 1u << (port + (in ? 0 : METRIC_SWITCH_PORTS));
+}
+
+// Fill walks[s] for each switch that answered in time; returns a
+// bit per switch with a complete port table
+static uint32_t snmpPollSwitches(PortWalk* walks) {
+    static const SnmpOid columns[] = {
+        {ifHCInOctets, IF_START_ARCS},
+        {ifHCOutOctets, IF_START_ARCS},
+    };
+    static bool open = false;
+    if (!open) open = snmpUdp.begin(SNMP_LOCAL_PORT);
+
+    int32_t firstId = snmpRequestId + 1;
+    for (int s = 0; s < METRIC_SWITCHES; s++) {
+        size_t len = snmpGetBulk(snmpPacket, sizeof(snmpPacket), SWITCH_COMMUNITY,
+                                 ++snmpRequestId, METRIC_SWITCH_PORTS, columns, 2);
+        snmpUdp.beginPacket(switchHosts[s], SNMP_PORT);
+        snmpUdp.write(snmpPacket, len);
+        snmpUdp.endPacket();
+    }
+
+    const uint32_t allPorts = (1u << (2 * METRIC_SWITCH_PORTS)) - 1;
+    uint32_t answered = 0;
+    unsigned long start = millis();
+    while (answered != (1u << METRIC_SWITCHES) - 1 && millis() - start < SWITCH_TIMEOUT_MS) {
+        int n = snmpUdp.parsePacket();
+        if (n <= 0) {
+            delay(1);
+            continue;
+        }
+        n = snmpUdp.read(snmpPacket, sizeof(snmpPacket));
+        for (int s = 0; s < METRIC_SWITCHES; s++) {
+            if (answered & (1u << s)) continue;
+            walks[s].seen = 0;
+            if (snmpParseResponse(snmpPacket, n, firstId + s, onPortCounter, &walks[s]) >= 0 &&
+                walks[s].seen == allPorts) {
+                answered |= 1u << s;
+            }
+        }
+    }
+    return answered;
 }
 
 // ============================================
 // Screen 0: Unraid Health
 // ============================================
 void drawUnraid(int idx) {
-    auto* d = displays[idx];
-    d->fillScreen(TFT_BLACK);
+    TRACE_SCOPE("draw unraid");
+    auto* d = frames[idx];
+    d->fillScreen(PAL_BLACK);
 
     // Title
     d->setTextDatum(middle_center);
     d->setTextSize(1.5);
-    d->setTextColor(0xFD20, TFT_BLACK);  // Orange
+    d->setTextColor(PAL_ORANGE, PAL_BLACK);
     d->drawString("UNRAID", 120, 20);
 
+    readMetrics();
+
     // Array status indicator
-    uint32_t statusColor = (unraidArrayStatus == "STARTED") ? TFT_GREEN : TFT_RED;
+    uint32_t statusColor = tint(M_UNRAID_ARRAY_STARTED,
+                                metric(M_UNRAID_ARRAY_STARTED) > 0 ? PAL_GREEN : PAL_RED);
     d->fillCircle(120, 38, 4, statusColor);
 
     // Drive temps as mini bars across the middle
-    if (unraidDriveCount > 0) {
-        int barWidth = 180 / unraidDriveCount;
-        int startX = 120 - (unraidDriveCount * barWidth) / 2;
+    int driveCount = constrain((int)metric(M_UNRAID_DRIVE_COUNT), 0, METRIC_DRIVES);
+    if (driveCount > 0) {
+        int barWidth = 180 / driveCount;
+        int startX = 120 - (driveCount * barWidth) / 2;
 
         d->setTextSize(1);
-        d->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+        d->setTextColor(PAL_LIGHTGREY, PAL_BLACK);
         d->drawString("DRIVE TEMPS", 120, 55);
 
-        for (int i = 0; i < unraidDriveCount && i < 8; i++) {
+        for (int i = 0; i < driveCount; i++) {
             int x = startX + i * barWidth + barWidth / 2;
-            float temp = unraidDriveTemps[i];
+            float temp = metric(M_UNRAID_DRIVE_TEMP + i);
 
             // Bar height based on temp (20-60°C range)
             int maxH = 50;
             float pct = constrain((temp - 20) / 40.0, 0, 1);
             int barH = (int)(pct * maxH);
 
-            uint32_t color = gaugeColor(temp, 40, 50);
+            uint32_t color = tint(M_UNRAID_DRIVE_TEMP + i, gaugeColor(temp, 40, 50));
             int barY = 120 - barH / 2;
             d->fillRect(x - barWidth/2 + 2, barY, barWidth - 4, barH, color);
 
@@ -138,111 +415,130 @@ void drawUnraid(int idx) {
             char tStr[6];
             snprintf(tStr, sizeof(tStr), "%.0f", temp);
             d->setTextSize(0.8);
-            d->setTextColor(TFT_WHITE, TFT_BLACK);
+            d->setTextColor(tint(M_UNRAID_DRIVE_TEMP + i, PAL_WHITE), PAL_BLACK);
             d->drawString(tStr, x, 120 + maxH/2 + 10);
 
             // Drive name
-            d->setTextColor(TFT_DARKGREY, TFT_BLACK);
+            d->setTextColor(PAL_DARKGREY, PAL_BLACK);
             d->drawString(unraidDriveNames[i], x, 120 - maxH/2 - 8);
         }
     }
 
     // Storage bar at bottom
     d->setTextSize(1);
-    d->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+    d->setTextColor(PAL_LIGHTGREY, PAL_BLACK);
     d->drawString("STORAGE", 120, 165);
 
+    float usedTB = metric(M_UNRAID_STORAGE_USED_TB);
+    float totalTB = metric(M_UNRAID_STORAGE_TOTAL_TB);
     float storagePct = 0;
-    if (unraidStorageTotalTB > 0)
-        storagePct = (unraidStorageUsedTB / unraidStorageTotalTB) * 100;
+    if (totalTB > 0)
+        storagePct = (usedTB / totalTB) * 100;
 
     // Draw bar
     int barX = 40, barY = 178, barW = 160, barH = 12;
-    d->drawRect(barX, barY, barW, barH, TFT_DARKGREY);
+    d->drawRect(barX, barY, barW, barH, PAL_DARKGREY);
     int fillW = (int)(storagePct / 100.0 * (barW - 2));
-    uint32_t barColor = gaugeColor(storagePct, 75, 90);
+    uint32_t barColor = tint(M_UNRAID_STORAGE_USED_TB, gaugeColor(storagePct, 75, 90));
     d->fillRect(barX + 1, barY + 1, fillW, barH - 2, barColor);
 
     // Storage text
     char storStr[24];
-    snprintf(storStr, sizeof(storStr), "%.1f / %.1fTB", unraidStorageUsedTB, unraidStorageTotalTB);
-    d->setTextColor(TFT_WHITE, TFT_BLACK);
+    snprintf(storStr, sizeof(storStr), "%.1f / %.1fTB", usedTB, totalTB);
+    d->setTextColor(tint(M_UNRAID_STORAGE_USED_TB, PAL_WHITE), PAL_BLACK);
     d->drawString(storStr, 120, 200);
 
     // Docker count
     char dockStr[20];
-    snprintf(dockStr, sizeof(dockStr), "%d/%d containers", unraidDockerRunning, unraidDockerTotal);
+    snprintf(dockStr, sizeof(dockStr), "%d/%d containers",
+             (int)metric(M_UNRAID_DOCKER_RUNNING), (int)metric(M_UNRAID_DOCKER_TOTAL));
     d->setTextSize(0.8);
-    d->setTextColor(TFT_DARKGREY, TFT_BLACK);
+    d->setTextColor(PAL_DARKGREY, PAL_BLACK);
     d->drawString(dockStr, 120, 220);
 }
 
 // ============================================
 // Screen 1: M900 Health (RPM gauges)
 // ============================================
+static constexpr GaugeConfig M900_CPU_GAUGE = {
+    .minVal     = 0,
+    .maxVal     = 100,
+    .warnVal    = 75,
+    .critVal    = 90,
+    .arcRadius  = 55,
+    .arcWidth   = 10,
+    .startAngle = 135,
+    .sweepAngle = 270
+};
+
+// RAM and disk
+static constexpr GaugeConfig M900_MINI_GAUGE = {
+    .minVal     = 0,
+    .maxVal     = 100,
+    .warnVal    = 80,
+    .critVal    = 95,
+    .arcRadius  = 42,
+    .arcWidth   = 8,
+    .startAngle = 135,
+    .sweepAngle = 270
+};
+
 void drawM900(int idx) {
-    auto* d = displays[idx];
-    d->fillScreen(TFT_BLACK);
+    TRACE_SCOPE("draw m900");
+    auto* d = frames[idx];
+    d->fillScreen(PAL_BLACK);
 
     // Title
     d->setTextDatum(middle_center);
     d->setTextSize(1.5);
-    d->setTextColor(TFT_CYAN, TFT_BLACK);
+    d->setTextColor(PAL_CYAN, PAL_BLACK);
     d->drawString("M900", 120, 20);
 
     // CPU gauge (top half, big)
-    GaugeConfig cpuGauge = CPU_GAUGE;
-    cpuGauge.arcRadius = 55;
-    cpuGauge.arcWidth = 10;
-
-    drawArc(d, 120, 85, m900CpuPercent, cpuGauge);
+    readMetrics();
+    float cpu = metric(M_M900_CPU);
+    drawArc<M900_CPU_GAUGE>(d, 120, 85, cpu, stale(M_M900_CPU));
 
     d->setTextSize(1);
-    d->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+    d->setTextColor(PAL_LIGHTGREY, PAL_BLACK);
     d->drawString("CPU", 120, 60);
 
     d->setTextSize(2.5);
-    uint32_t cpuColor = gaugeColor(m900CpuPercent, 75, 90);
-    d->setTextColor(cpuColor, TFT_BLACK);
+    uint32_t cpuColor = tint(M_M900_CPU, gaugeColor(cpu, 75, 90));
+    d->setTextColor(cpuColor, PAL_BLACK);
     char cpuStr[8];
-    snprintf(cpuStr, sizeof(cpuStr), "%.0f%%", m900CpuPercent);
+    snprintf(cpuStr, sizeof(cpuStr), "%.0f%%", cpu);
     d->drawString(cpuStr, 120, 90);
 
     // CPU temp below gauge
     d->setTextSize(1);
-    d->setTextColor(TFT_DARKGREY, TFT_BLACK);
+    d->setTextColor(PAL_DARKGREY, PAL_BLACK);
     char tempStr[10];
-    snprintf(tempStr, sizeof(tempStr), "%.0f°C", m900CpuTemp);
+    snprintf(tempStr, sizeof(tempStr), "%.0f°C", metric(M_M900_CPU_TEMP));
     d->drawString(tempStr, 120, 118);
 
-    // RAM and Disk as two mini gauges at bottom
-    GaugeConfig miniCfg = SMALL_GAUGE;
-    miniCfg.minVal = 0;
-    miniCfg.maxVal = 100;
-    miniCfg.warnVal = 80;
-    miniCfg.critVal = 95;
-
     // RAM (bottom left)
     char ramStr[8];
-    snprintf(ramStr, sizeof(ramStr), "%.0f%%", m900MemPercent);
-    drawMiniGauge(d, 72, 185, m900MemPercent, miniCfg, "RAM", ramStr);
+    snprintf(ramStr, sizeof(ramStr), "%.0f%%", metric(M_M900_MEM));
+    drawMiniGauge<M900_MINI_GAUGE>(d, 72, 185, metric(M_M900_MEM), "RAM", ramStr, stale(M_M900_MEM));
 
     // Disk (bottom right)
     char diskStr[8];
-    snprintf(diskStr, sizeof(diskStr), "%.0f%%", m900DiskPercent);
-    drawMiniGauge(d, 168, 185, m900DiskPercent, miniCfg, "DISK", diskStr);
+    snprintf(diskStr, sizeof(diskStr), "%.0f%%", metric(M_M900_DISK));
+    drawMiniGauge<M900_MINI_GAUGE>(d, 168, 185, metric(M_M900_DISK), "DISK", diskStr, stale(M_M900_DISK));
 }
 
 // ============================================
 // Screen 2: Pi Rack Health (4 mini gauges)
 // ============================================
 void drawPiHealth(int idx) {
-    auto* d = displays[idx];
-    d->fillScreen(TFT_BLACK);
+    TRACE_SCOPE("draw pi rack");
+    auto* d = frames[idx];
+    d->fillScreen(PAL_BLACK);
 
     d->setTextDatum(middle_center);
     d->setTextSize(1.5);
-    d->setTextColor(TFT_GREEN, TFT_BLACK);
+    d->setTextColor(PAL_GREEN, PAL_BLACK);
     d->drawString("PI RACK", 120, 18);
 
     // 4 mini gauges in a 2x2 grid
@@ -253,146 +549,543 @@ void drawPiHealth(int idx) {
         {168, 175},  // bottom-right
     };
 
-    GaugeConfig piGauge = SMALL_GAUGE;
+    readMetrics();
 
     for (int i = 0; i < 4; i++) {
         int cx = positions[i][0];
         int cy = positions[i][1];
 
-        if (piOnline[i]) {
+        // A Pi that stops answering keeps its last reading, greyed
+        if (cur.state[M_PI_TEMP + i] != MS_EMPTY) {
+            float temp = metric(M_PI_TEMP + i);
             char valStr[8];
-            snprintf(valStr, sizeof(valStr), "%.0f°", piTemps[i]);
-            drawMiniGauge(d, cx, cy, piTemps[i], piGauge, piNames[i], valStr);
+            snprintf(valStr, sizeof(valStr), "%.0f°", temp);
+            drawMiniGauge<SMALL_GAUGE>(d, cx, cy, temp, piNames[i], valStr, stale(M_PI_TEMP + i));
         } else {
-            // Offline indicator
+            // Never answered since boot
             d->setTextSize(1);
-            d->setTextColor(TFT_DARKGREY, TFT_BLACK);
+            d->setTextColor(PAL_DARKGREY, PAL_BLACK);
             d->drawString(piNames[i], cx, cy - 12);
             d->setTextSize(1.5);
-            d->setTextColor(TFT_RED, TFT_BLACK);
+            d->setTextColor(PAL_RED, PAL_BLACK);
             d->drawString("OFF", cx, cy + 8);
         }
     }
 }
 
+// ============================================
+// Screen 2 (alternative): ADS-B radar
+// North up, receiver in the middle, RADAR_RANGE_NM at the edge.
+// Blips are coloured by altitude with a short line along their
+// track; the three nearest are labelled.
+// ============================================
+static uint32_t altColor(const RadarBlip& b) {
+    if (b.posAgeS > RADAR_STALE_S) return PAL_DARKGREY;
+    if (!(b.flags & ADSB_HAS_ALT)) return PAL_LIGHTGREY;
+    if (b.altFt < 10000) return PAL_YELLOW;     // approach / departure
+    if (b.altFt < 25000) return PAL_GREEN;
+    return PAL_CYAN;
+}
+
+void drawRadar(int idx) {
+    TRACE_SCOPE("draw radar");
+    auto* d = frames[idx];
+    d->fillScreen(PAL_BLACK);
+
+    // Range rings, north tick
+    const int R = 110;
+    for (int i = 1; i <= 3; i++) d->drawCircle(120, 120, R * i / 3, PAL_ARC_BG);
+    d->drawFastVLine(120, 120 - R, 6, PAL_DARKGREY);
+    d->fillCircle(120, 120, 2, PAL_DARKGREY);
+
+    d->setTextDatum(middle_center);
+    d->setTextSize(0.8);
+    d->setTextColor(PAL_DARKGREY, PAL_BLACK);
+    char ringStr[8];
+    snprintf(ringStr, sizeof(ringStr), "%dnm", RADAR_RANGE_NM * 2 / 3);
+    d->drawString(ringStr, 120, 120 - R * 2 / 3 - 6);
+
+    const RadarView& v = radarView;
+    float scale = (float)R / RADAR_RANGE_NM;
+
+    // Furthest first so the nearest end up on top
+    for (int i = v.blipCount - 1; i >= 0; i--) {
+        const RadarBlip& b = v.blips[i];
+        int x = 120 + (int)lroundf(b.eastNm * scale);
+        int y = 120 - (int)lroundf(b.northNm * scale);
+        uint32_t color = altColor(b);
+
+        if (b.flags & ADSB_HAS_VELOCITY) {
+            float rad = b.track * (float)M_PI / 180;
+            d->drawLine(x, y, x + (int)lroundf(8 * sinf(rad)), y - (int)lroundf(8 * cosf(rad)), color);
+        }
+        d->fillCircle(x, y, 2, color);
+
+        if (i < 3 && b.callsign[0]) {
+            d->setTextDatum(middle_left);
+            d->setTextColor(color, PAL_BLACK);
+            d->drawString(b.callsign, x + 5, y - 6);
+            d->setTextDatum(middle_center);
+        }
+    }
+
+    // Totals along the bottom
+    d->setTextSize(1);
+    if (!v.connected) {
+        d->setTextColor(PAL_DARKGREY, PAL_BLACK);
+        d->drawString("NO FEED", 120, 200);
+        return;
+    }
+    char countStr[24];
+    snprintf(countStr, sizeof(countStr), "%u aircraft", (unsigned)v.aircraft);
+    d->setTextColor(PAL_LIGHTGREY, PAL_BLACK);
+    d->drawString(countStr, 120, 200);
+    char rateStr[24];
+    snprintf(rateStr, sizeof(rateStr), "%lu msg/s", (unsigned long)v.msgsPerSec);
+    d->setTextSize(0.8);
+    d->setTextColor(PAL_DARKGREY, PAL_BLACK);
+    d->drawString(rateStr, 120, 215);
+}
+
 // ============================================
 // Screen 3: Services Status
+// The list scrolls through a window of SVC_ROWS slots under the
+// header with the panel's hardware scroll (displays.h), so any
+// number of services fit. The framebuffer keeps the slots in GRAM
+// order; svcTop is the slot at the top of the window. A scroll
+// step draws only the service coming in, into the slot that just
+// went round to the bottom, and a fetch redraws only the rows (and
+// header) that changed - the bytes sent per step don't grow with
+// the list. With SVC_ROWS services or fewer nothing scrolls.
 // ============================================
-void drawServices(int idx) {
-    auto* d = displays[idx];
-    d->fillScreen(TFT_BLACK);
+#define SVC_TOP     46      // header above, fixed
+#define SVC_ROW_H   17
+#define SVC_ROWS    10      // slots in the window
+#define SVC_X0      44      // row contents stay inside [SVC_X0, SVC_X1): the chord
+#define SVC_X1      196     // of the lowest row they can scroll to
+#define SVC_SUM_X   72      // box of the "n/N online" line
+#define SVC_SUM_Y   30
+#define SVC_SUM_W   96
+#define SVC_SUM_H   12
+
+struct ServiceRow {         // what a slot shows
+    int8_t   service;       // -1 = blank
+    uint32_t dot;
+    int32_t  ms;            // -1 = not shown
+};
+
+static ServiceRow svcRows[SVC_ROWS];
+static int  svcTop   = 0;   // slot at the top of the window
+static int  svcFirst = 0;   // service shown in it
+static bool svcDrawn = false;
+static char svcSummary[32];
+
+static ServiceRow serviceRow(int i) {
+    // Status dot: Kuma's pending / maintenance override up/down
+    uint32_t dot = metric(M_SERVICE_UP + i) > 0 ? PAL_GREEN : PAL_RED;
+    if (serviceStatus[i] == KUMA_PENDING) dot = PAL_YELLOW;
+    if (serviceStatus[i] == KUMA_MAINTENANCE) dot = PAL_CYAN;
+    int32_t ms = stale(M_SERVICE_MS + i) ? -1 : (int32_t)metric(M_SERVICE_MS + i);
+    return {(int8_t)i, tint(M_SERVICE_UP + i, dot), ms};
+}
+
+static void drawServiceRow(LGFX_Sprite* d, int slot, const ServiceRow& r) {
+    int top = SVC_TOP + slot * SVC_ROW_H;
+    d->fillRect(SVC_X0, top, SVC_X1 - SVC_X0, SVC_ROW_H, PAL_BLACK);
+    svcRows[slot] = r;
+    if (r.service < 0) return;
+
+    int y = top + 9;
+    d->fillCircle(50, y, 4, r.dot);
 
+    d->setTextSize(1);
+    d->setTextColor(PAL_WHITE, PAL_BLACK);
+    d->setTextDatum(middle_left);
+    d->drawString(services[r.service].name, 60, y);
+
+    if (r.ms >= 0) {
+        char msStr[16];
+        snprintf(msStr, sizeof(msStr), "%dms", (int)r.ms);
+        d->setTextColor(PAL_LIGHTGREY, PAL_BLACK);
+        d->setTextDatum(middle_right);
+        d->drawString(msStr, SVC_X1 - 6, y);
+    }
     d->setTextDatum(middle_center);
-    d->setTextSize(1.5);
-    d->setTextColor(TFT_YELLOW, TFT_BLACK);
-    d->drawString("SERVICES", 120, 18);
+}
 
-    // Count up/down
-    int upCount = 0;
+static void servicesSummary(char* buf, size_t cap, int& upCount) {
+    upCount = 0;
     for (int i = 0; i < NUM_SERVICES; i++) {
-        if (services[i].up) upCount++;
+        if (metric(M_SERVICE_UP + i) > 0) upCount++;
     }
+    snprintf(buf, cap, "%d/%d online", upCount, NUM_SERVICES);
+}
 
-    // Summary
+static void drawServicesSummary(LGFX_Sprite* d) {
+    int upCount;
+    servicesSummary(svcSummary, sizeof(svcSummary), upCount);
+    d->fillRect(SVC_SUM_X, SVC_SUM_Y, SVC_SUM_W, SVC_SUM_H, PAL_BLACK);
+    d->setTextDatum(middle_center);
     d->setTextSize(1);
-    char sumStr[16];
-    snprintf(sumStr, sizeof(sumStr), "%d/%d online", upCount, NUM_SERVICES);
-    uint32_t sumColor = (upCount == NUM_SERVICES) ? TFT_GREEN : TFT_YELLOW;
-    d->setTextColor(sumColor, TFT_BLACK);
-    d->drawString(sumStr, 120, 36);
-
-    // Service list with dots
-    int y = 55;
-    int spacing = 17;
-
-    for (int i = 0; i < NUM_SERVICES && y < 230; i++) {
-        // Status dot
-        uint32_t dotColor = services[i].up ? TFT_GREEN : TFT_RED;
-        d->fillCircle(50, y, 4, dotColor);
-
-        // Service name
-        d->setTextSize(1);
-        d->setTextColor(TFT_WHITE, TFT_BLACK);
-        d->setTextDatum(middle_left);
-        d->drawString(services[i].name, 60, y);
-        d->setTextDatum(middle_center);
+    uint32_t sumColor = (upCount == NUM_SERVICES) ? PAL_GREEN : PAL_YELLOW;
+    d->setTextColor(sumColor, PAL_BLACK);
+    d->drawString(svcSummary, 120, 36);
+}
 
-        y += spacing;
+static void serviceSlotRect(int slot, int& x, int& y, int& w, int& h) {
+    x = SVC_X0;
+    y = SVC_TOP + slot * SVC_ROW_H;
+    w = SVC_X1 - SVC_X0;
+    h = SVC_ROW_H;
+}
+
+void drawServices(int idx) {
+    TRACE_SCOPE("draw services");
+    auto* d = frames[idx];
+    d->fillScreen(PAL_BLACK);
+    d->setTextDatum(middle_center);
+    d->setTextSize(1.5);
+    d->setTextColor(PAL_YELLOW, PAL_BLACK);
+    d->drawString("SERVICES", 120, 18);
+
+    readMetrics();
+    drawServicesSummary(d);
+
+    // Window back at slot 0, same services in view
+    svcTop = 0;
+    for (int slot = 0; slot < SVC_ROWS; slot++) {
+        ServiceRow blank = {-1, 0, -1};
+        drawServiceRow(d, slot, slot < NUM_SERVICES ? serviceRow((svcFirst + slot) % NUM_SERVICES) : blank);
     }
+    svcDrawn = true;
+}
+
+PanelScroll servicesScroll() {
+    if (NUM_SERVICES <= SVC_ROWS) return {SVC_TOP, 0, SVC_TOP};
+    return {SVC_TOP, SVC_ROWS * SVC_ROW_H, (uint8_t)(SVC_TOP + svcTop * SVC_ROW_H)};
+}
+
+bool updateServices(int idx, bool scroll, int& x, int& y, int& w, int& h) {
+    auto* d = frames[idx];
+    if (!svcDrawn) {
+        // Splash or a restored frame: ours starts with a full draw
+        if (scroll) return false;
+        drawServices(idx);
+        x = y = 0;
+        w = DISPLAY_WIDTH;
+        h = DISPLAY_HEIGHT;
+        return true;
+    }
+    readMetrics();
+
+    if (scroll && NUM_SERVICES > SVC_ROWS) {
+        // The top slot goes round to the bottom for the next service
+        TRACE_SCOPE("scroll services");
+        int slot = svcTop;
+        svcTop = (svcTop + 1) % SVC_ROWS;
+        svcFirst = (svcFirst + 1) % NUM_SERVICES;
+        drawServiceRow(d, slot, serviceRow((svcFirst + SVC_ROWS - 1) % NUM_SERVICES));
+        serviceSlotRect(slot, x, y, w, h);
+        return true;
+    }
+
+    char summary[sizeof(svcSummary)];
+    int upCount;
+    servicesSummary(summary, sizeof(summary), upCount);
+    if (strcmp(summary, svcSummary) != 0) {
+        drawServicesSummary(d);
+        x = SVC_SUM_X;
+        y = SVC_SUM_Y;
+        w = SVC_SUM_W;
+        h = SVC_SUM_H;
+        return true;
+    }
+
+    for (int slot = 0; slot < SVC_ROWS; slot++) {
+        const ServiceRow& shown = svcRows[slot];
+        if (shown.service < 0) continue;
+        ServiceRow r = serviceRow(shown.service);
+        if (r.dot == shown.dot && r.ms == shown.ms) continue;
+        TRACE_SCOPE("draw service row");
+        drawServiceRow(d, slot, r);
+        serviceSlotRect(slot, x, y, w, h);
+        return true;
+    }
+    return false;
 }
 
 // ============================================
-// Screen 4: Custom Stats (Network bandwidth)
+// Screen 4: Custom Stats (derived metrics from config.h)
 // ============================================
+static constexpr GaugeConfig CUSTOM_MAIN_GAUGE = {
+    .minVal     = 0,
+    .maxVal     = CUSTOM_MAIN_MAX,
+    .warnVal    = CUSTOM_MAIN_MAX * 0.5f,
+    .critVal    = CUSTOM_MAIN_MAX * 0.8f,
+    .arcRadius  = 55,
+    .arcWidth   = 10,
+    .startAngle = 135,
+    .sweepAngle = 270
+};
+
+// "--" when undefined, "ERR" when the expression didn't compile
+static void formatExpr(char* buf, size_t cap, const Expr& e) {
+    if (!e.valid) strlcpy(buf, "ERR", cap);
+    else if (isnan(e.value)) strlcpy(buf, "--", cap);
+    else snprintf(buf, cap, "%.1f", e.value);
+}
+
 void drawCustom(int idx) {
-    auto* d = displays[idx];
-    d->fillScreen(TFT_BLACK);
+    TRACE_SCOPE("draw custom");
+    auto* d = frames[idx];
+    d->fillScreen(PAL_BLACK);
 
     d->setTextDatum(middle_center);
     d->setTextSize(1.5);
-    d->setTextColor(TFT_MAGENTA, TFT_BLACK);
-    d->drawString("NETWORK", 120, 20);
-
-    // Download gauge
-    GaugeConfig netGauge = DEFAULT_GAUGE;
-    netGauge.minVal = 0;
-    netGauge.maxVal = 100;  // 100 Mbps scale
-    netGauge.warnVal = 50;
-    netGauge.critVal = 80;
-    netGauge.arcRadius = 55;
-    netGauge.arcWidth = 10;
-
-    // Down (top)
-    drawArc(d, 120, 88, netDownMbps, netGauge);
+    d->setTextColor(PAL_MAGENTA, PAL_BLACK);
+    d->drawString(CUSTOM_TITLE, 120, 20);
+
+    // Main gauge (top)
+    float mainVal = isnan(customMain.value) ? 0 : customMain.value;
+    drawArc<CUSTOM_MAIN_GAUGE>(d, 120, 88, mainVal, customMain.stale);
     d->setTextSize(1);
-    d->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
-    d->drawString("DOWN", 120, 63);
+    d->setTextColor(PAL_LIGHTGREY, PAL_BLACK);
+    d->drawString(CUSTOM_MAIN_LABEL, 120, 63);
     d->setTextSize(2);
-    d->setTextColor(TFT_GREEN, TFT_BLACK);
-    char downStr[12];
-    snprintf(downStr, sizeof(downStr), "%.1f", netDownMbps);
-    d->drawString(downStr, 120, 88);
+    d->setTextColor(customMain.stale ? PAL_DARKGREY : PAL_GREEN, PAL_BLACK);
+    char mainStr[12];
+    formatExpr(mainStr, sizeof(mainStr), customMain);
+    d->drawString(mainStr, 120, 88);
     d->setTextSize(1);
-    d->setTextColor(TFT_DARKGREY, TFT_BLACK);
-    d->drawString("Mbps", 120, 108);
+    d->setTextColor(PAL_DARKGREY, PAL_BLACK);
+    d->drawString(CUSTOM_MAIN_UNIT, 120, 108);
 
-    // Up (bottom, smaller text)
+    // Secondary (bottom, smaller text)
     d->setTextSize(1);
-    d->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
-    d->drawString("UP", 120, 150);
+    d->setTextColor(PAL_LIGHTGREY, PAL_BLACK);
+    d->drawString(CUSTOM_SUB_LABEL, 120, 150);
     d->setTextSize(2);
-    d->setTextColor(TFT_CYAN, TFT_BLACK);
-    char upStr[12];
-    snprintf(upStr, sizeof(upStr), "%.1f", netUpMbps);
-    d->drawString(upStr, 120, 172);
+    d->setTextColor(customSub.stale ? PAL_DARKGREY : PAL_CYAN, PAL_BLACK);
+    char subStr[12];
+    formatExpr(subStr, sizeof(subStr), customSub);
+    d->drawString(subStr, 120, 172);
     d->setTextSize(1);
-    d->setTextColor(TFT_DARKGREY, TFT_BLACK);
-    d->drawString("Mbps", 120, 192);
+    d->setTextColor(PAL_DARKGREY, PAL_BLACK);
+    d->drawString(CUSTOM_SUB_UNIT, 120, 192);
 
     // WiFi signal
     d->setTextSize(0.8);
-    d->setTextColor(TFT_DARKGREY, TFT_BLACK);
+    d->setTextColor(PAL_DARKGREY, PAL_BLACK);
     char wifiStr[20];
     snprintf(wifiStr, sizeof(wifiStr), "WiFi: %ddBm", WiFi.RSSI());
     d->drawString(wifiStr, 120, 220);
 }
 
+// ============================================
+// Screen 4 (alternative): Switch top talkers
+// ============================================
+void drawSwitches(int idx) {
+    TRACE_SCOPE("draw switches");
+    auto* d = frames[idx];
+    d->fillScreen(PAL_BLACK);
+
+    d->setTextDatum(middle_center);
+    d->setTextSize(1.5);
+    d->setTextColor(PAL_MAGENTA, PAL_BLACK);
+    d->drawString("SWITCH", 120, 20);
+
+    // Totals across every port
+    readMetrics();
+    const int ports = METRIC_SWITCHES * METRIC_SWITCH_PORTS;
+    float totalIn = 0, totalOut = 0;
+    for (int i = 0; i < ports; i++) {
+        totalIn += metric(M_SWITCH_IN_MBPS + i);
+        totalOut += metric(M_SWITCH_OUT_MBPS + i);
+    }
+    char totStr[32];
+    snprintf(totStr, sizeof(totStr), "IN %.1f  OUT %.1f", totalIn, totalOut);
+    d->setTextSize(1);
+    d->setTextColor(tint(M_SWITCH_IN_MBPS, PAL_LIGHTGREY), PAL_BLACK);
+    d->drawString(totStr, 120, 40);
+
+    // Busiest ports first (in + out), never-sampled ones left out
+    int order[ports];
+    int count = 0;
+    for (int i = 0; i < ports; i++) {
+        if (cur.state[M_SWITCH_IN_MBPS + i] != MS_EMPTY) order[count++] = i;
+    }
+    auto load = [](int i) { return metric(M_SWITCH_IN_MBPS + i) + metric(M_SWITCH_OUT_MBPS + i); };
+    int rows = min(count, SWITCH_TOP_TALKERS);
+    for (int r = 0; r < rows; r++) {
+        for (int j = r + 1; j < count; j++) {
+            if (load(order[j]) > load(order[r])) std::swap(order[r], order[j]);
+        }
+    }
+
+    if (rows == 0) {
+        d->setTextColor(PAL_DARKGREY, PAL_BLACK);
+        d->drawString("No SNMP reply", 120, 120);
+        return;
+    }
+
+    int y = 68;
+    for (int r = 0; r < rows; r++, y += 28) {
+        int i = order[r];
+        float mbps = load(i);
+        bool old = stale(M_SWITCH_IN_MBPS + i);
+
+        // Port label
+        char label[16];
+        snprintf(label, sizeof(label), "%d/%d", i / METRIC_SWITCH_PORTS + 1,
+                 i % METRIC_SWITCH_PORTS + 1);
+        d->setTextSize(1);
+        d->setTextDatum(middle_left);
+        d->setTextColor(PAL_LIGHTGREY, PAL_BLACK);
+        d->drawString(label, 38, y);
+
+        // Bar, full scale = line rate both ways
+        float pct = constrain(mbps / (2.0f * SWITCH_PORT_MBPS) * 100, 0, 100);
+        int barX = 70, barW = 100, barH = 8;
+        d->drawRect(barX, y - barH / 2, barW, barH, PAL_ARC_BG);
+        int fillW = (int)(pct / 100 * (barW - 2));
+        d->fillRect(barX + 1, y - barH / 2 + 1, fillW, barH - 2,
+                    old ? PAL_DARKGREY : gaugeColor(pct, 50, 80));
+
+        // Rate
+        char rateStr[10];
+        snprintf(rateStr, sizeof(rateStr), "%.1f", mbps);
+        d->setTextDatum(middle_right);
+        d->setTextColor(old ? PAL_DARKGREY : PAL_WHITE, PAL_BLACK);
+        d->drawString(rateStr, 205, y);
+        d->setTextDatum(middle_center);
+    }
+
+    d->setTextSize(0.8);
+    d->setTextColor(PAL_DARKGREY, PAL_BLACK);
+    d->drawString("Mbps, in + out", 120, 215);
+}
+
+// ============================================
+// Screen 4 (alternative): Pi-hole
+// ============================================
+static constexpr GaugeConfig PIHOLE_QPS_GAUGE = {
+    .minVal     = 0,
+    .maxVal     = PIHOLE_QPS_MAX,
+    .warnVal    = PIHOLE_QPS_MAX * 0.5f,
+    .critVal    = PIHOLE_QPS_MAX * 0.8f,
+    .arcRadius  = 42,
+    .arcWidth   = 8,
+    .startAngle = 135,
+    .sweepAngle = 270
+};
+
+static constexpr GaugeConfig PIHOLE_BLOCK_GAUGE = {
+    .minVal     = 0,
+    .maxVal     = 100,
+    .warnVal    = 40,
+    .critVal    = 60,
+    .arcRadius  = 42,
+    .arcWidth   = 8,
+    .startAngle = 135,
+    .sweepAngle = 270
+};
+
+// 950, 12.3k, 1.2M
+static void formatCount(char* buf, size_t cap, double n) {
+    if (n < 1000) snprintf(buf, cap, "%.0f", n);
+    else if (n < 1000000) snprintf(buf, cap, "%.1fk", n / 1000);
+    else snprintf(buf, cap, "%.1fM", n / 1000000);
+}
+
+void drawPihole(int idx) {
+    TRACE_SCOPE("draw pihole");
+    auto* d = frames[idx];
+    d->fillScreen(PAL_BLACK);
+
+    d->setTextDatum(middle_center);
+    d->setTextSize(1.5);
+    d->setTextColor(PAL_RED, PAL_BLACK);
+    d->drawString("PI-HOLE", 120, 20);
+
+    readMetrics();
+
+    // Query rate (top left) and blocked share (top right)
+    float qps = metric(M_DNS_QPS);
+    char qpsStr[8];
+    snprintf(qpsStr, sizeof(qpsStr), qps < 10 ? "%.1f" : "%.0f", qps);
+    drawMiniGauge<PIHOLE_QPS_GAUGE>(d, 72, 85, qps, "QUERY/S", qpsStr, stale(M_DNS_QPS));
+
+    float pct = metric(M_DNS_BLOCK_PCT);
+    char pctStr[8];
+    snprintf(pctStr, sizeof(pctStr), "%.0f%%", pct);
+    drawMiniGauge<PIHOLE_BLOCK_GAUGE>(d, 168, 85, pct, "BLOCKED", pctStr, stale(M_DNS_BLOCK_PCT));
+
+    // 24-hour totals
+    char total[10], blocked[10], line[40];
+    formatCount(total, sizeof(total), metric(M_DNS_QUERIES));
+    formatCount(blocked, sizeof(blocked), metric(M_DNS_BLOCKED));
+    snprintf(line, sizeof(line), "%s queries, %s blocked", total, blocked);
+    d->setTextSize(1);
+    d->setTextColor(tint(M_DNS_QUERIES, PAL_LIGHTGREY), PAL_BLACK);
+    d->drawString(line, 120, 142);
+
+    // Top clients, bars scaled to the busiest
+    float top = metric(M_DNS_CLIENT_QUERIES);
+    int y = 164;
+    for (int i = 0; i < METRIC_DNS_CLIENTS; i++, y += 20) {
+        if (!dnsClientNames[i][0] || cur.state[M_DNS_CLIENT_QUERIES + i] == MS_EMPTY) break;
+        float n = metric(M_DNS_CLIENT_QUERIES + i);
+        bool old = stale(M_DNS_CLIENT_QUERIES + i);
+
+        d->setTextDatum(middle_left);
+        d->setTextColor(PAL_LIGHTGREY, PAL_BLACK);
+        d->drawString(dnsClientNames[i], 40, y);
+
+        int barX = 112, barW = 50, barH = 6;
+        int fillW = top > 0 ? (int)(n / top * barW) : 0;
+        d->fillRect(barX, y - barH / 2, barW, barH, PAL_ARC_BG);
+        d->fillRect(barX, y - barH / 2, constrain(fillW, 0, barW), barH, old ? PAL_DARKGREY : PAL_RED);
+
+        char count[10];
+        formatCount(count, sizeof(count), n);
+        d->setTextDatum(middle_right);
+        d->setTextColor(old ? PAL_DARKGREY : PAL_WHITE, PAL_BLACK);
+        d->drawString(count, 200, y);
+    }
+    d->setTextDatum(middle_center);
+}
+
 // ============================================
 // Screen 5: Clock
 // ============================================
 void drawClock(int idx) {
-    auto* d = displays[idx];
-    d->fillScreen(TFT_BLACK);
+    TRACE_SCOPE("draw clock");
+    auto* d = frames[idx];
+    d->fillScreen(PAL_BLACK);
 
     // Subtle circle border
-    d->drawCircle(120, 120, 118, 0x2104);
-    d->drawCircle(120, 120, 119, 0x2104);
+    d->drawCircle(120, 120, 118, PAL_ARC_BG);
+    d->drawCircle(120, 120, 119, PAL_ARC_BG);
 
+    // Until NTP lands, show uptime and what boot is waiting on
     struct tm timeinfo;
-    if (!getLocalTime(&timeinfo)) {
+    if (!getLocalTime(&timeinfo, 0)) {
+        uint32_t up = millis() / 1000;
+        char upStr[16];
+        snprintf(upStr, sizeof(upStr), "%u:%02u", (unsigned)(up / 60), (unsigned)(up % 60));
+
         d->setTextDatum(middle_center);
-        d->setTextSize(2);
-        d->drawString("No Time", 120, 120);
+        d->setTextSize(1.5);
+        d->setTextColor(PAL_DARKGREY, PAL_BLACK);
+        d->drawString("UPTIME", 120, 80);
+        d->setTextSize(3);
+        d->setTextColor(PAL_LIGHTGREY, PAL_BLACK);
+        d->drawString(upStr, 120, 115);
+        if (bootStatus) {
+            d->setTextSize(1.5);
+            d->setTextColor(PAL_DARKGREY, PAL_BLACK);
+            d->drawString(bootStatus, 120, 155);
+        }
         return;
     }
 
@@ -414,36 +1107,49 @@ void drawClock(int idx) {
 
     // Time (big)
     d->setTextSize(4);
-    d->setTextColor(TFT_WHITE, TFT_BLACK);
+    d->setTextColor(PAL_WHITE, PAL_BLACK);
     d->drawString(t, 120, 90);
 
     // AM/PM
     d->setTextSize(1.5);
-    d->setTextColor(TFT_DARKGREY, TFT_BLACK);
+    d->setTextColor(PAL_DARKGREY, PAL_BLACK);
     d->drawString(ampm, 120, 120);
 
     // Day
     d->setTextSize(2);
-    d->setTextColor(TFT_LIGHTGREY, TFT_BLACK);
+    d->setTextColor(PAL_LIGHTGREY, PAL_BLACK);
     d->drawString(dayStr, 120, 150);
 
     // Date
     d->setTextSize(1.5);
-    d->setTextColor(TFT_DARKGREY, TFT_BLACK);
+    d->setTextColor(PAL_DARKGREY, PAL_BLACK);
     d->drawString(dateStr, 120, 175);
 }
 
+void setBootStatus(const char* status) {
+    bootStatus = status;
+}
+
 // ============================================
 // Boot splash
 // ============================================
-void drawBootSplash(int idx, const char* label) {
-    auto* d = displays[idx];
-    d->fillScreen(TFT_BLACK);
-    d->drawCircle(120, 120, 118, 0x2104);
+void drawBootSplash(int idx) {
+    auto* d = frames[idx];
+    d->fillScreen(PAL_BLACK);
+    d->drawCircle(120, 120, 118, PAL_ARC_BG);
+}
+
+void drawBootLabel(int idx, const char* label, int& x, int& y, int& w, int& h) {
+    auto* d = frames[idx];
     d->setTextDatum(middle_center);
     d->setTextSize(1.5);
-    d->setTextColor(TFT_DARKGREY, TFT_BLACK);
+    d->setTextColor(PAL_DARKGREY, PAL_BLACK);
     d->drawString(label, 120, 120);
+
+    w = d->textWidth(label) + 2;
+    h = d->fontHeight() + 2;
+    x = 120 - w / 2;
+    y = 120 - h / 2;
 }
 
 // ============================================
@@ -451,89 +1157,505 @@ void drawBootSplash(int idx, const char* label) {
 // ============================================
 
 void fetchUnraid() {
+    TRACE_SCOPE("fetch unraid");
     char url[64];
     snprintf(url, sizeof(url), "http://%s:%d/stats", UNRAID_IP, UNRAID_STATS_PORT);
 
-    JsonDocument doc;
-    if (fetchJson(url, doc)) {
+    UnraidStats st = UNRAID_DEFAULTS;
+    if (fetchJson(url, UNRAID_SCHEMA, &st)) {
         // Drives
-        JsonArray drives = doc["drives"];
-        unraidDriveCount = min((int)drives.size(), 8);
-        for (int i = 0; i < unraidDriveCount; i++) {
-            unraidDriveTemps[i] = drives[i]["temp_c"] | 0.0f;
-            strlcpy(unraidDriveNames[i], drives[i]["device"] | "??", sizeof(unraidDriveNames[i]));
+        int driveCount = min((int)st.driveCount, METRIC_DRIVES);
+        for (int i = 0; i < driveCount; i++) {
+            metricSet(M_UNRAID_DRIVE_TEMP + i, st.drives[i].tempC, SRC_UNRAID);
+            strlcpy(unraidDriveNames[i], st.drives[i].device, sizeof(unraidDriveNames[i]));
         }
+        metricSet(M_UNRAID_DRIVE_COUNT, driveCount, SRC_UNRAID);
 
         // Storage
-        unraidStorageUsedTB = (doc["storage"]["used_gb"] | 0.0f) / 1024.0;
-        unraidStorageTotalTB = (doc["storage"]["total_gb"] | 0.0f) / 1024.0;
+        metricSet(M_UNRAID_STORAGE_USED_TB, st.storageUsedGB / 1024.0, SRC_UNRAID);
+        metricSet(M_UNRAID_STORAGE_TOTAL_TB, st.storageTotalGB / 1024.0, SRC_UNRAID);
 
         // System
-        unraidCpuPercent = doc["system"]["cpu_percent"] | 0.0f;
-        unraidMemPercent = doc["system"]["mem_percent"] | 0.0f;
+        metricSet(M_UNRAID_CPU, st.cpuPercent, SRC_UNRAID);
+        metricSet(M_UNRAID_MEM, st.memPercent, SRC_UNRAID);
 
         // Docker
-        unraidDockerRunning = doc["docker"]["running"] | 0;
-        unraidDockerTotal = doc["docker"]["total"] | 0;
+        metricSet(M_UNRAID_DOCKER_RUNNING, st.dockerRunning, SRC_UNRAID);
+        metricSet(M_UNRAID_DOCKER_TOTAL, st.dockerTotal, SRC_UNRAID);
 
         // Array
-        unraidArrayStatus = doc["array_status"].as<String>();
+        strlcpy(unraidArrayStatus, st.arrayStatus, sizeof(unraidArrayStatus));
+        metricSet(M_UNRAID_ARRAY_STARTED, strcmp(unraidArrayStatus, "STARTED") == 0, SRC_UNRAID);
+        markLive(LIVE_UNRAID);
+    } else {
+        metricMarkStale(M_UNRAID_DRIVE_TEMP, M_M900_CPU - M_UNRAID_DRIVE_TEMP);
     }
+    metricsPublish();
 }
 
 void fetchM900() {
+    TRACE_SCOPE("fetch m900");
     char url[64];
     snprintf(url, sizeof(url), "http://%s:%d/stats", M900_IP, M900_STATS_PORT);
 
-    JsonDocument doc;
-    if (fetchJson(url, doc)) {
-        m900CpuPercent = doc["cpu"]["percent"] | 0.0f;
-        m900CpuTemp = doc["cpu"]["temp_c"] | 0.0f;
-        m900MemPercent = doc["memory"]["percent"] | 0.0f;
-        m900MemUsedGB = doc["memory"]["used_gb"] | 0.0f;
-        m900MemTotalGB = doc["memory"]["total_gb"] | 0.0f;
-        m900DiskPercent = doc["disk"]["percent"] | 0.0f;
-        m900DiskUsedGB = doc["disk"]["used_gb"] | 0.0f;
-        m900DiskTotalGB = doc["disk"]["total_gb"] | 0.0f;
+    M900Stats st = {};
+    if (fetchJson(url, M900_SCHEMA, &st)) {
+        metricSet(M_M900_CPU, st.cpuPercent, SRC_M900);
+        metricSet(M_M900_CPU_TEMP, st.cpuTempC, SRC_M900);
+        metricSet(M_M900_MEM, st.memPercent, SRC_M900);
+        metricSet(M_M900_MEM_USED_GB, st.memUsedGB, SRC_M900);
+        metricSet(M_M900_MEM_TOTAL_GB, st.memTotalGB, SRC_M900);
+        metricSet(M_M900_DISK, st.diskPercent, SRC_M900);
+        metricSet(M_M900_DISK_USED_GB, st.diskUsedGB, SRC_M900);
+        metricSet(M_M900_DISK_TOTAL_GB, st.diskTotalGB, SRC_M900);
 
         // Network bandwidth calc
-        prevBytesSent = netBytesSent;
-        prevBytesRecv = netBytesRecv;
-        netBytesSent = doc["network"]["bytes_sent"] | 0L;
-        netBytesRecv = doc["network"]["bytes_recv"] | 0L;
+        double bytesSent = st.bytesSent;
+        double bytesRecv = st.bytesRecv;
+        metricSet(M_M900_NET_SENT, bytesSent, SRC_M900);
+        metricSet(M_M900_NET_RECV, bytesRecv, SRC_M900);
 
         if (prevBytesSent > 0) {
             float intervalSec = M900_UPDATE_MS / 1000.0;
-            netUpMbps = ((netBytesSent - prevBytesSent) * 8.0 / 1000000.0) / intervalSec;
-            netDownMbps = ((netBytesRecv - prevBytesRecv) * 8.0 / 1000000.0) / intervalSec;
+            metricSet(M_M900_NET_UP_MBPS,
+                      ((bytesSent - prevBytesSent) * 8.0 / 1000000.0) / intervalSec, SRC_M900);
+            metricSet(M_M900_NET_DOWN_MBPS,
+                      ((bytesRecv - prevBytesRecv) * 8.0 / 1000000.0) / intervalSec, SRC_M900);
         }
+        prevBytesSent = bytesSent;
+        prevBytesRecv = bytesRecv;
+        markLive(LIVE_M900);
+    } else {
+        metricMarkStale(M_M900_CPU, M_PI_TEMP - M_M900_CPU);
     }
+    metricsPublish();
 }
 
 void fetchPiHealth() {
-    for (int i = 0; i < 4; i++) {
+    TRACE_SCOPE("fetch pis");
+    for (int i = 0; i < METRIC_PIS; i++) {
+        TRACE_SCOPE_ARG("pi", i);
         char url[80];
         snprintf(url, sizeof(url), "http://%s:9200/stats", piHosts[i]);
 
-        JsonDocument doc;
-        if (fetchJson(url, doc)) {
-            piOnline[i] = true;
-            piTemps[i] = doc["cpu"]["temp_c"] | 0.0f;
-            piCpu[i] = doc["cpu"]["percent"] | 0.0f;
-            piMem[i] = doc["memory"]["percent"] | 0.0f;
+        PiStats st = {};
+        MetricSource src = (MetricSource)(SRC_PI + i);
+        if (fetchJson(url, PI_SCHEMA, &st)) {
+            metricSet(M_PI_TEMP + i, st.tempC, src);
+            metricSet(M_PI_CPU + i, st.cpuPercent, src);
+            metricSet(M_PI_MEM + i, st.memPercent, src);
         } else {
-            piOnline[i] = false;
+            metricMarkStale(M_PI_TEMP + i);
+            metricMarkStale(M_PI_CPU + i);
+            metricMarkStale(M_PI_MEM + i);
         }
     }
+    metricsPublish();
+    markLive(LIVE_PIS);
 }
 
 void fetchServices() {
-    for (int i = 0; i < NUM_SERVICES; i++) {
-        services[i].up = httpCheck(services[i].url);
+    TRACE_SCOPE("fetch services");
+    KumaMonitor mon[METRIC_SERVICES];
+    if (fetchKuma(mon)) {
+        for (int i = 0; i < NUM_SERVICES; i++) {
+            // A monitor missing from the scrape (renamed, deleted) goes grey
+            if (mon[i].status < 0) {
+                metricMarkStale(M_SERVICE_UP + i);
+                metricMarkStale(M_SERVICE_MS + i);
+                continue;
+            }
+            serviceStatus[i] = (uint8_t)mon[i].status;
+            metricSet(M_SERVICE_UP + i, mon[i].status == KUMA_UP ? 1 : 0, SRC_KUMA);
+            if (mon[i].responseMs >= 0) {
+                metricSet(M_SERVICE_MS + i, mon[i].responseMs, SRC_KUMA);
+            } else {
+                metricMarkStale(M_SERVICE_MS + i);
+            }
+        }
+        markLive(LIVE_SERVICES);
+    } else {
+        metricMarkStale(M_SERVICE_UP, 2 * METRIC_SERVICES);
+    }
+    metricsPublish();
+}
+
+void fetchSwitches() {
+    TRACE_SCOPE("fetch switches");
+    PortWalk walks[METRIC_SWITCHES];
+    uint32_t answered = snmpPollSwitches(walks);
+    uint32_t now = millis();
+
+    for (int s = 0; s < METRIC_SWITCHES; s++) {
+        int first = s * METRIC_SWITCH_PORTS;
+        if (!(answered & (1u << s))) {
+            metricMarkStale(M_SWITCH_IN_MBPS + first, METRIC_SWITCH_PORTS);
+            metricMarkStale(M_SWITCH_OUT_MBPS + first, METRIC_SWITCH_PORTS);
+            continue;
+        }
+
+        // Rates over the time actually elapsed; a counter that went
+        // backwards (switch rebooted) waits for the next poll
+        SwitchCounters& prev = switchPrev[s];
+        const SwitchCounters& c = walks[s].c;
+        MetricSource src = (MetricSource)(SRC_SWITCH + s);
+        uint32_t dt = now - prev.sampledMs;
+        if (prev.sampledMs != 0 && dt > 0) {
+            for (int p = 0; p < METRIC_SWITCH_PORTS; p++) {
+                if (c.in[p] >= prev.in[p]) {
+                    metricSet(M_SWITCH_IN_MBPS + first + p,
+                              (c.in[p] - prev.in[p]) * 8.0 / 1000.0 / dt, src);
+                }
+                if (c.out[p] >= prev.out[p]) {
+                    metricSet(M_SWITCH_OUT_MBPS + first + p,
+                              (c.out[p] - prev.out[p]) * 8.0 / 1000.0 / dt, src);
+                }
+            }
+        }
+        prev = c;
+        prev.sampledMs = now;
+    }
+    metricsPublish();
+    if (answered) markLive(LIVE_SWITCHES);
+}
+
+// The feed task does the work; this takes the loop's copy for the
+// next draw and keeps the totals in the metric store
+void fetchRadar() {
+    TRACE_SCOPE("fetch radar");
+    adsbRead(radarView);
+    if (radarView.connected) {
+        metricSet(M_ADSB_AIRCRAFT, radarView.aircraft, SRC_ADSB);
+        metricSet(M_ADSB_MSG_RATE, radarView.msgsPerSec, SRC_ADSB);
+    } else {
+        metricMarkStale(M_ADSB_AIRCRAFT, 2);
+    }
+    metricsPublish();
+}
+
+// Rates from counter deltas: queries per second over the last poll,
+// blocked share over the last PIHOLE_RATIO_POLLS. FTL's counts are
+// for a sliding 24 hours, so they drop when it ages old queries out
+// (every 10 minutes) or restarts; the history starts over then.
+static void dnsRates(const PiholeSummary& st, uint32_t now) {
+    const int n = PIHOLE_RATIO_POLLS;
+    if (dnsHistoryLen > 0) {
+        const DnsCounters& prev = dnsHistory[(dnsHistoryNext + n - 1) % n];
+        const DnsCounters& oldest = dnsHistory[dnsHistoryLen < n ? 0 : dnsHistoryNext];
+        if (st.total < prev.total || st.blocked < prev.blocked) {
+            dnsHistoryLen = 0;
+            dnsHistoryNext = 0;
+        } else if (now != prev.sampledMs) {
+            metricSet(M_DNS_QPS, (st.total - prev.total) * 1000.0 / (now - prev.sampledMs), SRC_PIHOLE);
+            double queries = st.total - oldest.total;
+            metricSet(M_DNS_BLOCK_PCT, queries > 0 ? (st.blocked - oldest.blocked) * 100.0 / queries : 0,
+                      SRC_PIHOLE);
+        }
+    }
+    dnsHistory[dnsHistoryNext] = {st.total, st.blocked, now};
+    dnsHistoryNext = (dnsHistoryNext + 1) % n;
+    if (dnsHistoryLen < n) dnsHistoryLen++;
+}
+
+// Summary counters every poll. The top-client list is only asked
+// for (and parsed) when the totals have moved since it was last
+// listed and it is PIHOLE_CLIENTS_MS old; in between, the list
+// held is as current as Pi-hole's own.
+void fetchPihole() {
+    TRACE_SCOPE("fetch pihole");
+    PiholeSummary st = {};
+    if (!piholeGet("/api/stats/summary", PIHOLE_SUMMARY_SCHEMA, &st)) {
+        metricMarkStale(M_DNS_QUERIES, M_COUNT - M_DNS_QUERIES);
+        metricsPublish();
+        return;
+    }
+
+    uint32_t now = millis();
+    metricSet(M_DNS_QUERIES, st.total, SRC_PIHOLE);
+    metricSet(M_DNS_BLOCKED, st.blocked, SRC_PIHOLE);
+    metricSet(M_DNS_FORWARDED, st.forwarded, SRC_PIHOLE);
+    metricSet(M_DNS_CACHED, st.cached, SRC_PIHOLE);
+    metricSet(M_DNS_CLIENTS, st.activeClients, SRC_PIHOLE);
+    dnsRates(st, now);
+
+    bool listed = true;
+    if (st.total != dnsListedTotal && (!dnsListedMs || now - dnsListedMs >= PIHOLE_CLIENTS_MS)) {
+        char path[48];
+        snprintf(path, sizeof(path), "/api/stats/top_clients?count=%d", METRIC_DNS_CLIENTS);
+        PiholeTopClients top = {};
+        listed = piholeGet(path, PIHOLE_CLIENTS_SCHEMA, &top);
+        if (listed) {
+            dnsClientCount = min((int)top.clientCount, METRIC_DNS_CLIENTS);
+            for (int i = 0; i < METRIC_DNS_CLIENTS; i++) {
+                if (i < dnsClientCount) {
+                    dnsClientName(dnsClientNames[i], sizeof(dnsClientNames[i]), top.clients[i]);
+                    dnsClientQueries[i] = top.clients[i].count;
+                } else {
+                    dnsClientNames[i][0] = '\0';
+                }
+            }
+            dnsListedMs = now;
+            dnsListedTotal = st.total;
+        }
+    }
+    if (listed) {
+        for (int i = 0; i < dnsClientCount; i++) {
+            metricSet(M_DNS_CLIENT_QUERIES + i, dnsClientQueries[i], SRC_PIHOLE);
+        }
+    } else {
+        metricMarkStale(M_DNS_CLIENT_QUERIES, METRIC_DNS_CLIENTS);
+    }
+    metricsPublish();
+    markLive(LIVE_PIHOLE);
+}
+
+// Compile the custom screen's expressions (once, at boot)
+static void compileCustom(Expr& e, const char* src) {
+    const char* error;
+    int column;
+    if (!exprCompile(e, src, &error, &column)) {
+        Serial.printf("Custom: %s at column %d in \"%s\"\n", error, column, src);
     }
 }
 
+void setupCustom() {
+    compileCustom(customMain, CUSTOM_MAIN_EXPR);
+    compileCustom(customSub, CUSTOM_SUB_EXPR);
+}
+
+// No source of its own: re-evaluates whichever expressions have
+// an input with a new sample since last time
 void fetchCustom() {
-    // Network stats are pulled from M900 fetch
-    // Nothing extra needed here
+    TRACE_SCOPE("fetch custom");
+    readMetrics();
+    uint32_t changed[EXPR_DEP_WORDS];
+    exprChangedInputs(cur, customSeen, changed);
+    exprUpdate(customMain, cur, changed, curMs);
+    exprUpdate(customSub, cur, changed, curMs);
+    if (customMain.evaluated && !customMain.stale) markLive(LIVE_CUSTOM);
+}
+
+// ============================================
+// Consolidated JSON document (served by statsserver.cpp)
+// Each source keeps the shape of its own /stats reply under
+// "data", so consumers can use it in place of polling directly.
+// ============================================
+static const char* piKeys[4] = {"flight-radar", "uptime-kuma", "spare-1", "spare-2"};
+
+struct JsonOut {
+    char*  buf;
+    size_t cap;
+    size_t len;
+    bool   overflow;
+};
+
+static void out(JsonOut& o, const char* fmt, ...) {
+    if (o.overflow) return;
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(o.buf + o.len, o.cap - o.len, fmt, args);
+    va_end(args);
+    if (n < 0 || (size_t)n >= o.cap - o.len) {
+        o.overflow = true;
+        return;
+    }
+    o.len += n;
+}
+
+// Strings that came from the network: drop anything that would
+// need escaping rather than escape it
+static void outStr(JsonOut& o, const char* s) {
+    out(o, "\"");
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\' || (uint8_t)*s < 0x20) continue;
+        out(o, "%c", *s);
+    }
+    out(o, "\"");
+}
+
+static void outSource(JsonOut& o, const char* name, LiveSource src, bool isStale) {
+    out(o, "\"%s\":{\"updated_ms\":%lu,\"ts\":%ld,\"stale\":%s,\"data\":",
+        name, liveAtMs[src], (long)liveAtEpoch[src], isStale ? "true" : "false");
+}
+
+size_t formatStatsJson(char* buf, size_t cap) {
+    JsonOut o = {buf, cap, 0, false};
+    readMetrics();
+    out(o, "{");
+
+    // Unraid
+    outSource(o, "unraid", LIVE_UNRAID, stale(M_UNRAID_CPU));
+    out(o, "{\"drives\":[");
+    int driveCount = constrain((int)metric(M_UNRAID_DRIVE_COUNT), 0, METRIC_DRIVES);
+    for (int i = 0; i < driveCount; i++) {
+        out(o, "%s{\"device\":", i ? "," : "");
+        outStr(o, unraidDriveNames[i]);
+        out(o, ",\"temp_c\":%.1f}", metric(M_UNRAID_DRIVE_TEMP + i));
+    }
+    out(o, "],\"storage\":{\"used_gb\":%.0f,\"total_gb\":%.0f},",
+        metric(M_UNRAID_STORAGE_USED_TB) * 1024, metric(M_UNRAID_STORAGE_TOTAL_TB) * 1024);
+    out(o, "\"system\":{\"cpu_percent\":%.1f,\"mem_percent\":%.1f},",
+        metric(M_UNRAID_CPU), metric(M_UNRAID_MEM));
+    out(o, "\"docker\":{\"running\":%d,\"total\":%d},\"array_status\":",
+        (int)metric(M_UNRAID_DOCKER_RUNNING), (int)metric(M_UNRAID_DOCKER_TOTAL));
+    outStr(o, unraidArrayStatus);
+    out(o, "}},");
+
+    // M900
+    outSource(o, "m900", LIVE_M900, stale(M_M900_CPU));
+    out(o, "{\"cpu\":{\"percent\":%.1f,\"temp_c\":%.1f},",
+        metric(M_M900_CPU), metric(M_M900_CPU_TEMP));
+    out(o, "\"memory\":{\"percent\":%.1f,\"used_gb\":%.1f,\"total_gb\":%.1f},",
+        metric(M_M900_MEM), metric(M_M900_MEM_USED_GB), metric(M_M900_MEM_TOTAL_GB));
+    out(o, "\"disk\":{\"percent\":%.1f,\"used_gb\":%.1f,\"total_gb\":%.1f},",
+        metric(M_M900_DISK), metric(M_M900_DISK_USED_GB), metric(M_M900_DISK_TOTAL_GB));
+    out(o, "\"network\":{\"bytes_sent\":%.0f,\"bytes_recv\":%.0f,"
+           "\"up_mbps\":%.2f,\"down_mbps\":%.2f}}},",
+        cur.value[M_M900_NET_SENT], cur.value[M_M900_NET_RECV],
+        metric(M_M900_NET_UP_MBPS), metric(M_M900_NET_DOWN_MBPS));
+
+    // Pis (null data = no fresh reading)
+    bool pisStale = true;
+    for (int i = 0; i < METRIC_PIS; i++) {
+        if (!stale(M_PI_TEMP + i)) pisStale = false;
+    }
+    outSource(o, "pis", LIVE_PIS, pisStale);
+    out(o, "{");
+    for (int i = 0; i < METRIC_PIS; i++) {
+        out(o, "%s\"%s\":", i ? "," : "", piKeys[i]);
+        if (!stale(M_PI_TEMP + i)) {
+            out(o, "{\"cpu\":{\"temp_c\":%.1f,\"percent\":%.1f},\"memory\":{\"percent\":%.1f}}",
+                metric(M_PI_TEMP + i), metric(M_PI_CPU + i), metric(M_PI_MEM + i));
+        } else {
+            out(o, "null");
+        }
+    }
+    out(o, "}},");
+
+    // Services
+    outSource(o, "services", LIVE_SERVICES, stale(M_SERVICE_UP));
+    out(o, "[");
+    for (int i = 0; i < NUM_SERVICES; i++) {
+        out(o, "%s{\"name\":\"%s\",\"monitor\":", i ? "," : "", services[i].name);
+        outStr(o, services[i].kuma);
+        out(o, ",\"up\":%s", metric(M_SERVICE_UP + i) > 0 ? "true" : "false");
+        if (!stale(M_SERVICE_MS + i)) out(o, ",\"ms\":%.0f", metric(M_SERVICE_MS + i));
+        out(o, "}");
+    }
+    out(o, "]},");
+
+    // Switches, per-port rates (null = no fresh rate for that port)
+    bool switchesStale = true;
+    for (int i = 0; i < METRIC_SWITCHES * METRIC_SWITCH_PORTS; i++) {
+        if (!stale(M_SWITCH_IN_MBPS + i)) switchesStale = false;
+    }
+    outSource(o, "switches", LIVE_SWITCHES, switchesStale);
+    out(o, "[");
+    for (int s = 0; s < METRIC_SWITCHES; s++) {
+        out(o, "%s{\"host\":\"%s\",\"ports\":[", s ? "," : "", switchHosts[s]);
+        for (int p = 0; p < METRIC_SWITCH_PORTS; p++) {
+            int i = s * METRIC_SWITCH_PORTS + p;
+            if (!stale(M_SWITCH_IN_MBPS + i)) {
+                out(o, "%s{\"in_mbps\":%.2f,\"out_mbps\":%.2f}", p ? "," : "",
+                    metric(M_SWITCH_IN_MBPS + i), metric(M_SWITCH_OUT_MBPS + i));
+            } else {
+                out(o, "%snull", p ? "," : "");
+            }
+        }
+        out(o, "]}");
+    }
+    out(o, "]},");
+
+    // Pi-hole, summary fields as FTL names them plus the rates
+    outSource(o, "pihole", LIVE_PIHOLE, stale(M_DNS_QUERIES));
+    out(o, "{\"queries\":{\"total\":%.0f,\"blocked\":%.0f,\"forwarded\":%.0f,\"cached\":%.0f,"
+           "\"per_second\":%.2f,\"percent_blocked\":%.1f},\"clients\":{\"active\":%d},\"top_clients\":[",
+        cur.value[M_DNS_QUERIES], cur.value[M_DNS_BLOCKED], cur.value[M_DNS_FORWARDED],
+        cur.value[M_DNS_CACHED], metric(M_DNS_QPS), metric(M_DNS_BLOCK_PCT), (int)metric(M_DNS_CLIENTS));
+    for (int i = 0; i < METRIC_DNS_CLIENTS && dnsClientNames[i][0]; i++) {
+        out(o, "%s{\"name\":", i ? "," : "");
+        outStr(o, dnsClientNames[i]);
+        out(o, ",\"count\":%.0f}", cur.value[M_DNS_CLIENT_QUERIES + i]);
+    }
+    out(o, "]}}}");
+
+    return o.overflow ? 0 : o.len;
+}
+
+// ============================================
+// Warm-start state
+// Flat copy of the metric store plus the text that goes with it,
+// saved to flash by snapshot.cpp and restored (stale) on the
+// next boot
+// ============================================
+struct WarmState {
+    double  value[M_COUNT];
+    uint8_t sampled[M_COUNT];       // 0 = never had a value
+    char    unraidDriveNames[METRIC_DRIVES][8];
+    char    unraidArrayStatus[12];
+    char    dnsClientNames[METRIC_DNS_CLIENTS][12];
+    uint8_t svcTop;                 // services frame's scroll when saved
+    uint8_t svcFirst;
+};
+static_assert(NUM_SERVICES <= 255, "svcFirst is saved as a byte");
+
+size_t saveScreenState(uint8_t* buf, size_t cap) {
+    if (cap < sizeof(WarmState)) return 0;
+
+    WarmState st = {};
+    readMetrics();
+    for (int id = 0; id < M_COUNT; id++) {
+        st.value[id] = cur.value[id];
+        st.sampled[id] = (cur.state[id] != MS_EMPTY);
+    }
+    memcpy(st.unraidDriveNames, unraidDriveNames, sizeof(st.unraidDriveNames));
+    strlcpy(st.unraidArrayStatus, unraidArrayStatus, sizeof(st.unraidArrayStatus));
+    memcpy(st.dnsClientNames, dnsClientNames, sizeof(st.dnsClientNames));
+    st.svcTop = svcTop;
+    st.svcFirst = svcFirst;
+
+    memcpy(buf, &st, sizeof(st));
+    return sizeof(st);
+}
+
+bool loadScreenState(const uint8_t* buf, size_t len) {
+    if (len != sizeof(WarmState)) return false;
+
+    WarmState st;
+    memcpy(&st, buf, sizeof(st));
+
+    for (int id = 0; id < M_COUNT; id++) {
+        if (st.sampled[id]) metricRestore(id, st.value[id]);
+    }
+    metricsPublish();
+
+    memcpy(unraidDriveNames, st.unraidDriveNames, sizeof(unraidDriveNames));
+    for (int i = 0; i < METRIC_DRIVES; i++) unraidDriveNames[i][7] = '\0';
+    st.unraidArrayStatus[sizeof(st.unraidArrayStatus) - 1] = '\0';
+    strlcpy(unraidArrayStatus, st.unraidArrayStatus, sizeof(unraidArrayStatus));
+    memcpy(dnsClientNames, st.dnsClientNames, sizeof(dnsClientNames));
+    for (int i = 0; i < METRIC_DNS_CLIENTS; i++) dnsClientNames[i][11] = '\0';
+
+    // The saved services frame is in GRAM order; markStaleFrame()
+    // puts it back in display order
+    svcTop = st.svcTop < SVC_ROWS ? st.svcTop : 0;
+    svcFirst = st.svcFirst < NUM_SERVICES ? st.svcFirst : 0;
+    return true;
+}
+
+bool screensLive() {
+    return liveSinceBoot;
+}
+
+// Thin grey ring around the edge = frame restored from flash. A
+// services frame saved mid-scroll has its rows rotated first, so it
+// shows right with the window back at slot 0
+void markStaleFrame(int idx) {
+    if (idx == SCREEN_SERVICES && svcTop != 0) {
+        const int rowBytes = DISPLAY_WIDTH * FRAME_DEPTH / 8;
+        uint8_t* list = (uint8_t*)frames[idx]->getBuffer() + SVC_TOP * rowBytes;
+        std::rotate(list, list + svcTop * SVC_ROW_H * rowBytes, list + SVC_ROWS * SVC_ROW_H * rowBytes);
+        svcTop = 0;
+    }
+    frames[idx]->drawCircle(120, 120, 119, PAL_DARKGREY);
 }
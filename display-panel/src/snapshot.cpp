@@ -0,0 +1,309 @@
+#include "snapshot.h"
+#include "config.h"
+#include "displays.h"
+#include "pipeline.h"
+#include "screens.h"
+#include <Arduino.h>
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+
+// ============================================
+// Flash layout
+// ============================================
+#define SNAPSHOT_MAGIC      0x4D524157    // "WARM"
+#define SNAPSHOT_VERSION    8
+#define SNAPSHOT_SUBTYPE    0x40          // see partitions.csv
+#define SLOT_SIZE           0x20000       // 128 KB per slot
+#define SECTOR_SIZE         0x1000
+#define STATE_MAX           1024
+
+struct SnapshotHeader {
+    uint32_t magic;
+    uint32_t seq;                       // newest valid slot wins
+    uint32_t version;
+    uint32_t frameBytes;                // uncompressed framebuffer size
+    uint32_t stateLen;
+    uint32_t frameLen[NUM_DISPLAYS];    // compressed bytes, 0 = not saved
+    uint32_t payloadCrc;                // over everything after the header
+    uint32_t headerCrc;                 // over the fields above
+};
+
+static const esp_partition_t* part = nullptr;
+static int      slotCount  = 0;
+static int      newestSlot = -1;
+static uint32_t newestSeq  = 0;
+
+static bool openPartition() {
+    if (part) return true;
+    part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                    (esp_partition_subtype_t)SNAPSHOT_SUBTYPE,
+                                    "snapshot");
+    if (!part) {
+        Serial.println("Snapshot: no partition");
+        return false;
+    }
+    slotCount = part->size / SLOT_SIZE;
+    return slotCount > 0;
+}
+
+static uint32_t headerCrc(const SnapshotHeader& h) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&h, offsetof(SnapshotHeader, headerCrc));
+}
+
+// ============================================
+// Slot writer
+// Streams bytes into a slot through a page buffer, erasing each
+// sector just before the first write into it
+// ============================================
+struct SlotWriter {
+    uint32_t base;          // slot offset in the partition
+    uint32_t pos;           // bytes written, relative to base
+    uint32_t erasedTo;      // sectors erased up to here
+    uint32_t crc;
+    uint32_t pageStart;
+    uint16_t fill;
+    bool     ok;
+    uint8_t  page[256];
+};
+
+static SlotWriter w;
+
+static void writerFlushPage() {
+    if (w.fill == 0 || !w.ok) return;
+    uint32_t end = w.pageStart + w.fill;
+    while (w.erasedTo < end) {
+        if (esp_partition_erase_range(part, w.base + w.erasedTo, SECTOR_SIZE) != ESP_OK) {
+            w.ok = false;
+            return;
+        }
+        w.erasedTo += SECTOR_SIZE;
+    }
+    if (esp_partition_write(part, w.base + w.pageStart, w.page, w.fill) != ESP_OK) {
+        w.ok = false;
+    }
+    w.pageStart = end;
+    w.fill = 0;
+}
+
+static bool writerPut(const void* data, size_t len) {
+    if (w.pos + len > SLOT_SIZE) return false;
+    const uint8_t* p = (const uint8_t*)data;
+    w.crc = esp_rom_crc32_le(w.crc, p, len);
+    w.pos += len;
+    while (len > 0) {
+        size_t n = min(len, sizeof(w.page) - w.fill);
+        memcpy(w.page + w.fill, p, n);
+        w.fill += n;
+        p += n;
+        len -= n;
+        if (w.fill == sizeof(w.page)) writerFlushPage();
+    }
+    return w.ok;
+}
+
+// Drop everything written after pos (nothing past it is referenced)
+static void writerRewind(uint32_t pos, uint32_t crc) {
+    w.pos = pos;
+    w.crc = crc;
+    if (pos >= w.pageStart) {
+        w.fill = pos - w.pageStart;
+    } else {
+        w.pageStart = pos;
+        w.fill = 0;
+    }
+}
+
+// ============================================
+// PackBits-style RLE over 16-bit units
+// n < 128:  n+1 literal units follow
+// n >= 128: next unit repeats n-126 times
+// Mostly-black frames shrink 10-20x
+// ============================================
+static bool rleCompress(const uint16_t* src, size_t n) {
+    size_t i = 0;
+    while (i < n) {
+        size_t run = 1;
+        while (i + run < n && run < 129 && src[i + run] == src[i]) run++;
+
+        if (run >= 2) {
+            uint8_t tag = run + 126;
+            if (!writerPut(&tag, 1) || !writerPut(&src[i], 2)) return false;
+            i += run;
+            continue;
+        }
+
+        size_t start = i;
+        while (i < n && i - start < 128) {
+            if (i + 1 < n && src[i] == src[i + 1]) break;
+            i++;
+        }
+        uint8_t tag = i - start - 1;
+        if (!writerPut(&tag, 1) || !writerPut(&src[start], (i - start) * 2)) return false;
+    }
+    return true;
+}
+
+static bool rleExpand(const uint8_t* src, size_t len, uint16_t* dst, size_t n) {
+    const uint8_t* end = src + len;
+    size_t o = 0;
+    while (src < end) {
+        uint8_t tag = *src++;
+        if (tag >= 128) {
+            size_t run = tag - 126;
+            if (src + 2 > end || o + run > n) return false;
+            uint16_t v;
+            memcpy(&v, src, 2);
+            src += 2;
+            while (run--) dst[o++] = v;
+        } else {
+            size_t cnt = tag + 1;
+            if (src + cnt * 2 > end || o + cnt > n) return false;
+            memcpy(dst + o, src, cnt * 2);
+            src += cnt * 2;
+            o += cnt;
+        }
+    }
+    return o == n;
+}
+
+// ============================================
+// Find the newest valid slot
+// ============================================
+static void scanSlots() {
+    newestSlot = -1;
+    newestSeq = 0;
+    for (int s = 0; s < slotCount; s++) {
+        SnapshotHeader h;
+        if (esp_partition_read(part, s * SLOT_SIZE, &h, sizeof(h)) != ESP_OK) continue;
+        if (h.magic != SNAPSHOT_MAGIC || h.version != SNAPSHOT_VERSION) continue;
+        if (h.headerCrc != headerCrc(h)) continue;
+        if (newestSlot < 0 || (int32_t)(h.seq - newestSeq) > 0) {
+            newestSlot = s;
+            newestSeq = h.seq;
+        }
+    }
+}
+
+// ============================================
+// Restore
+// ============================================
+int restoreSnapshot() {
+    if (!openPartition()) return -1;
+    scanSlots();
+    if (newestSlot < 0) return -1;
+
+    const void* map = nullptr;
+    spi_flash_mmap_handle_t handle;
+    if (esp_partition_mmap(part, newestSlot * SLOT_SIZE, SLOT_SIZE,
+                           SPI_FLASH_MMAP_DATA, &map, &handle) != ESP_OK) {
+        return -1;
+    }
+
+    const SnapshotHeader* h = (const SnapshotHeader*)map;
+    const uint8_t* payload = (const uint8_t*)map + sizeof(SnapshotHeader);
+
+    size_t payloadLen = h->stateLen;
+    for (int i = 0; i < NUM_DISPLAYS; i++) payloadLen += h->frameLen[i];
+
+    int painted = -1;
+    if (sizeof(SnapshotHeader) + payloadLen <= SLOT_SIZE &&
+        esp_rom_crc32_le(0, payload, payloadLen) == h->payloadCrc &&
+        loadScreenState(payload, h->stateLen)) {
+
+        painted = 0;
+        const uint8_t* p = payload + h->stateLen;
+        for (int i = 0; i < NUM_DISPLAYS; i++) {
+            size_t len = h->frameLen[i];
+            if (len > 0 && h->frameBytes == frames[i]->bufferLength()) {
+                size_t units = frames[i]->bufferLength() / 2;
+                beginFrame(i);
+                if (rleExpand(p, len, (uint16_t*)frames[i]->getBuffer(), units)) {
+                    markStaleFrame(i);
+                    painted |= (1 << i);
+                } else {
+                    frames[i]->fillScreen(PAL_BLACK);
+                }
+                if (i == SCREEN_SERVICES) scrollFrame(i, servicesScroll());
+                submitFrame(i);
+            }
+            p += len;
+        }
+        Serial.printf("Snapshot: restored seq %lu (slot %d)\n",
+                      (unsigned long)h->seq, newestSlot);
+    }
+
+    spi_flash_munmap(handle);
+    return painted;
+}
+
+// ============================================
+// Save
+// ============================================
+void saveSnapshot() {
+    if (!openPartition()) return;
+
+    // Don't overwrite a good snapshot with values that are
+    // themselves only restored from it
+    if (!screensLive()) return;
+
+    static uint8_t state[STATE_MAX];
+    size_t stateLen = saveScreenState(state, sizeof(state));
+    if (stateLen == 0) return;
+
+    int slot = (newestSlot + 1) % slotCount;
+    uint32_t t0 = millis();
+
+    w.base = slot * SLOT_SIZE;
+    w.pos = sizeof(SnapshotHeader);
+    w.pageStart = w.pos;
+    w.erasedTo = 0;
+    w.fill = 0;
+    w.crc = 0;
+    w.ok = true;
+
+    SnapshotHeader h = {};
+    h.magic = SNAPSHOT_MAGIC;
+    h.seq = newestSeq + 1;
+    h.version = SNAPSHOT_VERSION;
+    h.stateLen = stateLen;
+
+    writerPut(state, stateLen);
+
+#if SNAPSHOT_FRAMES
+    h.frameBytes = frames[0]->bufferLength();
+    for (int i = 0; i < NUM_DISPLAYS && w.ok; i++) {
+        // The clock would come back showing the wrong time
+        if (i == SCREEN_CLOCK) continue;
+
+        uint32_t start = w.pos, crc = w.crc;
+        const uint16_t* buf = (const uint16_t*)frames[i]->getBuffer();
+        if (rleCompress(buf, frames[i]->bufferLength() / 2)) {
+            h.frameLen[i] = w.pos - start;
+        } else {
+            // Slot full: keep what fits, skip the remaining frames
+            writerRewind(start, crc);
+            break;
+        }
+    }
+#endif
+
+    writerFlushPage();
+    if (!w.ok) {
+        Serial.println("Snapshot: flash write failed");
+        return;
+    }
+
+    // Header last: until it lands, the previous slot stays newest
+    h.payloadCrc = w.crc;
+    h.headerCrc = headerCrc(h);
+    if (esp_partition_write(part, w.base, &h, sizeof(h)) != ESP_OK) {
+        Serial.println("Snapshot: header write failed");
+        return;
+    }
+
+    newestSlot = slot;
+    newestSeq = h.seq;
+    Serial.printf("Snapshot: saved seq %lu, %lu bytes in %lums\n",
+                  (unsigned long)h.seq, (unsigned long)w.pos,
+                  (unsigned long)(millis() - t0));
+}
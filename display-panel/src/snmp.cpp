@@ -0,0 +1,219 @@
+#include "snmp.h"
+#include <string.h>
+
+// BER tags
+#define TAG_SEQUENCE    0x30
+#define TAG_GET_BULK    0xA5
+#define TAG_RESPONSE    0xA2
+
+#define SNMP_VERSION_2C 1
+
+// ============================================
+// Encoder
+// Writes backwards from the end of the buffer, so each length is
+// known before its header goes in front of it; the finished
+// message is moved to the start
+// ============================================
+struct BerOut {
+    uint8_t* buf;
+    size_t   pos;       // first written byte
+    bool     ok;
+};
+
+static void prepend(BerOut& o, const void* data, size_t n) {
+    if (!o.ok || n > o.pos) {
+        o.ok = false;
+        return;
+    }
+    o.pos -= n;
+    memcpy(o.buf + o.pos, data, n);
+}
+
+static void prependByte(BerOut& o, uint8_t b) {
+    prepend(o, &b, 1);
+}
+
+// Tag and definite length in front of the last len bytes written
+static void prependHeader(BerOut& o, uint8_t tag, size_t len) {
+    if (len < 0x80) {
+        prependByte(o, (uint8_t)len);
+    } else {
+        int n = 0;
+        for (size_t v = len; v; v >>= 8, n++) prependByte(o, (uint8_t)v);
+        prependByte(o, 0x80 | n);
+    }
+    prependByte(o, tag);
+}
+
+static void prependInt(BerOut& o, int32_t v) {
+    size_t end = o.pos;
+    // Minimal two's complement: stop once the rest is sign extension
+    for (;;) {
+        prependByte(o, (uint8_t)v);
+        int32_t rest = v >> 8;
+        bool sign = (v & 0x80) != 0;
+        if ((rest == 0 && !sign) || (rest == -1 && sign)) break;
+        v = rest;
+    }
+    prependHeader(o, SNMP_INTEGER, end - o.pos);
+}
+
+static void prependOid(BerOut& o, const SnmpOid& oid) {
+    size_t end = o.pos;
+    for (int i = oid.len - 1; i >= 2; i--) {
+        uint32_t arc = oid.arcs[i];
+        prependByte(o, arc & 0x7F);
+        for (arc >>= 7; arc; arc >>= 7) prependByte(o, 0x80 | (arc & 0x7F));
+    }
+    prependByte(o, (uint8_t)(oid.arcs[0] * 40 + oid.arcs[1]));
+    prependHeader(o, SNMP_OID, end - o.pos);
+}
+
+size_t snmpGetBulk(uint8_t* buf, size_t cap, const char* community, int32_t requestId,
+                   uint8_t maxRepetitions, const SnmpOid* oids, int count) {
+    BerOut o = {buf, cap, true};
+
+    // Varbind list: {name, NULL} per column
+    size_t listEnd = o.pos;
+    for (int i = count - 1; i >= 0; i--) {
+        if (oids[i].len < 2 || oids[i].len > SNMP_MAX_ARCS) return 0;
+        size_t vbEnd = o.pos;
+        prependHeader(o, SNMP_NULL, 0);
+        prependOid(o, oids[i]);
+        prependHeader(o, TAG_SEQUENCE, vbEnd - o.pos);
+    }
+    prependHeader(o, TAG_SEQUENCE, listEnd - o.pos);
+
+    // PDU: request-id, non-repeaters, max-repetitions
+    prependInt(o, maxRepetitions);
+    prependInt(o, 0);
+    prependInt(o, requestId);
+    prependHeader(o, TAG_GET_BULK, cap - o.pos);
+
+    size_t n = strlen(community);
+    prepend(o, community, n);
+    prependHeader(o, SNMP_OCTET_STRING, n);
+    prependInt(o, SNMP_VERSION_2C);
+    prependHeader(o, TAG_SEQUENCE, cap - o.pos);
+
+    if (!o.ok) return 0;
+    size_t len = cap - o.pos;
+    memmove(buf, buf + o.pos, len);
+    return len;
+}
+
+// ============================================
+// Decoder
+// A reader is just a window onto the packet; descending into a
+// TLV narrows it to the content octets
+// ============================================
+struct BerIn {
+    const uint8_t* p;
+    const uint8_t* end;
+};
+
+static bool next(BerIn& in, uint8_t* tag, BerIn* content) {
+    if (in.end - in.p < 2) return false;
+    *tag = *in.p++;
+    size_t len = *in.p++;
+    if (len & 0x80) {
+        int n = len & 0x7F;
+        if (n == 0 || n > 2 || in.end - in.p < n) return false;   // no indefinite form
+        len = 0;
+        while (n--) len = (len << 8) | *in.p++;
+    }
+    if ((size_t)(in.end - in.p) < len) return false;
+    content->p = in.p;
+    content->end = in.p + len;
+    in.p += len;
+    return true;
+}
+
+static bool expect(BerIn& in, uint8_t tag, BerIn* content) {
+    uint8_t t;
+    return next(in, &t, content) && t == tag;
+}
+
+static bool readInt(BerIn& in, int32_t* v) {
+    BerIn c;
+    if (!expect(in, SNMP_INTEGER, &c) || c.p == c.end || c.end - c.p > 4) return false;
+    int32_t x = (int8_t)*c.p++;         // sign from the first octet
+    while (c.p < c.end) x = (x << 8) | *c.p++;
+    *v = x;
+    return true;
+}
+
+int snmpParseResponse(const uint8_t* pkt, size_t len, int32_t requestId,
+                      SnmpVarbindFn fn, void* ctx) {
+    BerIn in = {pkt, pkt + len};
+    BerIn msg, community, pdu, list;
+    int32_t version, id, status, index;
+
+    if (!expect(in, TAG_SEQUENCE, &msg)) return -1;
+    if (!readInt(msg, &version) || version != SNMP_VERSION_2C) return -1;
+    if (!expect(msg, SNMP_OCTET_STRING, &community)) return -1;
+    if (!expect(msg, TAG_RESPONSE, &pdu)) return -1;
+    if (!readInt(pdu, &id) || id != requestId) return -1;
+    if (!readInt(pdu, &status) || status != 0) return -1;
+    if (!readInt(pdu, &index)) return -1;
+    if (!expect(pdu, TAG_SEQUENCE, &list)) return -1;
+
+    int count = 0;
+    while (list.p < list.end) {
+        BerIn vb, name, value;
+        uint8_t type;
+        if (!expect(list, TAG_SEQUENCE, &vb)) return -1;
+        if (!expect(vb, SNMP_OID, &name) || !next(vb, &type, &value)) return -1;
+
+        SnmpVarbind v = {name.p, (uint16_t)(name.end - name.p), type,
+                         value.p, (uint16_t)(value.end - value.p)};
+        fn(ctx, v);
+        count++;
+    }
+    return count;
+}
+
+// ============================================
+// Varbind helpers
+// ============================================
+bool snmpColumnIndex(const SnmpVarbind& vb, const SnmpOid& column, uint32_t* index) {
+    const uint8_t* p = vb.oid;
+    const uint8_t* end = vb.oid + vb.oidLen;
+
+    // Decode and compare arc by arc; the first octet holds two
+    if (column.len < 2 || p == end || *p != column.arcs[0] * 40 + column.arcs[1]) return false;
+    p++;
+
+    for (int i = 2; i <= column.len; i++) {
+        uint32_t arc = 0;
+        do {
+            if (p == end || arc >> 25) return false;
+            arc = (arc << 7) | (*p & 0x7F);
+        } while (*p++ & 0x80);
+
+        if (i == column.len) {
+            *index = arc;
+            return p == end;
+        }
+        if (arc != column.arcs[i]) return false;
+    }
+    return false;
+}
+
+bool snmpUnsigned(const SnmpVarbind& vb, uint64_t* value) {
+    switch (vb.type) {
+    case SNMP_COUNTER32: case SNMP_GAUGE32: case SNMP_TIMETICKS:
+    case SNMP_COUNTER64: case SNMP_INTEGER:
+        break;
+    default:
+        return false;
+    }
+    if (vb.valueLen == 0 || vb.valueLen > 9) return false;
+    if (vb.value[0] & 0x80) return false;                   // negative
+    if (vb.valueLen == 9 && vb.value[0] != 0) return false; // over 64 bits
+
+    uint64_t v = 0;
+    for (int i = 0; i < vb.valueLen; i++) v = (v << 8) | vb.value[i];
+    *value = v;
+    return true;
+}
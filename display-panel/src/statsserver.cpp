@@ -0,0 +1,125 @@
+#include "statsserver.h"
+#include "config.h"
+#include "screens.h"
+#include "seqlock.h"
+#include "trace.h"
+#include <Arduino.h>
+#include <esp_http_server.h>
+#include <esp_rom_crc.h>
+
+// ============================================
+// Published document
+// ============================================
+struct StatsDoc {
+    uint32_t etag;              // CRC32 of body
+    uint32_t len;               // 0 = nothing published yet
+    char     body[STATS_DOC_MAX];
+};
+
+static Seqlock<StatsDoc> published;
+static StatsDoc staging;        // loop task only
+static StatsDoc serving;        // server task only
+
+static httpd_handle_t server = nullptr;
+
+void publishStats() {
+    size_t len = formatStatsJson(staging.body, sizeof(staging.body));
+    if (len == 0) {
+        Serial.println("Stats: document larger than STATS_DOC_MAX, not published");
+        return;
+    }
+
+    uint32_t etag = esp_rom_crc32_le(0, (const uint8_t*)staging.body, len);
+    if (staging.len == len && staging.etag == etag) return;     // unchanged
+
+    staging.len = len;
+    staging.etag = etag;
+    published.write(staging);
+}
+
+// ============================================
+// GET /stats
+// ============================================
+static esp_err_t handleStats(httpd_req_t* req) {
+    published.read(serving);
+    if (serving.len == 0) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        return httpd_resp_send(req, nullptr, 0);
+    }
+
+    char etag[12];
+    snprintf(etag, sizeof(etag), "\"%08lx\"", (unsigned long)serving.etag);
+    char uptime[12];
+    snprintf(uptime, sizeof(uptime), "%lu", millis());
+
+    httpd_resp_set_hdr(req, "ETag", etag);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    httpd_resp_set_hdr(req, "X-Uptime-Ms", uptime);
+
+    // A truncated header (long list of tags) just gets the full body
+    char match[16];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", match, sizeof(match)) == ESP_OK &&
+        strcmp(match, etag) == 0) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, nullptr, 0);
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, serving.body, serving.len);
+}
+
+// ============================================
+// GET /trace (tracing builds only)
+// Chunked, so the dump never needs a buffer of its own
+// ============================================
+#if TRACE_ENABLED
+static void writeChunk(void* ctx, const char* data, size_t len) {
+    httpd_resp_send_chunk((httpd_req_t*)ctx, data, len);
+}
+
+static esp_err_t handleTrace(httpd_req_t* req) {
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    traceDump(writeChunk, req);
+    return httpd_resp_send_chunk(req, nullptr, 0);
+}
+#endif
+
+// ============================================
+// Server task
+// ============================================
+void startStatsServer() {
+    if (server) return;
+    httpd_config_t cfg = HTTPD_DEFAULT_CONFIG();
+    cfg.server_port       = STATS_HTTP_PORT;
+    cfg.max_open_sockets  = STATS_HTTP_MAX_CONN;
+    cfg.lru_purge_enable  = true;       // new client evicts the oldest idle one
+    cfg.max_uri_handlers  = 2;
+    cfg.recv_wait_timeout = 2;          // seconds
+    cfg.send_wait_timeout = 2;
+    cfg.stack_size        = 4096;
+    cfg.core_id           = 0;
+    cfg.task_priority     = 1;          // below the flush task
+
+    if (httpd_start(&server, &cfg) != ESP_OK) {
+        Serial.println("Stats: server failed to start");
+        server = nullptr;
+        return;
+    }
+
+    httpd_uri_t stats = {};
+    stats.uri = "/stats";
+    stats.method = HTTP_GET;
+    stats.handler = handleStats;
+    httpd_register_uri_handler(server, &stats);
+
+#if TRACE_ENABLED
+    httpd_uri_t trace = {};
+    trace.uri = "/trace";
+    trace.method = HTTP_GET;
+    trace.handler = handleTrace;
+    httpd_register_uri_handler(server, &trace);
+#endif
+
+    Serial.printf("Stats: serving /stats on port %d\n", STATS_HTTP_PORT);
+}
@@ -0,0 +1,118 @@
+#include "trace.h"
+
+#if TRACE_ENABLED
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+static_assert((TRACE_EVENTS & (TRACE_EVENTS - 1)) == 0, "TRACE_EVENTS must be a power of two");
+
+// ============================================
+// Ring
+// Writers on either core claim a slot with one atomic add, fill
+// it, then stamp it with its sequence number. The reader only
+// trusts a slot whose stamp matches before and after copying it.
+// ============================================
+struct TraceEvent {
+    std::atomic<uint32_t> seq;      // claim index + 1; 0 while being written
+    uint32_t    ts;                 // micros()
+    const char* name;
+    int16_t     arg;
+    char        phase;
+    uint8_t     core;
+};
+
+static TraceEvent ring[TRACE_EVENTS];
+static std::atomic<uint32_t> claimed{0};
+
+void traceEvent(const char* name, char phase, int arg) {
+    uint32_t ts = micros();
+    uint32_t i = claimed.fetch_add(1, std::memory_order_relaxed);
+    TraceEvent& e = ring[i & (TRACE_EVENTS - 1)];
+
+    e.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    e.ts = ts;
+    e.name = name;
+    e.arg = (int16_t)arg;
+    e.phase = phase;
+    e.core = (uint8_t)xPortGetCoreID();
+    e.seq.store(i + 1, std::memory_order_release);
+}
+
+// ============================================
+// Chrome trace JSON
+// One "thread" per core. Ends whose begin was already overwritten
+// are dropped so the viewer doesn't mis-nest the first spans.
+// ============================================
+struct DumpBuf {
+    TraceWriter out;
+    void*       ctx;
+    char        buf[512];
+    size_t      len;
+};
+
+static void emit(DumpBuf& d, const char* fmt, ...) {
+    char line[128];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (n <= 0) return;
+    if ((size_t)n >= sizeof(line)) n = sizeof(line) - 1;
+
+    if (d.len + n > sizeof(d.buf)) {
+        d.out(d.ctx, d.buf, d.len);
+        d.len = 0;
+    }
+    memcpy(d.buf + d.len, line, n);
+    d.len += n;
+}
+
+void traceDump(TraceWriter out, void* ctx) {
+    DumpBuf d;
+    d.out = out;
+    d.ctx = ctx;
+    d.len = 0;
+
+    emit(d, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    emit(d, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"core 0 (flush)\"}},\n");
+    emit(d, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"core 1 (loop)\"}}");
+
+    uint32_t end = claimed.load(std::memory_order_acquire);
+    uint32_t start = (end > TRACE_EVENTS) ? end - TRACE_EVENTS : 0;
+    int depth[2] = {0, 0};
+
+    for (uint32_t i = start; i < end; i++) {
+        const TraceEvent& e = ring[i & (TRACE_EVENTS - 1)];
+        if (e.seq.load(std::memory_order_acquire) != i + 1) continue;
+        uint32_t ts = e.ts;
+        const char* name = e.name;
+        int arg = e.arg;
+        char phase = e.phase;
+        uint8_t core = e.core & 1;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e.seq.load(std::memory_order_relaxed) != i + 1) continue;   // overwritten meanwhile
+
+        if (phase == 'B') {
+            depth[core]++;
+        } else if (phase == 'E') {
+            if (depth[core] == 0) continue;
+            depth[core]--;
+        }
+
+        emit(d, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lu,\"pid\":1,\"tid\":%u",
+             name, phase, (unsigned long)ts, core);
+        if (phase == 'i') emit(d, ",\"s\":\"t\"");
+        if (arg >= 0) emit(d, ",\"args\":{\"id\":%d}", arg);
+        emit(d, "}");
+    }
+
+    emit(d, "\n]}\n");
+    if (d.len) out(ctx, d.buf, d.len);
+}
+
+#endif
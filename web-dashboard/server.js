@@ -19,6 +19,8 @@ const ENDPOINTS = {
         'spare-1': 'http://pi-spare.local:9200/stats',
         'spare-2': 'http://pi-spare.local:9200/stats',
     },
+    // Names as the Uptime Kuma monitors are named (the panel's
+    // /stats lists services under the same names)
     services: [
         { name: 'Jazz Stats', url: `http://${M900_IP}:8888` },
         { name: 'NHL Tracker', url: `http://${M900_IP}:3050` },
@@ -34,6 +36,17 @@ const ENDPOINTS = {
     ],
 };
 
+// ============================================
+// Display panel as the data source (optional)
+// The ESP32 serves everything it has already fetched at
+// GET /stats. With PANEL_URL set, the API routes answer from that
+// document and only poll a machine directly when the panel has
+// no fresh copy, so the Pis aren't polled twice.
+// ============================================
+const PANEL_URL = process.env.PANEL_URL || '';     // e.g. http://rack-panel.local/stats
+const PANEL_REFRESH_MS = 2000;                      // reuse one panel read for this long
+const PANEL_MAX_AGE_MS = 60000;                     // older source data = poll directly
+
 const MIME = {
     '.html': 'text/html',
     '.css': 'text/css',
@@ -72,6 +85,54 @@ function httpCheck(url, timeout = 2000) {
     });
 }
 
+// Conditional GET with the panel's ETag; concurrent callers share
+// one request
+let panelCache = { etag: null, doc: null, uptimeMs: 0, at: 0 };
+let panelPending = null;
+
+function panelFetch(timeout = 2000) {
+    if (!PANEL_URL) return Promise.resolve(null);
+    if (panelCache.doc && Date.now() - panelCache.at < PANEL_REFRESH_MS) {
+        return Promise.resolve(panelCache);
+    }
+    if (panelPending) return panelPending;
+
+    panelPending = new Promise((resolve) => {
+        const headers = panelCache.etag ? { 'If-None-Match': panelCache.etag } : {};
+        const req = http.get(PANEL_URL, { timeout, headers }, (res) => {
+            const uptimeMs = Number(res.headers['x-uptime-ms']) || 0;
+            if (res.statusCode === 304 && panelCache.doc) {
+                res.resume();
+                panelCache = { ...panelCache, uptimeMs, at: Date.now() };
+                resolve(panelCache);
+                return;
+            }
+            let data = '';
+            res.on('data', chunk => data += chunk);
+            res.on('end', () => {
+                try {
+                    if (res.statusCode !== 200) throw new Error('status');
+                    panelCache = { etag: res.headers.etag || null, doc: JSON.parse(data), uptimeMs, at: Date.now() };
+                    resolve(panelCache);
+                } catch { resolve(null); }
+            });
+        });
+        req.on('error', () => resolve(null));
+        req.on('timeout', () => { req.destroy(); resolve(null); });
+    }).finally(() => { panelPending = null; });
+    return panelPending;
+}
+
+// A source's data from the panel, or null if missing, stale or old
+async function fromPanel(name) {
+    const panel = await panelFetch();
+    const src = panel && panel.doc[name];
+    if (!src || src.stale || !src.updated_ms) return null;
+    const ageMs = panel.uptimeMs - src.updated_ms + (Date.now() - panel.at);
+    if (ageMs > PANEL_MAX_AGE_MS) return null;
+    return src.data;
+}
+
 // ============================================
 // Server
 // ============================================
@@ -80,14 +141,14 @@ const server = http.createServer(async (req, res) => {
 
     // API routes (proxy to internal services)
     if (url === '/api/m900') {
-        const data = await proxyFetch(ENDPOINTS.m900);
+        const data = await fromPanel('m900') || await proxyFetch(ENDPOINTS.m900);
         res.writeHead(data ? 200 : 502, { 'Content-Type': 'application/json' });
         res.end(JSON.stringify(data || { error: 'unreachable' }));
         return;
     }
 
     if (url === '/api/unraid') {
-        const data = await proxyFetch(ENDPOINTS.unraid);
+        const data = await fromPanel('unraid') || await proxyFetch(ENDPOINTS.unraid);
         res.writeHead(data ? 200 : 502, { 'Content-Type': 'application/json' });
         res.end(JSON.stringify(data || { error: 'unreachable' }));
         return;
@@ -101,17 +162,23 @@ const server = http.createServer(async (req, res) => {
             res.end(JSON.stringify({ error: 'unknown pi' }));
             return;
         }
-        const data = await proxyFetch(endpoint);
+        const pis = await fromPanel('pis');
+        const data = (pis && pis[piName]) || await proxyFetch(endpoint);
         res.writeHead(data ? 200 : 502, { 'Content-Type': 'application/json' });
         res.end(JSON.stringify(data || { error: 'unreachable' }));
         return;
     }
 
     if (url === '/api/services') {
+        // The panel reads Uptime Kuma rather than probing; its entries
+        // carry the Kuma monitor name, which is what ENDPOINTS.services
+        // names. Anything the panel doesn't list is probed directly.
+        const fromKuma = new Map();
+        for (const s of await fromPanel('services') || []) fromKuma.set(s.monitor, s.up);
         const results = await Promise.all(
             ENDPOINTS.services.map(async svc => ({
                 name: svc.name,
-                up: await httpCheck(svc.url),
+                up: fromKuma.has(svc.name) ? fromKuma.get(svc.name) : await httpCheck(svc.url),
             }))
         );
         res.writeHead(200, { 'Content-Type': 'application/json' });
@@ -142,4 +209,5 @@ server.listen(PORT, () => {
     console.log(`  Local:  http://localhost:${PORT}`);
     console.log(`  M900:   ${ENDPOINTS.m900}`);
     console.log(`  Unraid: ${ENDPOINTS.unraid}`);
+    if (PANEL_URL) console.log(`  Panel:  ${PANEL_URL}`);
 });